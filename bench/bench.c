@@ -0,0 +1,42 @@
+#include <stdio.h>
+
+#include <getopt.h>
+
+#include "bench_harness.h"
+#include "micro_bench.h"
+#include "unibus_bench.h"
+
+static void bench_usage(FILE *const file, char const *const name) {
+    fprintf(
+        file,
+        "usage: %s [options]\n"
+        " -j, --json           print a JSON object per benchmark\n"
+        " -f, --filter TEXT    run only the benchmarks with TEXT in the name\n"
+        " -h, --help           print this and exit\n",
+        name
+    );
+}
+
+int main(int const argc, char *const argv[]) {
+    static struct option const long_options[] = {
+        {"json", no_argument, NULL, 'j'},
+        {"filter", required_argument, NULL, 'f'},
+        {"help", no_argument, NULL, 'h'},
+        {0},
+    };
+
+    BenchConfig config = {.format = BENCH_FORMAT_TEXT, .filter = NULL};
+    for (int opt;
+         (opt = getopt_long(argc, argv, "jf:h", long_options, NULL)) != -1;) {
+        switch (opt) {
+        case 'j': config.format = BENCH_FORMAT_JSON; break;
+        case 'f': config.filter = optarg; break;
+        case 'h': bench_usage(stdout, argv[0]); return 0;
+        default: bench_usage(stderr, argv[0]); return 1;
+        }
+    }
+    if (optind != argc) return bench_usage(stderr, argv[0]), 1;
+
+    if (bench_micro_run(&config) != 0) return 1;
+    return bench_unibus_run(&config);
+}
@@ -0,0 +1,437 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <getopt.h>
+
+#include "conviniences.h"
+
+#include "pdp11/cpu/pdp11_cpu_trace.h"
+#include "pdp11/pdp11.h"
+#include "pdp11/pdp11_console.h"
+#include "pdp11/pdp11_papertape_reader.h"
+#include "pdp11/pdp11_teletype.h"
+
+/* Times the CPU on real programs, the bundled paper tapes. Each tape is
+ * booted the way an operator would, through the absolute loader, then run on
+ * each engine for a fixed count of instructions, or until it stops. The run
+ * is timed from the loader reading the tape in, which the diagnostics are
+ * started right after, booting the absolute loader is not timed. */
+
+#define GUEST_BENCH_MAX_INSTRS (10 * 1000 * 1000)
+#define GUEST_BENCH_LOOPS      (3)
+#define GUEST_BENCH_DIR        "res/papertapes"
+#define GUEST_BENCH_LOADER     "absolute_loader.ptap"
+
+typedef struct GuestBenchTape {
+    char const *name, *file;
+    // NOTE the diagnostics halt once loaded, while BASIC starts on its own
+    bool has_start;
+    uint16_t start;
+} GuestBenchTape;
+
+static GuestBenchTape const guest_bench_tapes[] = {
+    {"basic", "basic.ptap", false, 0},
+    {"test1", "test1_branch.ptap", true, 0200},
+    {"test2", "test2_cond_branch.ptap", true, 0200},
+    {"test3", "test3_unary.ptap", true, 0200},
+    {"test4", "test4_unary_binary.ptap", true, 0200},
+    {"test5", "test5_rotate_shift.ptap", true, 0200},
+    {"test6", "test6_compare.ptap", true, 0200},
+    {"test7", "test7_compare_not.ptap", true, 0200},
+    {"test8", "test8_move.ptap", true, 0200},
+};
+
+static char const *const guest_bench_engines[] = {
+    [PDP11_CPU_ENGINE_LOOP] = "loop",
+    [PDP11_CPU_ENGINE_THREADED] = "threaded",
+    [PDP11_CPU_ENGINE_BLOCK] = "block",
+    [PDP11_CPU_ENGINE_JIT] = "jit",
+};
+
+static char const *const guest_bench_stops[] = {
+    [PDP11_CPU_STOP_HALT] = "halt",
+    [PDP11_CPU_STOP_WAIT] = "wait",
+    [PDP11_CPU_STOP_INSTRS] = "instrs",
+};
+
+typedef struct GuestBenchOptions {
+    char const *dir, *filter;
+    bool is_json;
+    uint64_t max_instrs;
+    unsigned loops;
+} GuestBenchOptions;
+
+typedef struct GuestBenchMachine {
+    Pdp11 pdp;
+    Pdp11PapertapeReader pr;
+    Pdp11Teletype tty;
+} GuestBenchMachine;
+
+// What a single run has counted, the times are host seconds.
+typedef struct GuestBenchRun {
+    double wall_s, cpu_s;
+    uint64_t instrs, sim_ns, transactions, intrs;
+    Pdp11CpuStop stop;
+} GuestBenchRun;
+
+/*************
+ ** helpers **
+ *************/
+
+static void guest_bench_usage(FILE *const file, char const *const name) {
+    fprintf(
+        file,
+        "usage: %s [options]\n"
+        " -d, --dir DIR        take the tapes from DIR (default %s)\n"
+        " -i, --max-instrs N   instructions per run (default %d)\n"
+        " -n, --loops N        runs per tape and engine (default %d)\n"
+        " -j, --json           print a JSON object per tape and engine\n"
+        " -f, --filter TEXT    run only the tapes and engines with TEXT in\n"
+        "                      `tape/engine`\n"
+        " -h, --help           print this and exit\n",
+        name,
+        GUEST_BENCH_DIR,
+        GUEST_BENCH_MAX_INSTRS,
+        GUEST_BENCH_LOOPS
+    );
+}
+
+static bool guest_bench_parse_u64(char const *const str, uint64_t *const out) {
+    char *end;
+    unsigned long long const value = strtoull(str, &end, 10);
+    if (*str == '\0' || *str == '-' || *end != '\0') return false;
+    return *out = value, true;
+}
+
+static bool guest_bench_parse_options(
+    int const argc,
+    char *const argv[],
+    GuestBenchOptions *const out
+) {
+    static struct option const long_options[] = {
+        {"dir", required_argument, NULL, 'd'},
+        {"max-instrs", required_argument, NULL, 'i'},
+        {"loops", required_argument, NULL, 'n'},
+        {"json", no_argument, NULL, 'j'},
+        {"filter", required_argument, NULL, 'f'},
+        {"help", no_argument, NULL, 'h'},
+        {0},
+    };
+
+    *out = (GuestBenchOptions){
+        .dir = GUEST_BENCH_DIR,
+        .max_instrs = GUEST_BENCH_MAX_INSTRS,
+        .loops = GUEST_BENCH_LOOPS,
+    };
+    for (int opt;
+         (opt = getopt_long(argc, argv, "d:i:n:jf:h", long_options, NULL)) !=
+         -1;) {
+        uint64_t value;
+        switch (opt) {
+        case 'd': out->dir = optarg; break;
+        case 'i':
+            if (!guest_bench_parse_u64(optarg, &out->max_instrs) ||
+                out->max_instrs == 0)
+                return false;
+            break;
+        case 'n':
+            if (!guest_bench_parse_u64(optarg, &value) || value == 0 ||
+                value > UINT16_MAX)
+                return false;
+            out->loops = value;
+            break;
+        case 'j': out->is_json = true; break;
+        case 'f': out->filter = optarg; break;
+        case 'h': guest_bench_usage(stdout, argv[0]), exit(0);
+        default: return false;
+        }
+    }
+    return optind == argc;
+}
+
+static double guest_bench_now_s(clockid_t const clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// The build knobs the CPU speed depends on, as `key=value` pairs.
+static void guest_bench_config(char *const buf, size_t const size) {
+#ifdef __OPTIMIZE__
+    bool const is_optimized = true;
+#else
+    bool const is_optimized = false;
+#endif
+    snprintf(
+        buf,
+        size,
+        "batch_len=%d lazy_flags=%d reference_decode=%d trace=%d optimized=%d",
+        PDP11_CPU_BATCH_LEN,
+        PDP11_CPU_LAZY_FLAGS,
+        PDP11_CPU_REFERENCE_DECODE,
+        PDP11_CPU_TRACE,
+        is_optimized
+    );
+}
+
+/* Puts the machine together, its memory starting cleared so that every run
+ * starts from the same state, along with the reader and the teletype, which
+ * prints to `printer`. */
+static Result guest_bench_init(
+    GuestBenchMachine *const self,
+    Pdp11CpuEngine const engine,
+    FILE *const printer
+) {
+    Pdp11 *const pdp = &self->pdp;
+    UNROLL(pdp11_init(pdp, NULL, engine, false));
+
+    UNROLL_CLEANUP(
+        pdp11_papertape_reader_init(
+            &self->pr,
+            &pdp->unibus,
+            PDP11_PAPERTAPE_READER_ADDR,
+            PDP11_PAPERTAPE_READER_INTR_VEC,
+            PDP11_PAPERTAPE_READER_INTR_PRIORITY
+        ),
+        pdp11_uninit(pdp)
+    );
+    UNROLL_CLEANUP(
+        pdp11_teletype_init(
+            &self->tty,
+            &pdp->unibus,
+            PDP11_TELETYPE_ADDR,
+            PDP11_TELETYPE_KEYBOARD_INTR_VEC,
+            PDP11_TELETYPE_PRINTER_INTR_VEC,
+            PDP11_TELETYPE_INTR_PRIORITY,
+            printer
+        ),
+        {
+            pdp11_papertape_reader_uninit(&self->pr);
+            pdp11_uninit(pdp);
+        }
+    );
+
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &pdp->unibus,
+            pdp11_papertape_reader_ww_unibus_device(&self->pr),
+            PDP11_PAPERTAPE_READER_ADDR,
+            PDP11_PAPERTAPE_READER_SIZE
+        ),
+        {
+            pdp11_teletype_uninit(&self->tty);
+            pdp11_papertape_reader_uninit(&self->pr);
+            pdp11_uninit(pdp);
+        }
+    );
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &pdp->unibus,
+            pdp11_teletype_ww_unibus_device(&self->tty),
+            PDP11_TELETYPE_ADDR,
+            PDP11_TELETYPE_SIZE
+        ),
+        {
+            pdp11_teletype_uninit(&self->tty);
+            pdp11_papertape_reader_uninit(&self->pr);
+            pdp11_uninit(pdp);
+        }
+    );
+
+    return Ok;
+}
+static void guest_bench_uninit(GuestBenchMachine *const self) {
+    pdp11_teletype_uninit(&self->tty);
+    pdp11_papertape_reader_uninit(&self->pr);
+    pdp11_uninit(&self->pdp);
+}
+
+static Result guest_bench_load(
+    GuestBenchMachine *const self,
+    char const *const dir,
+    char const *const file
+) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    if (pdp11_papertape_reader_load(&self->pr, path) != Ok)
+        return fprintf(stderr, "cannot open tape '%s'\n", path), StateErr;
+    return Ok;
+}
+
+/* Boots the absolute loader as `headless` does, then times the loader
+ * reading `tape` in and the tape running, up to `max_instrs` in all. */
+static Result guest_bench_run(
+    GuestBenchMachine *const self,
+    GuestBenchOptions const *const options,
+    GuestBenchTape const *const tape,
+    GuestBenchRun *const out
+) {
+    Pdp11Cpu *const cpu = &self->pdp.cpu;
+    Pdp11Console *const console = &self->pdp.console;
+    pdp11_console_next_power_control(console);
+    pdp11_console_toggle_enable(console);
+    pdp11_console_insert_bootloader(console);
+    pdp11_console_toggle_enable(console);
+    UNROLL(guest_bench_load(self, options->dir, GUEST_BENCH_LOADER));
+    pdp11_console_press_start(console);
+    if (pdp11_cpu_run(cpu, PDP11_CPU_NO_LIMIT) != PDP11_CPU_STOP_HALT)
+        return fprintf(stderr, "the absolute loader has not halted\n"),
+               StateErr;
+    UNROLL(guest_bench_load(self, options->dir, tape->file));
+
+    uint64_t const instrs = pdp11_cpu_instrs(cpu);
+    uint64_t const sim_ns = pdp11_cpu_time(cpu);
+    uint64_t const transactions = unibus_transactions(&self->pdp.unibus);
+    uint64_t const intrs = pdp11_cpu_intrs(cpu);
+    double const wall_s = guest_bench_now_s(CLOCK_MONOTONIC);
+    double const cpu_s = guest_bench_now_s(CLOCK_PROCESS_CPUTIME_ID);
+
+    pdp11_console_press_continue(console);
+    bool is_started = !tape->has_start;
+    for (;;) {
+        uint64_t const done = pdp11_cpu_instrs(cpu) - instrs;
+        out->stop = pdp11_cpu_run(cpu, options->max_instrs - done);
+        if (out->stop != PDP11_CPU_STOP_HALT || is_started) break;
+        pdp11_cpu_pc(cpu) = tape->start, is_started = true;
+    }
+
+    out->cpu_s = guest_bench_now_s(CLOCK_PROCESS_CPUTIME_ID) - cpu_s;
+    out->wall_s = guest_bench_now_s(CLOCK_MONOTONIC) - wall_s;
+    out->instrs = pdp11_cpu_instrs(cpu) - instrs;
+    out->sim_ns = pdp11_cpu_time(cpu) - sim_ns;
+    out->transactions = unibus_transactions(&self->pdp.unibus) - transactions;
+    out->intrs = pdp11_cpu_intrs(cpu) - intrs;
+    return Ok;
+}
+
+/* Runs `tape` on `engine` for every loop, on a fresh machine each, and
+ * reports the mean of each figure, along with the spread of the MIPS. */
+static Result guest_bench_tape(
+    GuestBenchOptions const *const options,
+    GuestBenchTape const *const tape,
+    Pdp11CpuEngine const engine,
+    char const *const config,
+    FILE *const printer
+) {
+    char name[64];
+    snprintf(
+        name,
+        sizeof(name),
+        "%s/%s",
+        tape->name,
+        guest_bench_engines[engine]
+    );
+    if (options->filter && !strstr(name, options->filter)) return Ok;
+
+    double mips[options->loops], mean_mips = 0, cpu_s = 0;
+    GuestBenchRun run = {0};
+    for (unsigned i = 0; i < options->loops; i++) {
+        GuestBenchMachine machine = {0};
+        UNROLL(guest_bench_init(&machine, engine, printer));
+        UNROLL_CLEANUP(
+            guest_bench_run(&machine, options, tape, &run),
+            guest_bench_uninit(&machine)
+        );
+        guest_bench_uninit(&machine);
+
+        mips[i] = run.instrs / run.wall_s / 1e6;
+        mean_mips += mips[i], cpu_s += run.cpu_s;
+    }
+    mean_mips /= options->loops, cpu_s /= options->loops;
+    double variance = 0;
+    for (unsigned i = 0; i < options->loops; i++)
+        variance += (mips[i] - mean_mips) * (mips[i] - mean_mips);
+    variance /= options->loops > 1 ? options->loops - 1 : 1;
+
+    // NOTE the counts are the same on every loop, the machine is deterministic
+    double const bus_per_instr =
+        run.instrs ? (double)run.transactions / run.instrs : 0;
+    double const intrs_per_s = run.sim_ns ? run.intrs * 1e9 / run.sim_ns : 0;
+    if (options->is_json)
+        printf(
+            "{\"name\": \"%s\", \"mips\": %.3f, \"stddev_mips\": %.3f, "
+            "\"cpu_s\": %.4f, \"instrs\": %" PRIu64 ", \"sim_ns\": %" PRIu64
+            ", \"bus_per_instr\": %.4f, \"intrs_per_s\": %.1f, "
+            "\"stop\": \"%s\", \"loops\": %u, \"config\": \"%s\"}\n",
+            name,
+            mean_mips,
+            sqrt(variance),
+            cpu_s,
+            run.instrs,
+            run.sim_ns,
+            bus_per_instr,
+            intrs_per_s,
+            guest_bench_stops[run.stop],
+            options->loops,
+            config
+        );
+    else
+        printf(
+            "%-16s %12" PRIu64 " %9.2f +- %6.2f %9.4f %10.4f %10.1f  %s\n",
+            name,
+            run.instrs,
+            mean_mips,
+            sqrt(variance),
+            cpu_s,
+            bus_per_instr,
+            intrs_per_s,
+            guest_bench_stops[run.stop]
+        );
+    fflush(stdout);
+    return Ok;
+}
+
+/**********
+ ** main **
+ **********/
+
+int main(int const argc, char *const argv[]) {
+    GuestBenchOptions options;
+    if (!guest_bench_parse_options(argc, argv, &options)) {
+        guest_bench_usage(stderr, argv[0]);
+        return 1;
+    }
+
+    // NOTE what the tapes print is of no interest, only how fast they run
+    FILE *const printer = fopen("/dev/null", "w");
+    if (!printer) return fprintf(stderr, "cannot open /dev/null\n"), 1;
+
+    char config[128];
+    guest_bench_config(config, sizeof(config));
+    if (!options.is_json)
+        printf(
+            "# %s\n%-16s %12s %9s    %6s %9s %10s %10s  %s\n",
+            config,
+            "name",
+            "instrs",
+            "MIPS",
+            "stddev",
+            "cpu s",
+            "bus/instr",
+            "intrs/s",
+            "stop"
+        );
+
+    int status = 0;
+    for (size_t i = 0; i < lenof(guest_bench_tapes) && status == 0; i++)
+        for (size_t engine = 0; engine < lenof(guest_bench_engines); engine++)
+            if (guest_bench_tape(
+                    &options,
+                    &guest_bench_tapes[i],
+                    engine,
+                    config,
+                    printer
+                ) != Ok) {
+                status = 1;
+                break;
+            }
+
+    fclose(printer);
+    return status;
+}
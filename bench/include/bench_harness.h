@@ -0,0 +1,69 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// NOTE the methodology is fixed, so that results compare between commits, the
+// knobs are only there to trade precision for time on a slow host
+
+// Host nanoseconds a single sample lasts at least.
+#ifndef BENCH_SAMPLE_NS
+#  define BENCH_SAMPLE_NS (10 * 1000 * 1000)
+#endif
+// Samples run and thrown away before the measured ones.
+#ifndef BENCH_WARMUP_SAMPLES
+#  define BENCH_WARMUP_SAMPLES (3)
+#endif
+#ifndef BENCH_SAMPLES
+#  define BENCH_SAMPLES (20)
+#endif
+
+typedef enum BenchFormat {
+    BENCH_FORMAT_TEXT,  // a line per benchmark, aligned for reading
+    BENCH_FORMAT_JSON,  // a JSON object per line, for scripts to compare
+} BenchFormat;
+
+typedef struct BenchConfig {
+    BenchFormat format;
+    char const *filter;  // only benchmarks with it in their name, if any
+} BenchConfig;
+
+typedef struct BenchResult {
+    double ns_per_op, stddev_ns;  // mean over the samples, and its spread
+    double instrs_per_s;  // guest instructions, `0` if the benchmark runs none
+    uint64_t ops;         // per sample
+    unsigned samples;
+} BenchResult;
+
+// Runs `ops` operations of a benchmark on `ctx`.
+typedef void BenchFn(void *const ctx, uint64_t const ops);
+
+bool bench_is_selected(
+    BenchConfig const *const config,
+    char const *const name
+);
+/* Times `fn`. Doubles the operations per sample until one lasts
+ * `BENCH_SAMPLE_NS`, which warms it up along the way, runs
+ * `BENCH_WARMUP_SAMPLES` more, then measures `BENCH_SAMPLES`. */
+BenchResult bench_measure(
+    BenchFn *const fn,
+    void *const ctx,
+    double const instrs_per_op
+);
+// Prints the result on stdout, in the format of `config`.
+void bench_report(
+    BenchConfig const *const config,
+    char const *const name,
+    BenchResult const *const result
+);
+// Measures and reports `fn`, if `name` is selected.
+void bench_run(
+    BenchConfig const *const config,
+    char const *const name,
+    BenchFn *const fn,
+    void *const ctx,
+    double const instrs_per_op
+);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef BENCH_MICRO_H
+#define BENCH_MICRO_H
+
+#include "bench_harness.h"
+
+int bench_micro_run(BenchConfig const *const config);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef BENCH_UNIBUS_H
+#define BENCH_UNIBUS_H
+
+#include "bench_harness.h"
+
+int bench_unibus_run(BenchConfig const *const config);
+
+#endif
@@ -0,0 +1,111 @@
+#include "bench_harness.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*************
+ ** helpers **
+ *************/
+
+static uint64_t bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static uint64_t
+bench_time_ns(BenchFn *const fn, void *const ctx, uint64_t const ops) {
+    uint64_t const start = bench_now_ns();
+    fn(ctx, ops);
+    return bench_now_ns() - start;
+}
+
+/************
+ ** public **
+ ************/
+
+bool bench_is_selected(
+    BenchConfig const *const config,
+    char const *const name
+) {
+    return !config->filter || strstr(name, config->filter);
+}
+
+BenchResult bench_measure(
+    BenchFn *const fn,
+    void *const ctx,
+    double const instrs_per_op
+) {
+    uint64_t ops = 1;
+    while (bench_time_ns(fn, ctx, ops) < BENCH_SAMPLE_NS) ops *= 2;
+    for (unsigned i = 0; i < BENCH_WARMUP_SAMPLES; i++)
+        bench_time_ns(fn, ctx, ops);
+
+    double samples[BENCH_SAMPLES], mean = 0;
+    for (unsigned i = 0; i < BENCH_SAMPLES; i++) {
+        samples[i] = (double)bench_time_ns(fn, ctx, ops) / ops;
+        mean += samples[i];
+    }
+    mean /= BENCH_SAMPLES;
+    double variance = 0;
+    for (unsigned i = 0; i < BENCH_SAMPLES; i++)
+        variance += (samples[i] - mean) * (samples[i] - mean);
+    variance /= BENCH_SAMPLES > 1 ? BENCH_SAMPLES - 1 : 1;
+
+    return (BenchResult){
+        .ns_per_op = mean,
+        .stddev_ns = sqrt(variance),
+        .instrs_per_s = instrs_per_op * 1e9 / mean,
+        .ops = ops,
+        .samples = BENCH_SAMPLES,
+    };
+}
+
+void bench_report(
+    BenchConfig const *const config,
+    char const *const name,
+    BenchResult const *const result
+) {
+    switch (config->format) {
+    case BENCH_FORMAT_TEXT:
+        printf(
+            "%-36s %12.2f ns/op +- %8.2f",
+            name,
+            result->ns_per_op,
+            result->stddev_ns
+        );
+        if (result->instrs_per_s != 0)
+            printf(" %14.0f instrs/s", result->instrs_per_s);
+        printf("\n");
+        break;
+    // NOTE the names need no escaping, none has a quote or a backslash
+    case BENCH_FORMAT_JSON:
+        printf(
+            "{\"name\": \"%s\", \"ns_per_op\": %.3f, \"stddev_ns\": %.3f, "
+            "\"instrs_per_s\": %.0f, \"ops\": %" PRIu64 ", \"samples\": %u}\n",
+            name,
+            result->ns_per_op,
+            result->stddev_ns,
+            result->instrs_per_s,
+            result->ops,
+            result->samples
+        );
+        break;
+    }
+    fflush(stdout);
+}
+
+void bench_run(
+    BenchConfig const *const config,
+    char const *const name,
+    BenchFn *const fn,
+    void *const ctx,
+    double const instrs_per_op
+) {
+    if (!bench_is_selected(config, name)) return;
+    BenchResult const result = bench_measure(fn, ctx, instrs_per_op);
+    bench_report(config, name, &result);
+}
@@ -0,0 +1,344 @@
+#include "micro_bench.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bench_harness.h"
+#include "pdp11/cpu/pdp11_cpu.h"
+#include "pdp11/cpu/pdp11_cpu_instr.h"
+#include "pdp11/pdp11_ram.h"
+#include "pdp11/unibus/unibus.h"
+
+/* Host-side costs of the CPU and the bus, each measured on its own: decoding,
+ * dispatching through every engine, the addressing modes, bus reads, and the
+ * way into trap and interrupt handlers. The CPU runs without its thread, on
+ * a machine of its own, so that nothing but the benchmark runs meanwhile. */
+
+#define MICRO_BENCH_DEVICE_COUNT (8)
+// NOTE main RAM stops short of the other devices, which fill the space up to
+// the I/O page, and of `MICRO_BENCH_NXM_ADDR`, which nothing answers
+#define MICRO_BENCH_RAM_SIZE    (0140000)
+#define MICRO_BENCH_DEVICE_ADDR (0140000)
+#define MICRO_BENCH_DEVICE_SIZE (02000)
+#define MICRO_BENCH_NXM_ADDR    (0157776)
+
+#define MICRO_BENCH_PROGRAM_ADDR (0x200)
+#define MICRO_BENCH_HANDLER_ADDR (0x800)
+#define MICRO_BENCH_DATA_ADDR    (0x1000)
+#define MICRO_BENCH_STACK_ADDR   (0x1000)
+#define MICRO_BENCH_INTR_VEC     (0100)
+
+// Instructions in the straight run each addressing mode is measured on.
+#define MICRO_BENCH_MODE_RUN_LEN (32)
+
+typedef struct MicroBenchMachine {
+    Unibus unibus;
+    Pdp11Cpu cpu;
+    Pdp11Ram rams[MICRO_BENCH_DEVICE_COUNT];
+    unsigned ram_count;
+} MicroBenchMachine;
+
+// NOTE keeps the results of what is measured from being optimized away
+static unsigned volatile micro_bench_sink;
+
+/*************
+ ** helpers **
+ *************/
+
+static uint16_t micro_bench_device_addr(unsigned const i) {
+    return i == 0 ? 0
+                  : MICRO_BENCH_DEVICE_ADDR + (i - 1) * MICRO_BENCH_DEVICE_SIZE;
+}
+static uint16_t micro_bench_device_size(unsigned const i) {
+    return i == 0 ? MICRO_BENCH_RAM_SIZE : MICRO_BENCH_DEVICE_SIZE;
+}
+
+static void micro_bench_machine_uninit(MicroBenchMachine *const self) {
+    pdp11_cpu_uninit(&self->cpu);
+    unibus_uninit(&self->unibus);
+    for (unsigned i = 0; i < self->ram_count; i++)
+        pdp11_ram_uninit(self->rams + i);
+}
+
+/* Builds a machine of main RAM and `device_count - 1` more RAM devices, the
+ * CPU running on `engine` without its thread. Programs go on with
+ * `micro_bench_load`. */
+static Result micro_bench_machine_init(
+    MicroBenchMachine *const self,
+    Pdp11CpuEngine const engine,
+    unsigned const device_count
+) {
+    for (self->ram_count = 0; self->ram_count < device_count;
+         self->ram_count++) {
+        UNROLL_CLEANUP(
+            pdp11_ram_init(
+                self->rams + self->ram_count,
+                micro_bench_device_addr(self->ram_count),
+                micro_bench_device_size(self->ram_count),
+                NULL
+            ),
+            {
+                for (unsigned i = 0; i < self->ram_count; i++)
+                    pdp11_ram_uninit(self->rams + i);
+            }
+        );
+    }
+
+    unibus_init(&self->unibus, &self->cpu);
+    UNROLL_CLEANUP(pdp11_cpu_init(&self->cpu, &self->unibus, engine, false), {
+        unibus_uninit(&self->unibus);
+        for (unsigned i = 0; i < self->ram_count; i++)
+            pdp11_ram_uninit(self->rams + i);
+    });
+    for (unsigned i = 0; i < self->ram_count; i++) {
+        UNROLL_CLEANUP(
+            unibus_attach(
+                &self->unibus,
+                pdp11_ram_ww_unibus_device(self->rams + i),
+                micro_bench_device_addr(i),
+                micro_bench_device_size(i)
+            ),
+            micro_bench_machine_uninit(self)
+        );
+    }
+    pdp11_cpu_map_ram(
+        &self->cpu,
+        pdp11_ram_data(self->rams),
+        MICRO_BENCH_RAM_SIZE
+    );
+
+    pdp11_cpu_pc(&self->cpu) = MICRO_BENCH_PROGRAM_ADDR;
+    pdp11_cpu_sp(&self->cpu) = MICRO_BENCH_STACK_ADDR;
+    return Ok;
+}
+
+static void micro_bench_load(
+    MicroBenchMachine *const self,
+    uint16_t const addr,
+    uint16_t const *const words,
+    unsigned const len
+) {
+    for (unsigned i = 0; i < len; i++)
+        unibus_cpu_dato(&self->unibus, addr + 2 * i, words[i]);
+}
+// Points `vec` at a handler that only returns.
+static void
+micro_bench_load_rti(MicroBenchMachine *const self, uint16_t const vec) {
+    uint16_t const vector[] = {MICRO_BENCH_HANDLER_ADDR, 0};
+    micro_bench_load(self, vec, vector, 2);
+    unibus_cpu_dato(
+        &self->unibus,
+        MICRO_BENCH_HANDLER_ADDR,
+        0000002 /* rti */
+    );
+}
+
+/***********
+ ** bench **
+ ***********/
+
+static void micro_bench_decode_instr(void *const, uint64_t const ops) {
+    unsigned sink = 0;
+    for (uint64_t i = 0; i < ops; i++)
+        sink += pdp11_cpu_instr((uint16_t)i).type;
+    micro_bench_sink = sink;
+}
+static void micro_bench_decode_table(void *const, uint64_t const ops) {
+    unsigned sink = 0;
+    for (uint64_t i = 0; i < ops; i++) sink += pdp11_cpu_decode(i)->op;
+    micro_bench_sink = sink;
+}
+
+// Runs the loaded program for `ops` instructions.
+static void micro_bench_instrs(void *const vmachine, uint64_t const ops) {
+    MicroBenchMachine *const machine = vmachine;
+    pdp11_cpu_run(&machine->cpu, ops);
+}
+// Reads the last word of the last device `ops` times, as the CPU would.
+static void micro_bench_dati(void *const vmachine, uint64_t const ops) {
+    MicroBenchMachine *const machine = vmachine;
+    unsigned const last = machine->ram_count - 1;
+    uint16_t const addr =
+        micro_bench_device_addr(last) + micro_bench_device_size(last) - 2;
+
+    unsigned sink = 0;
+    unibus_cpu_acquire(&machine->unibus);
+    for (uint64_t i = 0; i < ops; i++) {
+        uint16_t data;
+        unibus_cpu_dati(&machine->unibus, addr, &data);
+        sink += data;
+    }
+    unibus_cpu_release(&machine->unibus);
+    micro_bench_sink = sink;
+}
+// Runs `ops` round trips into a handler and back, of three instructions each.
+static void micro_bench_round_trips(void *const vmachine, uint64_t const ops) {
+    MicroBenchMachine *const machine = vmachine;
+    pdp11_cpu_run(&machine->cpu, 3 * ops);
+}
+// Takes `ops` interrupts, each from a `br .` into a handler that returns.
+static void micro_bench_intr(void *const vmachine, uint64_t const ops) {
+    MicroBenchMachine *const machine = vmachine;
+    for (uint64_t i = 0; i < ops; i++) {
+        unibus_br_intr(&machine->unibus, MICRO_BENCH_INTR_VEC);
+        pdp11_cpu_run(&machine->cpu, 2);
+    }
+}
+
+static void micro_bench_dispatch(BenchConfig const *const config) {
+    static char const *const names[] = {
+        [PDP11_CPU_ENGINE_LOOP] = "dispatch/loop",
+        [PDP11_CPU_ENGINE_THREADED] = "dispatch/threaded",
+        [PDP11_CPU_ENGINE_BLOCK] = "dispatch/block",
+        [PDP11_CPU_ENGINE_JIT] = "dispatch/jit",
+    };
+    // NOTE register-only, so that compiled code gets to run it as well
+    uint16_t const program[] = {
+        0005200, /* inc R0 */
+        0060001, /* add R0, R1 */
+        0005302, /* dec R2 */
+        0000774, /* br .-6 */
+    };
+    for (unsigned engine = 0; engine < sizeof(names) / sizeof(*names);
+         engine++) {
+        if (!bench_is_selected(config, names[engine])) continue;
+        MicroBenchMachine machine;
+        if (micro_bench_machine_init(&machine, engine, 1) != Ok) return;
+        micro_bench_load(
+            &machine,
+            MICRO_BENCH_PROGRAM_ADDR,
+            program,
+            sizeof(program) / sizeof(*program)
+        );
+        bench_run(config, names[engine], micro_bench_instrs, &machine, 1);
+        micro_bench_machine_uninit(&machine);
+    }
+}
+
+/* Runs `mov` from every source mode into a register on the plain loop engine,
+ * so that the modes differ in nothing but themselves. Each run of them starts
+ * with R0 in the middle of a table of words pointing back at the table, which
+ * every mode, deferred or not, can read from. */
+static void micro_bench_modes(BenchConfig const *const config) {
+    static char const *const names[] = {
+        "mode/register",
+        "mode/register-deferred",
+        "mode/autoincrement",
+        "mode/autoincrement-deferred",
+        "mode/autodecrement",
+        "mode/autodecrement-deferred",
+        "mode/index",
+        "mode/index-deferred",
+    };
+    uint16_t const table = MICRO_BENCH_DATA_ADDR,
+                   middle = table + 2 * MICRO_BENCH_MODE_RUN_LEN;
+    for (unsigned mode = 0; mode < sizeof(names) / sizeof(*names); mode++) {
+        if (!bench_is_selected(config, names[mode])) continue;
+        MicroBenchMachine machine;
+        if (micro_bench_machine_init(&machine, PDP11_CPU_ENGINE_LOOP, 1) !=
+            Ok)
+            return;
+        for (unsigned i = 0; i < 4 * MICRO_BENCH_MODE_RUN_LEN; i++)
+            unibus_cpu_dato(&machine.unibus, table + 2 * i, table);
+
+        uint16_t program[2 + 2 * MICRO_BENCH_MODE_RUN_LEN + 1];
+        unsigned len = 0;
+        program[len++] = 0012700; /* mov #middle, R0 */
+        program[len++] = middle;
+        for (unsigned i = 0; i < MICRO_BENCH_MODE_RUN_LEN; i++) {
+            program[len++] = 0010001 | mode << 9; /* mov <mode>R0, R1 */
+            if (mode >= 6) program[len++] = 0;    // NOTE the index
+        }
+        program[len] = 0000400 | (uint8_t)-(len + 1); /* br to the top */
+        len++;
+        micro_bench_load(&machine, MICRO_BENCH_PROGRAM_ADDR, program, len);
+
+        bench_run(config, names[mode], micro_bench_instrs, &machine, 1);
+        micro_bench_machine_uninit(&machine);
+    }
+}
+
+static void micro_bench_bus(BenchConfig const *const config) {
+    static unsigned const device_counts[] = {1, MICRO_BENCH_DEVICE_COUNT};
+    for (unsigned i = 0; i < sizeof(device_counts) / sizeof(*device_counts);
+         i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "bus/dati/devices-%u", device_counts[i]);
+        if (!bench_is_selected(config, name)) continue;
+        MicroBenchMachine machine;
+        if (micro_bench_machine_init(
+                &machine,
+                PDP11_CPU_ENGINE_LOOP,
+                device_counts[i]
+            ) != Ok)
+            return;
+        bench_run(config, name, micro_bench_dati, &machine, 0);
+        micro_bench_machine_uninit(&machine);
+    }
+}
+
+/* Goes into a handler that only returns, by a trap instruction, a bus error,
+ * and an interrupt. An operation is a whole round trip, along with the branch
+ * back to where it starts from. */
+static void micro_bench_traps(BenchConfig const *const config) {
+    MicroBenchMachine machine;
+    if (bench_is_selected(config, "trap/trap")) {
+        if (micro_bench_machine_init(&machine, PDP11_CPU_ENGINE_LOOP, 1) != Ok)
+            return;
+        micro_bench_load_rti(&machine, PDP11_CPU_TRAP_TRAP);
+        uint16_t const program[] = {
+            0104400, /* trap 0 */
+            0000776, /* br .-2 */
+        };
+        micro_bench_load(&machine, MICRO_BENCH_PROGRAM_ADDR, program, 2);
+        bench_run(config, "trap/trap", micro_bench_round_trips, &machine, 3);
+        micro_bench_machine_uninit(&machine);
+    }
+    if (bench_is_selected(config, "trap/bus-error")) {
+        if (micro_bench_machine_init(&machine, PDP11_CPU_ENGINE_LOOP, 1) != Ok)
+            return;
+        micro_bench_load_rti(&machine, PDP11_CPU_TRAP_CPU_ERR);
+        uint16_t const program[] = {
+            0005737, MICRO_BENCH_NXM_ADDR, /* tst @#nxm */
+            0000775,                       /* br .-4 */
+        };
+        micro_bench_load(&machine, MICRO_BENCH_PROGRAM_ADDR, program, 3);
+        bench_run(
+            config,
+            "trap/bus-error",
+            micro_bench_round_trips,
+            &machine,
+            3
+        );
+        micro_bench_machine_uninit(&machine);
+    }
+    if (bench_is_selected(config, "trap/intr")) {
+        if (micro_bench_machine_init(&machine, PDP11_CPU_ENGINE_LOOP, 1) != Ok)
+            return;
+        if (unibus_attach_br(&machine.unibus, 4, MICRO_BENCH_INTR_VEC) != Ok)
+            return micro_bench_machine_uninit(&machine);
+        micro_bench_load_rti(&machine, MICRO_BENCH_INTR_VEC);
+        unibus_cpu_dato(
+            &machine.unibus,
+            MICRO_BENCH_PROGRAM_ADDR,
+            0000777 /* br . */
+        );
+        bench_run(config, "trap/intr", micro_bench_intr, &machine, 2);
+        micro_bench_machine_uninit(&machine);
+    }
+}
+
+/**********
+ ** main **
+ **********/
+
+int bench_micro_run(BenchConfig const *const config) {
+    bench_run(config, "decode/instr", micro_bench_decode_instr, NULL, 0);
+    bench_run(config, "decode/table", micro_bench_decode_table, NULL, 0);
+    micro_bench_dispatch(config);
+    micro_bench_modes(config);
+    micro_bench_bus(config);
+    micro_bench_traps(config);
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "unibus_bench.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <unistd.h>
+
+#include "bench_harness.h"
+#include "pdp11/pdp11.h"
+
+#define UNIBUS_BENCH_DURATION_MS   (500)
+#define UNIBUS_BENCH_DEVICE_COUNT  (4)
+#define UNIBUS_BENCH_PROGRAM_ADDR  (0x100)
+#define UNIBUS_BENCH_TRANSFER_ADDR (0x1000)
+#define UNIBUS_BENCH_BLOCK_LEN     (256)
+
+static Pdp11 pdp = {0};
+
+/*************
+ ** helpers **
+ *************/
+
+typedef struct UnibusBenchDevice {
+    bool _Atomic *should_run;
+    bool is_block;
+    uint16_t addr;
+    uint64_t transfer_count;
+} UnibusBenchDevice;
+
+static void *unibus_bench_device_thread(void *const vself) {
+    UnibusBenchDevice *const self = vself;
+
+    uint16_t data[UNIBUS_BENCH_BLOCK_LEN] = {0};
+    while (atomic_load_explicit(self->should_run, memory_order_relaxed)) {
+        if (self->is_block) {
+            unibus_npr_dato_block(
+                &pdp.unibus,
+                self,
+                self->addr,
+                data,
+                UNIBUS_BENCH_BLOCK_LEN
+            );
+            unibus_npr_dati_block(
+                &pdp.unibus,
+                self,
+                self->addr,
+                data,
+                UNIBUS_BENCH_BLOCK_LEN
+            );
+            self->transfer_count += 2 * UNIBUS_BENCH_BLOCK_LEN;
+        } else {
+            unibus_npr_dato(&pdp.unibus, self, self->addr, data[0] + 1);
+            unibus_npr_dati(&pdp.unibus, self, self->addr, data);
+            self->transfer_count += 2;
+        }
+    }
+
+    return NULL;
+}
+
+static double unibus_bench_now_s(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/* Hammers the bus with NPR transfers from `device_count` threads at once, word
+ * by word or by blocks, and returns the total number of words per second. Also outputs how many
+ * instructions per second the CPU gets to execute meanwhile, if running. */
+static double unibus_bench_npr(
+    unsigned const device_count,
+    bool const is_block,
+    double *const out_cpu_instr_rate
+) {
+    pdp11_cpu_rx(&pdp.cpu, 0) = pdp11_cpu_rx(&pdp.cpu, 1) = 0;
+
+    bool _Atomic should_run = true;
+    UnibusBenchDevice devices[UNIBUS_BENCH_DEVICE_COUNT];
+    pthread_t threads[UNIBUS_BENCH_DEVICE_COUNT];
+
+    double const start = unibus_bench_now_s();
+    for (unsigned i = 0; i < device_count; i++) {
+        devices[i] = (UnibusBenchDevice){
+            .should_run = &should_run,
+            .is_block = is_block,
+            .addr =
+                UNIBUS_BENCH_TRANSFER_ADDR + 2 * UNIBUS_BENCH_BLOCK_LEN * i,
+            .transfer_count = 0,
+        };
+        pthread_create(
+            threads + i,
+            NULL,
+            unibus_bench_device_thread,
+            devices + i
+        );
+    }
+
+    struct timespec const duration = {
+        .tv_sec = UNIBUS_BENCH_DURATION_MS / 1000,
+        .tv_nsec = UNIBUS_BENCH_DURATION_MS % 1000 * 1000 * 1000,
+    };
+    nanosleep(&duration, NULL);
+    atomic_store(&should_run, false);
+
+    uint64_t transfer_count = 0;
+    for (unsigned i = 0; i < device_count; i++) {
+        pthread_join(threads[i], NULL);
+        transfer_count += devices[i].transfer_count;
+    }
+    double const elapsed = unibus_bench_now_s() - start;
+
+    // NOTE the program runs 3 instructions per increment of R1:R0
+    uint32_t const count = (uint32_t)pdp11_cpu_rx(&pdp.cpu, 1) << 16 |
+                           pdp11_cpu_rx(&pdp.cpu, 0);
+    *out_cpu_instr_rate = 3.0 * count / elapsed;
+    return transfer_count / elapsed;
+}
+
+/***********
+ ** bench **
+ ***********/
+
+/* Reports a word transferred as an operation, along with the instructions the
+ * CPU runs meanwhile. A single sample is taken, over the whole duration. */
+static void unibus_bench_contention(
+    BenchConfig const *const config,
+    bool const is_cpu_running,
+    bool const is_block
+) {
+    // NOTE counts in R1:R0 forever, so that the CPU keeps mastering the bus
+    uint16_t const program[] = {
+        0062700, 0000001,  // add #1, R0
+        0005501,           // adc R1
+        0000774,           // br .-6
+    };
+    for (unsigned i = 0; i < sizeof(program) / sizeof(*program); i++)
+        unibus_cpu_dato(
+            &pdp.unibus,
+            UNIBUS_BENCH_PROGRAM_ADDR + 2 * i,
+            program[i]
+        );
+    pdp11_cpu_pc(&pdp.cpu) = UNIBUS_BENCH_PROGRAM_ADDR;
+    if (is_cpu_running) pdp11_cpu_continue(&pdp.cpu);
+
+    for (unsigned device_count = 1; device_count <= UNIBUS_BENCH_DEVICE_COUNT;
+         device_count *= 2) {
+        char name[64];
+        snprintf(
+            name,
+            sizeof(name),
+            "npr/%s/cpu-%s/devices-%u",
+            is_block ? "block" : "word",
+            is_cpu_running ? "running" : "halted",
+            device_count
+        );
+        if (!bench_is_selected(config, name)) continue;
+
+        double cpu_instr_rate;
+        double const transfer_rate =
+            unibus_bench_npr(device_count, is_block, &cpu_instr_rate);
+        BenchResult const result = {
+            .ns_per_op = 1e9 / transfer_rate,
+            .stddev_ns = 0,
+            .instrs_per_s = cpu_instr_rate,
+            .ops = transfer_rate * UNIBUS_BENCH_DURATION_MS / 1000,
+            .samples = 1,
+        };
+        bench_report(config, name, &result);
+    }
+
+    if (is_cpu_running) {
+        pdp11_cpu_halt(&pdp.cpu);
+        while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+    }
+}
+
+/**********
+ ** main **
+ **********/
+
+int bench_unibus_run(BenchConfig const *const config) {
+    if (pdp11_init(&pdp, NULL, PDP11_CPU_ENGINE_THREADED, true) != Ok) return 1;
+
+    unibus_bench_contention(config, false, false);
+    unibus_bench_contention(config, true, false);
+    unibus_bench_contention(config, false, true);
+    unibus_bench_contention(config, true, true);
+
+    pdp11_uninit(&pdp);
+    return 0;
+}
@@ -0,0 +1,368 @@
+#include <inttypes.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <getopt.h>
+
+#include "pdp11/pdp11.h"
+#include "pdp11/pdp11_console.h"
+#include "pdp11/pdp11_papertape_reader.h"
+#include "pdp11/pdp11_teletype.h"
+
+/* Runs the machine without the operator's console, for scripted runs. It
+ * boots and loads tapes the way an operator would, prints the teletype to
+ * stdout, and exits once the CPU halts, waits for good or a limit is hit,
+ * telling which by the exit code. */
+
+// Instructions the CPU runs between two looks for an interrupt.
+#define HEADLESS_SLICE_INSTRS (10 * 1000)
+
+// Exit codes, along with the reason the run has stopped for.
+typedef enum HeadlessStop {
+    HEADLESS_STOP_HALT = 0,
+    HEADLESS_STOP_ERR = 1,
+    HEADLESS_STOP_INSTR_LIMIT = 2,
+    HEADLESS_STOP_TIME_LIMIT = 3,
+    HEADLESS_STOP_INTERRUPT = 4,
+    HEADLESS_STOP_WAIT = 5,
+} HeadlessStop;
+
+typedef struct HeadlessOptions {
+    Pdp11CpuEngine engine;
+    unsigned speed;
+    char const *loader, *tape;
+    char const *core;  // `NULL` for memory that starts cleared
+    bool has_start;
+    uint16_t start;
+    uint64_t max_instrs, max_ns;  // `0` for no limit
+} HeadlessOptions;
+
+static bool _Atomic is_interrupted = false;
+static bool _Atomic is_out_of_time = false;
+
+/*************
+ ** helpers **
+ *************/
+
+static void headless_usage(FILE *const file, char const *const name) {
+    fprintf(
+        file,
+        "usage: %s [options]\n"
+        " -b, --boot LOADER    boot the absolute loader from tape LOADER,\n"
+        "                      then have it load the tape and run it\n"
+        " -t, --tape TAPE      tape to put into the reader\n"
+        " -c, --core FILE      load memory from FILE and save it back on\n"
+        "                      exit, by default it starts cleared\n"
+        " -s, --start ADDR     start at octal ADDR, right away or, booting,\n"
+        "                      once the tape is loaded\n"
+        " -e, --engine NAME    loop, threaded (default), block or jit\n"
+        " -S, --speed N        times a real 11/20, 0 (default) for turbo\n"
+        " -i, --max-instrs N   stop after N instructions\n"
+        " -m, --max-ms N       stop after N ms of simulated time\n"
+        " -h, --help           print this and exit\n"
+        "exit codes: 0 halt, 1 error, 2 instruction limit, 3 time limit,\n"
+        "            4 interrupted, 5 waiting with nothing to wake it\n",
+        name
+    );
+}
+
+static bool headless_parse_engine(
+    char const *const name,
+    Pdp11CpuEngine *const out
+) {
+    static char const *const names[] = {
+        [PDP11_CPU_ENGINE_LOOP] = "loop",
+        [PDP11_CPU_ENGINE_THREADED] = "threaded",
+        [PDP11_CPU_ENGINE_BLOCK] = "block",
+        [PDP11_CPU_ENGINE_JIT] = "jit",
+    };
+    for (unsigned i = 0; i < sizeof(names) / sizeof(*names); i++)
+        if (strcmp(name, names[i]) == 0) return *out = i, true;
+    return false;
+}
+static bool headless_parse_u64(
+    char const *const str,
+    int const base,
+    uint64_t *const out
+) {
+    char *end;
+    unsigned long long const value = strtoull(str, &end, base);
+    if (*str == '\0' || *str == '-' || *end != '\0') return false;
+    return *out = value, true;
+}
+
+static bool headless_parse_options(
+    int const argc,
+    char *const argv[],
+    HeadlessOptions *const out
+) {
+    static struct option const long_options[] = {
+        {"boot", required_argument, NULL, 'b'},
+        {"tape", required_argument, NULL, 't'},
+        {"core", required_argument, NULL, 'c'},
+        {"start", required_argument, NULL, 's'},
+        {"engine", required_argument, NULL, 'e'},
+        {"speed", required_argument, NULL, 'S'},
+        {"max-instrs", required_argument, NULL, 'i'},
+        {"max-ms", required_argument, NULL, 'm'},
+        {"help", no_argument, NULL, 'h'},
+        {0},
+    };
+
+    *out = (HeadlessOptions){.engine = PDP11_CPU_ENGINE_THREADED};
+    for (int opt;
+         (opt = getopt_long(argc, argv, "b:t:c:s:e:S:i:m:h", long_options, NULL)
+         ) != -1;) {
+        uint64_t value;
+        switch (opt) {
+        case 'b': out->loader = optarg; break;
+        case 't': out->tape = optarg; break;
+        case 'c': out->core = optarg; break;
+        case 's':
+            if (!headless_parse_u64(optarg, 8, &value) || value > UINT16_MAX)
+                return false;
+            out->has_start = true, out->start = value;
+            break;
+        case 'e':
+            if (!headless_parse_engine(optarg, &out->engine)) return false;
+            break;
+        case 'S':
+            if (!headless_parse_u64(optarg, 10, &value) || value > UINT16_MAX)
+                return false;
+            out->speed = value;
+            break;
+        case 'i':
+            if (!headless_parse_u64(optarg, 10, &out->max_instrs)) return false;
+            break;
+        case 'm':
+            if (!headless_parse_u64(optarg, 10, &value) ||
+                value > UINT64_MAX / (1000 * 1000))
+                return false;
+            out->max_ns = value * 1000 * 1000;
+            break;
+        case 'h': headless_usage(stdout, argv[0]), exit(HEADLESS_STOP_HALT);
+        default: return false;
+        }
+    }
+    return optind == argc && (out->loader || out->has_start);
+}
+
+static void headless_on_interrupt(int const) {
+    atomic_store(&is_interrupted, true);
+}
+static void headless_on_out_of_time(void *const vpdp, uint16_t const) {
+    Pdp11 *const pdp = vpdp;
+    atomic_store(&is_out_of_time, true);
+    pdp11_cpu_halt(&pdp->cpu);
+}
+
+/* Runs the CPU on this thread until it stops, a slice at a time to look for
+ * an interrupt in between. The instruction limit is kept to the instruction.
+ */
+static HeadlessStop
+headless_exec(Pdp11 *const pdp, HeadlessOptions const *const options) {
+    for (;;) {
+        if (atomic_load(&is_interrupted)) return HEADLESS_STOP_INTERRUPT;
+        uint64_t slice = HEADLESS_SLICE_INSTRS;
+        if (options->max_instrs != 0) {
+            uint64_t const instrs = pdp11_cpu_instrs(&pdp->cpu);
+            if (instrs >= options->max_instrs)
+                return HEADLESS_STOP_INSTR_LIMIT;
+            if (options->max_instrs - instrs < slice)
+                slice = options->max_instrs - instrs;
+        }
+
+        switch (pdp11_cpu_run(&pdp->cpu, slice)) {
+        case PDP11_CPU_STOP_INSTRS: break;
+        // NOTE with no device to wake it, the CPU is stuck in WAIT for good
+        case PDP11_CPU_STOP_WAIT:
+            return atomic_load(&is_out_of_time) ? HEADLESS_STOP_TIME_LIMIT
+                                                : HEADLESS_STOP_WAIT;
+        case PDP11_CPU_STOP_HALT:
+            return atomic_load(&is_out_of_time) ? HEADLESS_STOP_TIME_LIMIT
+                                                : HEADLESS_STOP_HALT;
+        }
+    }
+}
+
+/* Goes through what the operator does on the console, see `README.md`. Loads
+ * the absolute loader with the bootloader, then has it load the tape, which
+ * either starts on its own, or halts to be started by hand. */
+static HeadlessStop headless_run(
+    Pdp11 *const pdp,
+    Pdp11PapertapeReader *const pr,
+    HeadlessOptions const *const options
+) {
+    Pdp11Console *const console = &pdp->console;
+    pdp11_console_next_power_control(console);
+
+    if (!options->loader) {
+        if (options->tape &&
+            pdp11_papertape_reader_load(pr, options->tape) != Ok)
+            return fprintf(stderr, "cannot open tape '%s'\n", options->tape),
+                   HEADLESS_STOP_ERR;
+        pdp11_cpu_pc(&pdp->cpu) = options->start;
+        return headless_exec(pdp, options);
+    }
+
+    pdp11_console_toggle_enable(console);
+    pdp11_console_insert_bootloader(console);
+    pdp11_console_toggle_enable(console);
+    if (pdp11_papertape_reader_load(pr, options->loader) != Ok)
+        return fprintf(stderr, "cannot open tape '%s'\n", options->loader),
+               HEADLESS_STOP_ERR;
+    pdp11_console_press_start(console);
+
+    HeadlessStop stop = headless_exec(pdp, options);
+    if (stop != HEADLESS_STOP_HALT || !options->tape) return stop;
+
+    if (pdp11_papertape_reader_load(pr, options->tape) != Ok)
+        return fprintf(stderr, "cannot open tape '%s'\n", options->tape),
+               HEADLESS_STOP_ERR;
+    pdp11_console_press_continue(console);
+    stop = headless_exec(pdp, options);
+    if (stop != HEADLESS_STOP_HALT || !options->has_start) return stop;
+
+    pdp11_cpu_pc(&pdp->cpu) = options->start;
+    return headless_exec(pdp, options);
+}
+
+static Result headless_init(
+    Pdp11 *const pdp,
+    Pdp11PapertapeReader *const pr,
+    Pdp11Teletype *const tty,
+    HeadlessOptions const *const options
+) {
+    UNROLL_CLEANUP(pdp11_init(pdp, options->core, options->engine, false), {
+        fprintf(stderr, "error initializing pdp11!\n");
+    });
+    pdp11_cpu_set_speed(&pdp->cpu, options->speed);
+
+    UNROLL_CLEANUP(
+        pdp11_papertape_reader_init(
+            pr,
+            &pdp->unibus,
+            PDP11_PAPERTAPE_READER_ADDR,
+            PDP11_PAPERTAPE_READER_INTR_VEC,
+            PDP11_PAPERTAPE_READER_INTR_PRIORITY
+        ),
+        {
+            pdp11_uninit(pdp);
+            fprintf(stderr, "error initializing papertape reader!\n");
+        }
+    );
+    // NOTE printed right to stdout, there is no console to take the terminal
+    UNROLL_CLEANUP(
+        pdp11_teletype_init(
+            tty,
+            &pdp->unibus,
+            PDP11_TELETYPE_ADDR,
+            PDP11_TELETYPE_KEYBOARD_INTR_VEC,
+            PDP11_TELETYPE_PRINTER_INTR_VEC,
+            PDP11_TELETYPE_INTR_PRIORITY,
+            stdout
+        ),
+        {
+            pdp11_papertape_reader_uninit(pr);
+            pdp11_uninit(pdp);
+            fprintf(stderr, "error initializing teletype!\n");
+        }
+    );
+
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &pdp->unibus,
+            pdp11_papertape_reader_ww_unibus_device(pr),
+            PDP11_PAPERTAPE_READER_ADDR,
+            PDP11_PAPERTAPE_READER_SIZE
+        ),
+        {
+            pdp11_teletype_uninit(tty);
+            pdp11_papertape_reader_uninit(pr);
+            pdp11_uninit(pdp);
+            fprintf(stderr, "error attaching papertape reader!\n");
+        }
+    );
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &pdp->unibus,
+            pdp11_teletype_ww_unibus_device(tty),
+            PDP11_TELETYPE_ADDR,
+            PDP11_TELETYPE_SIZE
+        ),
+        {
+            pdp11_teletype_uninit(tty);
+            pdp11_papertape_reader_uninit(pr);
+            pdp11_uninit(pdp);
+            fprintf(stderr, "error attaching teletype!\n");
+        }
+    );
+
+    // NOTE the time limit halts the CPU in between two instructions
+    if (options->max_ns != 0)
+        UNROLL_CLEANUP(
+            pdp11_cpu_schedule(
+                &pdp->cpu,
+                options->max_ns,
+                (Pdp11Event){.fire = headless_on_out_of_time, .ctx = pdp}
+            ),
+            {
+                pdp11_teletype_uninit(tty);
+                pdp11_papertape_reader_uninit(pr);
+                pdp11_uninit(pdp);
+                fprintf(stderr, "error scheduling the time limit!\n");
+            }
+        );
+
+    return Ok;
+}
+static void headless_uninit(
+    Pdp11 *const pdp,
+    Pdp11PapertapeReader *const pr,
+    Pdp11Teletype *const tty
+) {
+    pdp11_teletype_uninit(tty);
+    pdp11_papertape_reader_uninit(pr);
+    pdp11_uninit(pdp);
+}
+
+/**********
+ ** main **
+ **********/
+
+int main(int const argc, char *const argv[]) {
+    HeadlessOptions options;
+    if (!headless_parse_options(argc, argv, &options)) {
+        headless_usage(stderr, argv[0]);
+        return HEADLESS_STOP_ERR;
+    }
+    signal(SIGINT, headless_on_interrupt);
+    signal(SIGTERM, headless_on_interrupt);
+
+    Pdp11 pdp = {0};
+    Pdp11PapertapeReader pr = {0};
+    Pdp11Teletype tty = {0};
+    if (headless_init(&pdp, &pr, &tty, &options) != Ok)
+        return HEADLESS_STOP_ERR;
+
+    HeadlessStop const stop = headless_run(&pdp, &pr, &options);
+
+    fflush(stdout);
+    fprintf(
+        stderr,
+        "stopped (%u) at PC %06o after %" PRIu64 " instructions, %" PRIu64
+        " ns\n",
+        stop,
+        pdp11_cpu_pc(&pdp.cpu),
+        pdp11_cpu_instrs(&pdp.cpu),
+        pdp11_cpu_time(&pdp.cpu)
+    );
+
+    headless_uninit(&pdp, &pr, &tty);
+    return stop;
+}
@@ -1,16 +1,35 @@
 #ifndef PDP11_CPU_H
 #define PDP11_CPU_H
 
+#include <setjmp.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
-#include <semaphore.h>
 
+#include "conviniences.h"
+#include "pdp11/cpu/pdp11_cpu_instr.h"
+#include "pdp11/cpu/pdp11_cpu_trace.h"
 #include "pdp11/cpu/pdp11_psw.h"
+#include "pdp11/pdp11_scheduler.h"
 #include "pdp11/unibus/unibus.h"
 
 #define PDP11_CPU_REG_COUNT (8)
 
+// NOTE when set, every fetched word goes through `pdp11_cpu_instr` and the
+// opcode switches again instead of the predecoded table
+#ifndef PDP11_CPU_REFERENCE_DECODE
+#  define PDP11_CPU_REFERENCE_DECODE (0)
+#endif
+
+// NOTE when set, the ALU instructions record their operands and result instead
+// of computing the condition codes, which are only materialized into
+// `_psw.flags` when something reads them
+#ifndef PDP11_CPU_LAZY_FLAGS
+#  define PDP11_CPU_LAZY_FLAGS (1)
+#endif
+
 enum {
     PDP11_CPU_NO_TRAP = 0000,  // NOTE assumes 'zero' as no trap
 
@@ -32,24 +51,173 @@ typedef enum Pdp11CpuState {
     PDP11_CPU_STATE_STEP,
 } Pdp11CpuState;
 
+typedef enum Pdp11CpuEngine {
+    PDP11_CPU_ENGINE_LOOP,      // a plain fetch-decode-execute loop
+    PDP11_CPU_ENGINE_THREADED,  // direct-threaded, with computed gotos
+    PDP11_CPU_ENGINE_BLOCK,     // runs cached decoded basic blocks
+    PDP11_CPU_ENGINE_JIT,       // blocks, with hot ones compiled to x86-64
+} Pdp11CpuEngine;
+
+// Why `pdp11_cpu_run` has returned.
+typedef enum Pdp11CpuStop {
+    PDP11_CPU_STOP_HALT,    // halted, by an instruction or by anyone else
+    PDP11_CPU_STOP_WAIT,    // waits for an interrupt, with no event to come
+    PDP11_CPU_STOP_INSTRS,  // has run as many instructions as it was let to
+} Pdp11CpuStop;
+// NOTE for `pdp11_cpu_run` to run on until the CPU stops by itself
+#define PDP11_CPU_NO_LIMIT (UINT64_MAX)
+
+// NOTE code is tracked for invalidation by the word, but dropped by the page,
+// which a block never crosses
+#define PDP11_CPU_CODE_PAGE_SHIFT (8)
+#define PDP11_CPU_CODE_PAGE_COUNT                                              \
+    ((UINT16_MAX + 1) >> PDP11_CPU_CODE_PAGE_SHIFT)
+
+// NOTE the engines check nothing but this word between the instructions of a
+// batch, so whatever needs them to look at the rest of the state raises it
+typedef enum Pdp11CpuAttention {
+    PDP11_CPU_ATTENTION_INTR = 1 << 0,   // an interrupt has been requested
+    PDP11_CPU_ATTENTION_STATE = 1 << 1,  // state changed or the thread stops
+    PDP11_CPU_ATTENTION_PSW = 1 << 2,    // PSW loaded, may have the T-bit set
+    PDP11_CPU_ATTENTION_BUS = 1 << 3,    // another master waits for the bus
+    PDP11_CPU_ATTENTION_CODE = 1 << 4,   // cached code has been written to
+} Pdp11CpuAttention;
+
+// Instructions run between two checks of the full CPU state.
+#ifndef PDP11_CPU_BATCH_LEN
+#  define PDP11_CPU_BATCH_LEN (256)
+#endif
+
+// Simulated nanoseconds the quickest instruction takes, see
+// `pdp11_cpu_instr_ns`. A batch lasts as long as this many of them.
+#define PDP11_CPU_MIN_INSTR_NS (1200)
+// Simulated nanoseconds it takes to get into a trap or interrupt handler.
+#define PDP11_CPU_TRAP_NS (8900)
+#define PDP11_CPU_INTR_NS (7500)
+
+// How far simulated time may run ahead of the paced host time before the CPU
+// sleeps it off, and fall behind before pacing gives up on catching up.
+#ifndef PDP11_CPU_PACE_AHEAD_NS
+#  define PDP11_CPU_PACE_AHEAD_NS (1000 * 1000)
+#endif
+#ifndef PDP11_CPU_PACE_BEHIND_NS
+#  define PDP11_CPU_PACE_BEHIND_NS (100 * 1000 * 1000)
+#endif
+
+typedef struct Pdp11CpuBlockStats {
+    uint64_t hits, misses, invalidations;
+    uint64_t compiled;  // runs of instructions compiled to host code
+} Pdp11CpuBlockStats;
+
+typedef struct Pdp11CpuBlock Pdp11CpuBlock;
+
+typedef enum Pdp11CpuFlagsOp {
+    PDP11_CPU_FLAGS_OP_NONE,   // `_psw.flags` are up to date
+    PDP11_CPU_FLAGS_OP_LOGIC,  // nz of the result, v cleared, c as recorded
+    PDP11_CPU_FLAGS_OP_INC,
+    PDP11_CPU_FLAGS_OP_DEC,
+    PDP11_CPU_FLAGS_OP_ADD,
+    PDP11_CPU_FLAGS_OP_SUB,  // `dst - src`, also used for `cmp` swapped
+} Pdp11CpuFlagsOp;
+typedef struct Pdp11CpuLazyFlags {
+    uint8_t op;  // Pdp11CpuFlagsOp
+    bool is_byte;
+    bool c;  // for the ops that do not compute it
+    uint16_t src, dst, res;
+} Pdp11CpuLazyFlags;
+
 typedef struct Pdp11Cpu {
     Pdp11Psw _psw;
+    Pdp11CpuLazyFlags _lazy_flags;  // NOTE owned by the CPU thread
     uint16_t _r[PDP11_CPU_REG_COUNT];
 
-    Pdp11CpuState volatile _state;  // TODO? maybe redo with condition vars
+    Pdp11CpuState _Atomic _state;
+    // NOTE signaled on leaving HALT or WAIT, and when the thread has to stop
+    pthread_mutex_t __state_lock;
+    pthread_cond_t __state_changed;
+
+    uint8_t _Atomic __attention;  // `Pdp11CpuAttention` flags
 
-    uint8_t _Atomic __pending_intr;
-    sem_t __pending_intr_sem;
+    // NOTE device events fire in the CPU thread, as the instructions run
+    Pdp11Scheduler _scheduler;
+    int32_t __batch_ns;  // NOTE owned by the CPU thread
+    // NOTE owned by the CPU thread, where a bus error unwinds to, set by the
+    // engine for every batch
+    jmp_buf __bus_error;
+
+    // times faster than a real 11/20 to run, `0` for as fast as possible
+    unsigned volatile _speed;
+    // NOTE owned by the CPU thread, the host time and simulated time pacing
+    // counts from, along with the speed they were taken at
+    uint64_t __pace_host, __pace_time;
+    unsigned __pace_speed;
+
+    // NOTE owned by the CPU thread, the count `__instrs` may not go past in
+    // the current run
+    uint64_t __instrs, __instrs_limit;
+    uint64_t __intrs;
+    uint64_t __idle_skipped_ns, __delay_skipped_ns, __copy_skipped_ns;
 
     Unibus *_unibus;
+    // RAM at the bottom of the bus, accessed without going through the bus
+    uint16_t volatile *_ram;
+    uint16_t _ram_size;
+
+    Pdp11CpuEngine _engine;
+    bool __should_trace_trap;
+    bool __has_waited;  // NOTE owned by the CPU thread
+
+    // block cache, only allocated for `PDP11_CPU_ENGINE_BLOCK/JIT`
+    Pdp11CpuBlock *_blocks;
+    // NOTE a bit per word, set for the ones a cached block has decoded
+    uint64_t _Atomic __is_code_word[(UINT16_MAX + 1) / 2 / 64];
+    uint32_t _Atomic __code_page_gen[PDP11_CPU_CODE_PAGE_COUNT];
+    uint64_t __block_hits, __block_misses;
+    uint64_t _Atomic __block_invalidations;
+
+    // host code buffer, only mapped for `PDP11_CPU_ENGINE_JIT`
+    uint8_t *_jit_code;
+    size_t _jit_code_len;
+    uint64_t __jit_compiles;
 
+#if PDP11_CPU_TRACE
+    Pdp11CpuTrace _trace;
+#endif
+
+    // NOTE without the thread, whoever calls `pdp11_cpu_run` is the CPU thread
+    bool _is_threaded;
     pthread_t _thread;
     bool volatile __should_thread_run;
 } Pdp11Cpu;
 
-Result pdp11_cpu_init(Pdp11Cpu *const self, Unibus *const unibus);
+typedef void Pdp11CpuExec(Pdp11Cpu *const self, Pdp11CpuInstr const instr);
+typedef struct Pdp11CpuDecoded {
+    Pdp11CpuExec *exec;
+    Pdp11CpuInstr instr;
+    Pdp11CpuOp op;
+    // of the operands, which specialized handler `exec` is, see
+    // `pdp11_cpu_classes`
+    uint8_t classes;
+    uint32_t time;  // simulated nanoseconds, see `pdp11_cpu_instr_ns`
+} Pdp11CpuDecoded;
+
+/* Spawns the CPU thread if `is_threaded`, which runs the CPU whenever it is
+ * not halted. Otherwise the CPU only runs inside `pdp11_cpu_run`. */
+Result pdp11_cpu_init(
+    Pdp11Cpu *const self,
+    Unibus *const unibus,
+    Pdp11CpuEngine const engine,
+    bool const is_threaded
+);
 void pdp11_cpu_uninit(Pdp11Cpu *const self);
 void pdp11_cpu_reset(Pdp11Cpu *const self);
+// Lets the CPU access the `size` bytes of RAM at bus address 0 through `ram`
+// directly. The RAM still has to be attached to the bus for everyone else.
+void pdp11_cpu_map_ram(
+    Pdp11Cpu *const self,
+    void volatile *const ram,
+    uint16_t const size
+);
 
 static inline uint16_t volatile *
 pdp11_cpu_rx(Pdp11Cpu *const self, unsigned const i) {
@@ -59,19 +227,114 @@ pdp11_cpu_rx(Pdp11Cpu *const self, unsigned const i) {
 #define pdp11_cpu_pc(SELF_)     pdp11_cpu_rx((SELF_), 7)
 #define pdp11_cpu_sp(SELF_)     pdp11_cpu_rx((SELF_), 6)
 
+#if PDP11_CPU_TRACE
+static inline Pdp11CpuTrace *pdp11_cpu_trace(Pdp11Cpu *const self) {
+    return &self->_trace;
+}
+#endif
+
 static inline Pdp11Psw *pdp11_cpu_psw(Pdp11Cpu *const self) {
     return &self->_psw;
 }
 #define pdp11_cpu_psw(SELF_) (*pdp11_cpu_psw(SELF_))
 
+// Materializes the lazily evaluated condition codes into `_psw.flags`. Must be
+// called before `_psw` is read or written by anything but the instructions.
+void pdp11_cpu_sync_flags(Pdp11Cpu *const self);
+
+// Drops the cached blocks of code page `page`, see `pdp11_cpu_note_write`.
+void pdp11_cpu_drop_code_page(Pdp11Cpu *const self, unsigned const page);
+// Invalidates the cached blocks decoded from the word at `addr`, if any. Must
+// be called on every write to memory, by any bus master.
+static forceinline void
+pdp11_cpu_note_write(Pdp11Cpu *const self, uint16_t const addr) {
+    unsigned const word = addr >> 1;
+    if (atomic_load(self->__is_code_word + word / 64) >> word % 64 & 1)
+        pdp11_cpu_drop_code_page(self, addr >> PDP11_CPU_CODE_PAGE_SHIFT);
+}
+// Same as `pdp11_cpu_note_write`, for every word from `addr` up to `end`.
+void pdp11_cpu_note_write_run(
+    Pdp11Cpu *const self,
+    uint32_t const addr,
+    uint32_t const end
+);
+Pdp11CpuBlockStats pdp11_cpu_block_stats(Pdp11Cpu const *const self);
+
+static inline void pdp11_cpu_raise_attention(
+    Pdp11Cpu *const self,
+    Pdp11CpuAttention const attention
+) {
+    atomic_fetch_or(&self->__attention, attention);
+}
+
 static inline Pdp11CpuState pdp11_cpu_state(Pdp11Cpu const *const self) {
     return self->_state;
 }
 
-void pdp11_cpu_intr(Pdp11Cpu *const self, uint8_t const intr);
+// Looks the encoding up in the predecoded table, which is built on the first
+// `pdp11_cpu_init`.
+Pdp11CpuDecoded const *pdp11_cpu_decode(uint16_t const encoded);
+
+// Simulated nanoseconds the CPU has run for.
+static inline uint64_t pdp11_cpu_time(Pdp11Cpu const *const self) {
+    return pdp11_scheduler_now(&self->_scheduler);
+}
+/* Schedules `event` to fire in the CPU thread, at the first instruction
+ * boundary `delay` simulated nanoseconds from now. While the CPU waits for an
+ * interrupt, time skips to the next event at once. Fails if too many events
+ * are scheduled. */
+Result pdp11_cpu_schedule(
+    Pdp11Cpu *const self,
+    uint64_t const delay,
+    Pdp11Event const event
+);
+// Drops every scheduled event with the same `fire` and `ctx`.
+void pdp11_cpu_cancel(Pdp11Cpu *const self, Pdp11Event const event);
+// Instructions the CPU has run, the skipped loop iterations included.
+static inline uint64_t pdp11_cpu_instrs(Pdp11Cpu const *const self) {
+    return self->__instrs;
+}
+// Interrupts the CPU has taken.
+static inline uint64_t pdp11_cpu_intrs(Pdp11Cpu const *const self) {
+    return self->__intrs;
+}
+// Simulated nanoseconds skipped in loops polling devices for the next event.
+static inline uint64_t pdp11_cpu_idle_skipped_ns(Pdp11Cpu const *const self) {
+    return self->__idle_skipped_ns;
+}
+// Simulated nanoseconds run at once in loops only counting a register down.
+static inline uint64_t
+pdp11_cpu_delay_skipped_ns(Pdp11Cpu const *const self) {
+    return self->__delay_skipped_ns;
+}
+// Simulated nanoseconds run at once in loops copying or filling RAM.
+static inline uint64_t pdp11_cpu_copy_skipped_ns(Pdp11Cpu const *const self) {
+    return self->__copy_skipped_ns;
+}
+
+/* Sets how many times faster than a real 11/20 the CPU runs, `0` for as fast
+ * as the host allows. The CPU sleeps in batches to stay in step with the host
+ * clock, and does not try to catch up after it has fallen far behind. */
+void pdp11_cpu_set_speed(Pdp11Cpu *const self, unsigned const speed);
+static inline unsigned pdp11_cpu_speed(Pdp11Cpu const *const self) {
+    return self->_speed;
+}
+
+/* Tells the CPU that a device has posted an interrupt request on the bus,
+ * which it takes at the next instruction boundary its priority allows. */
+void pdp11_cpu_intr(Pdp11Cpu *const self);
 
 void pdp11_cpu_halt(Pdp11Cpu *const self);
 void pdp11_cpu_continue(Pdp11Cpu *const self);
 void pdp11_cpu_single_step(Pdp11Cpu *const self);
 
+/* Runs the CPU on the calling thread, continuing it first if halted, until it
+ * stops by itself or has run `max_instrs` more instructions. Device events
+ * fire, and pacing sleeps, on the calling thread as well. Only for a CPU
+ * initialized without its thread. */
+Pdp11CpuStop pdp11_cpu_run(Pdp11Cpu *const self, uint64_t const max_instrs);
+// Runs a single instruction on the calling thread, as `pdp11_cpu_single_step`
+// has the CPU thread do. Only for a CPU initialized without its thread.
+Pdp11CpuStop pdp11_cpu_step(Pdp11Cpu *const self);
+
 #endif
@@ -0,0 +1,230 @@
+#ifndef PDP11_CPU_ENGINE_H
+#define PDP11_CPU_ENGINE_H
+
+// NOTE this is shared between the CPU engines only, nothing outside of
+// `cpu/` should need it
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pdp11/cpu/pdp11_cpu.h"
+#include "pdp11/cpu/pdp11_cpu_instr.h"
+
+#define PDP11_CPU_EXEC_DECL(NAME_, name_) Pdp11CpuExec pdp11_cpu_exec_##name_;
+PDP11_CPU_OPS(PDP11_CPU_EXEC_DECL)
+#undef PDP11_CPU_EXEC_DECL
+
+extern Pdp11CpuExec *const pdp11_cpu_execs[PDP11_CPU_OP_COUNT];
+extern Pdp11CpuDecoded pdp11_cpu_decoded[UINT16_MAX + 1];
+
+// X-macros over the operand instructions, as `X(ENUM_NAME, name, size, kind)`,
+// where kind tells which operands are read and which are written
+#define PDP11_CPU_O_OPS(X)                                                     \
+    X(SWAB, swab, word, RMW)                                                   \
+    X(CLR, clr, word, W)                                                       \
+    X(COM, com, word, RMW)                                                     \
+    X(INC, inc, word, RMW)                                                     \
+    X(DEC, dec, word, RMW)                                                     \
+    X(NEG, neg, word, RMW)                                                     \
+    X(ADC, adc, word, RMW)                                                     \
+    X(SBC, sbc, word, RMW)                                                     \
+    X(TST, tst, word, R)                                                       \
+    X(ROR, ror, word, RMW)                                                     \
+    X(ROL, rol, word, RMW)                                                     \
+    X(ASR, asr, word, RMW)                                                     \
+    X(ASL, asl, word, RMW)                                                     \
+    X(SXT, sxt, word, W)                                                       \
+    X(CLRB, clrb, byte, W)                                                     \
+    X(COMB, comb, byte, RMW)                                                   \
+    X(INCB, incb, byte, RMW)                                                   \
+    X(DECB, decb, byte, RMW)                                                   \
+    X(NEGB, negb, byte, RMW)                                                   \
+    X(ADCB, adcb, byte, RMW)                                                   \
+    X(SBCB, sbcb, byte, RMW)                                                   \
+    X(TSTB, tstb, byte, R)                                                     \
+    X(RORB, rorb, byte, RMW)                                                   \
+    X(ROLB, rolb, byte, RMW)                                                   \
+    X(ASRB, asrb, byte, RMW)                                                   \
+    X(ASLB, aslb, byte, RMW)
+#define PDP11_CPU_OO_OPS(X)                                                    \
+    X(MOV, mov, word, MOV)                                                     \
+    X(CMP, cmp, word, R)                                                       \
+    X(BIT, bit, word, R)                                                       \
+    X(BIC, bic, word, RMW)                                                     \
+    X(BIS, bis, word, RMW)                                                     \
+    X(ADD, add, word, RMW)                                                     \
+    X(SUB, sub, word, RMW)                                                     \
+    X(MOVB, movb, byte, MOV)                                                   \
+    X(CMPB, cmpb, byte, R)                                                     \
+    X(BITB, bitb, byte, R)                                                     \
+    X(BICB, bicb, byte, RMW)                                                   \
+    X(BISB, bisb, byte, RMW)
+#define PDP11_CPU_RO_OPS(X)                                                    \
+    X(MUL, mul, word, R)                                                       \
+    X(DIV, div, word, R)                                                       \
+    X(ASH, ash, byte, R)                                                       \
+    X(ASHC, ashc, word, R)                                                     \
+    X(XOR, xor, word, RMW)
+
+// Handlers specialized by operand class, `reg` for mode `0` and `mem` for the
+// rest, which the generic handlers pick between.
+#define PDP11_CPU_EXEC_O_DECL(NAME_, name_, ...)                               \
+    Pdp11CpuExec pdp11_cpu_exec_##name_##_reg, pdp11_cpu_exec_##name_##_mem;
+#define PDP11_CPU_EXEC_OO_DECL(NAME_, name_, ...)                              \
+    Pdp11CpuExec pdp11_cpu_exec_##name_##_reg_reg,                             \
+        pdp11_cpu_exec_##name_##_reg_mem, pdp11_cpu_exec_##name_##_mem_reg,   \
+        pdp11_cpu_exec_##name_##_mem_mem;
+PDP11_CPU_O_OPS(PDP11_CPU_EXEC_O_DECL)
+PDP11_CPU_OO_OPS(PDP11_CPU_EXEC_OO_DECL)
+PDP11_CPU_RO_OPS(PDP11_CPU_EXEC_O_DECL)
+#undef PDP11_CPU_EXEC_O_DECL
+#undef PDP11_CPU_EXEC_OO_DECL
+
+// NOTE the cache is indexed by PC, so that it aliases every 8 KiB
+#define PDP11_CPU_BLOCK_COUNT   (4096)
+#define PDP11_CPU_BLOCK_MAX_LEN (16)
+
+// What compiled code runs off, besides the CPU itself.
+typedef struct Pdp11CpuJitFrame {
+    uint8_t nzvc[4];
+    int32_t ns;       // simulated nanoseconds it may still spend
+    uint32_t instrs;  // instructions it may still run
+} Pdp11CpuJitFrame;
+// Host code for a run of instructions. Returns the PC to go on from, having
+// taken whatever it has run off the frame.
+typedef uint16_t
+Pdp11CpuJitCode(Pdp11Cpu *const self, Pdp11CpuJitFrame *const frame);
+
+// NOTE copied out of `pdp11_cpu_decoded`, so that a block runs off its own
+// few cache lines
+typedef struct Pdp11CpuBlockRecord {
+    Pdp11CpuExec *exec;
+    Pdp11CpuInstr instr;
+    uint32_t time;
+    uint16_t pc, encoded;
+} Pdp11CpuBlockRecord;
+typedef struct Pdp11CpuBlockJit {
+    Pdp11CpuJitCode *code;
+    uint8_t len;
+    uint32_t time;  // simulated nanoseconds a whole pass of the run takes
+} Pdp11CpuBlockJit;
+struct Pdp11CpuBlock {
+    uint16_t pc;
+    uint8_t len;  // NOTE `0` for an empty slot
+    uint16_t jit_starts;  // NOTE a bit per record a compiled run starts at
+    uint32_t gen;  // `__code_page_gen` of the page at the time of decoding
+    // NOTE counts on across a rebuild at the same PC, so that code which gets
+    // written to stays hot
+    uint32_t runs;
+    bool is_jit_scanned;  // whether the runs to compile have been looked for
+    Pdp11CpuBlockRecord records[PDP11_CPU_BLOCK_MAX_LEN];
+    Pdp11CpuBlockJit jits[PDP11_CPU_BLOCK_MAX_LEN];
+};
+static_assert(PDP11_CPU_BLOCK_MAX_LEN <= 16);
+
+// Number of runs of a block after which it gets compiled.
+#define PDP11_CPU_JIT_THRESHOLD (32)
+
+// Maps the code buffer. Never fails, without it blocks are just interpreted.
+void pdp11_cpu_jit_init(Pdp11Cpu *const self);
+void pdp11_cpu_jit_uninit(Pdp11Cpu *const self);
+// Compiles every run of at least two supported instructions in `block`.
+void pdp11_cpu_jit_compile(Pdp11Cpu *const self, Pdp11CpuBlock *const block);
+/* Runs the compiled run at record `first` of `block`, spending at most `ns`,
+ * and keeps the CPU state in sync around it. Returns the nanoseconds it has
+ * spent, `0` if it has left on its very first instruction, which is then up
+ * to the interpreter. */
+uint32_t pdp11_cpu_jit_run(
+    Pdp11Cpu *const self,
+    Pdp11CpuBlock *const block,
+    unsigned const first,
+    int32_t const ns
+);
+
+// Simulated nanoseconds the instruction takes on an 11/20, by its addressing
+// modes. Traps are included, interrupts are not.
+uint32_t pdp11_cpu_instr_ns(Pdp11CpuOp const op, Pdp11CpuInstr const instr);
+
+/* The engines run instructions in batches. The state of the CPU is fully
+ * checked only around a batch, within it an engine leaves early only once
+ * `pdp11_cpu_needs_attention`. A batch lasts some simulated nanoseconds, which
+ * the engine spends on the instructions until none are left. */
+
+// Runs everything due before a batch. Returns the nanoseconds to spend, or `0`
+// if the CPU is not running anymore, or has no instructions left to run, and
+// the engine should return.
+int32_t pdp11_cpu_before_batch(Pdp11Cpu *const self);
+static inline bool pdp11_cpu_needs_attention(Pdp11Cpu *const self) {
+    return atomic_load_explicit(&self->__attention, memory_order_acquire);
+}
+// Instructions the CPU may still run before `pdp11_cpu_run` has to return.
+// Nothing may run more of them at once, not even compiled code or a skip.
+static inline uint64_t pdp11_cpu_instrs_left(Pdp11Cpu const *const self) {
+    return self->__instrs_limit - self->__instrs;
+}
+// Whether every fetch gets recorded into the trace ring.
+static inline bool pdp11_cpu_is_tracing(Pdp11Cpu const *const self) {
+#if PDP11_CPU_TRACE
+    return pdp11_cpu_trace_is_on(&self->_trace);
+#else
+    return (void)self, false;
+#endif
+}
+uint16_t pdp11_cpu_fetch_any(Pdp11Cpu *const self);
+/* Fetches the instruction at PC, moving PC past it. NOTE every engine does
+ * this once per instruction, so the common case, a word of RAM with tracing
+ * off, is inline, and `pdp11_cpu_fetch_any` only does the rest. */
+static inline uint16_t pdp11_cpu_fetch(Pdp11Cpu *const self) {
+    uint16_t const pc = pdp11_cpu_pc(self);
+    if (pc >= self->_ram_size || pc & 1 || pdp11_cpu_is_tracing(self))
+        return pdp11_cpu_fetch_any(self);
+    pdp11_cpu_pc(self) = pc + 2, self->__instrs++;
+    return self->_ram[pc >> 1];
+}
+// Records the fetch into the trace ring, if tracing is on.
+void pdp11_cpu_trace_fetch(
+    Pdp11Cpu *const self,
+    uint16_t const pc,
+    uint16_t const encoded
+);
+/* The instructions do not check their bus accesses, a bus error unwinds
+ * straight to `__bus_error`, which every engine sets with `setjmp` right after
+ * `pdp11_cpu_before_batch`. Takes the trap, which ends the batch, and whose
+ * time is charged instead of the time of the instruction. */
+void pdp11_cpu_take_bus_error(Pdp11Cpu *const self);
+// Runs everything due after a batch, `left` being the nanoseconds the batch
+// has not got to spend, negative if the last instruction overran it.
+void pdp11_cpu_after_batch(Pdp11Cpu *const self, int32_t const left);
+
+/* Whole iterations of a loop, each lasting `ns`, that end before the next
+ * event, so that it still fires, and any interrupt it requests is taken, at
+ * the very instruction it would. `0` if the event is due already, which one
+ * scheduled from another thread may be, `UINT64_MAX` if there is none. */
+static inline uint64_t
+pdp11_cpu_iters_before_event(Pdp11Cpu const *const self, uint64_t const ns) {
+    uint64_t const next = pdp11_scheduler_next(&self->_scheduler),
+                   now = pdp11_cpu_time(self);
+    if (next == PDP11_SCHEDULER_NEVER) return UINT64_MAX;
+    return next > now ? (next - now - 1) / ns : 0;
+}
+
+// Longest idle loop, in instructions along with its branch.
+#define PDP11_CPU_IDLE_LOOP_MAX_LEN (4)
+
+// Skips whole iterations of the idle loop the CPU is in, if any, up to the
+// next event. See `pdp11_cpu_idle.c`.
+void pdp11_cpu_skip_idle_loop(Pdp11Cpu *const self);
+// Runs all but the last iteration of the delay loop at PC, if any, at once,
+// still ending before the next event. See `pdp11_cpu_delay.c`.
+void pdp11_cpu_skip_delay_loop(Pdp11Cpu *const self);
+// Does all but the last iteration of the copy or fill loop at PC, if any, on
+// the host memory, still ending before the next event. See `pdp11_cpu_copy.c`.
+void pdp11_cpu_skip_copy_loop(Pdp11Cpu *const self);
+
+// Each engine runs instructions while the CPU is running, then returns.
+void pdp11_cpu_loop_run(Pdp11Cpu *const self);
+void pdp11_cpu_threaded_run(Pdp11Cpu *const self);
+void pdp11_cpu_block_run(Pdp11Cpu *const self);
+
+#endif
@@ -63,4 +63,92 @@ static_assert(sizeof((Pdp11CpuInstr){0}.u) == sizeof(uint16_t));
 
 Pdp11CpuInstr pdp11_cpu_instr(uint16_t const encoded);
 
+// X-macro over every operation an encoding can decode to, as
+// `X(ENUM_NAME, handler_name)`
+#define PDP11_CPU_OPS(X)                                                       \
+    X(RESERVED, reserved)                                                      \
+                                                                               \
+    X(MOV, mov)                                                                \
+    X(CMP, cmp)                                                                \
+    X(BIT, bit)                                                                \
+    X(BIC, bic)                                                                \
+    X(BIS, bis)                                                                \
+    X(ADD, add)                                                                \
+    X(SUB, sub)                                                                \
+    X(MOVB, movb)                                                              \
+    X(CMPB, cmpb)                                                              \
+    X(BITB, bitb)                                                              \
+    X(BICB, bicb)                                                              \
+    X(BISB, bisb)                                                              \
+                                                                               \
+    X(MUL, mul)                                                                \
+    X(DIV, div)                                                                \
+    X(ASH, ash)                                                                \
+    X(ASHC, ashc)                                                              \
+    X(XOR, xor)                                                                \
+                                                                               \
+    X(SWAB, swab)                                                              \
+    X(CLR, clr)                                                                \
+    X(COM, com)                                                                \
+    X(INC, inc)                                                                \
+    X(DEC, dec)                                                                \
+    X(NEG, neg)                                                                \
+    X(ADC, adc)                                                                \
+    X(SBC, sbc)                                                                \
+    X(TST, tst)                                                                \
+    X(ROR, ror)                                                                \
+    X(ROL, rol)                                                                \
+    X(ASR, asr)                                                                \
+    X(ASL, asl)                                                                \
+    X(SXT, sxt)                                                                \
+    X(CLRB, clrb)                                                              \
+    X(COMB, comb)                                                              \
+    X(INCB, incb)                                                              \
+    X(DECB, decb)                                                              \
+    X(NEGB, negb)                                                              \
+    X(ADCB, adcb)                                                              \
+    X(SBCB, sbcb)                                                              \
+    X(TSTB, tstb)                                                              \
+    X(RORB, rorb)                                                              \
+    X(ROLB, rolb)                                                              \
+    X(ASRB, asrb)                                                              \
+    X(ASLB, aslb)                                                              \
+                                                                               \
+    X(BR, br)                                                                  \
+    X(BNE_BE, bne_be)                                                          \
+    X(BGE_BL, bge_bl)                                                          \
+    X(BG_BLE, bg_ble)                                                          \
+    X(BPL_BMI, bpl_bmi)                                                        \
+    X(BHI_BLOS, bhi_blos)                                                      \
+    X(BVC_BVS, bvc_bvs)                                                        \
+    X(BCC_BCS, bcc_bcs)                                                        \
+                                                                               \
+    X(RTS, rts)                                                                \
+    X(SPL, spl)                                                                \
+    X(SOB, sob)                                                                \
+    X(JSR, jsr)                                                                \
+    X(JMP, jmp)                                                                \
+    X(MARK, mark)                                                              \
+    X(CLNZVC_SENZVC, clnzvc_senzvc)                                            \
+                                                                               \
+    X(EMT, emt)                                                                \
+    X(TRAP, trap)                                                              \
+    X(RTI_RTT, rti_rtt)                                                        \
+    X(BPT, bpt)                                                                \
+    X(IOT, iot)                                                                \
+                                                                               \
+    X(HALT, halt)                                                              \
+    X(WAIT, wait)                                                              \
+    X(RESET, reset)
+
+typedef enum Pdp11CpuOp {
+#define PDP11_CPU_OP_ENUM(NAME_, name_) PDP11_CPU_OP_##NAME_,
+    PDP11_CPU_OPS(PDP11_CPU_OP_ENUM)
+#undef PDP11_CPU_OP_ENUM
+
+    PDP11_CPU_OP_COUNT,
+} Pdp11CpuOp;
+
+Pdp11CpuOp pdp11_cpu_op(Pdp11CpuInstr const instr);
+
 #endif
@@ -0,0 +1,83 @@
+#ifndef PDP11_CPU_TRACE_H
+#define PDP11_CPU_TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// NOTE `0` compiles the tracing out completely
+#ifndef PDP11_CPU_TRACE
+#  define PDP11_CPU_TRACE (1)
+#endif
+
+#define PDP11_CPU_TRACE_LEN       (4096)  // NOTE must be a power of two
+#define PDP11_CPU_TRACE_ADDR_LEN  (2)
+
+typedef enum Pdp11CpuTraceKind {
+    PDP11_CPU_TRACE_KIND_INSTR,  // `val` is the encoded instruction
+    PDP11_CPU_TRACE_KIND_TRAP,   // `val` is the vector
+    PDP11_CPU_TRACE_KIND_INTR,   // `val` is the vector
+} Pdp11CpuTraceKind;
+
+typedef struct Pdp11CpuTraceEntry {
+    uint8_t kind;
+    uint8_t addr_count;
+    uint16_t pc, val, psw;
+    uint16_t addrs[PDP11_CPU_TRACE_ADDR_LEN];  // operand addresses
+} Pdp11CpuTraceEntry;
+
+typedef enum Pdp11CpuTraceOption {
+    PDP11_CPU_TRACE_ON = 1 << 0,
+    PDP11_CPU_TRACE_DUMP_ON_HALT = 1 << 1,
+    PDP11_CPU_TRACE_DUMP_ON_TRAP = 1 << 2,
+} Pdp11CpuTraceOption;
+
+/* Binary ring of the last executed instructions and traps. Written only by
+ * the CPU thread, without any locks; readers may see the oldest entries
+ * being overwritten while dumping. */
+typedef struct Pdp11CpuTrace {
+    uint8_t volatile options;  // `Pdp11CpuTraceOption` flags
+
+    uint32_t _Atomic _head;  // NOTE total count of entries ever recorded
+    Pdp11CpuTraceEntry _entries[PDP11_CPU_TRACE_LEN];
+} Pdp11CpuTrace;
+
+void pdp11_cpu_trace_init(Pdp11CpuTrace *const self);
+
+static inline bool pdp11_cpu_trace_is_on(Pdp11CpuTrace const *const self) {
+    return self->options & PDP11_CPU_TRACE_ON;
+}
+
+static inline void pdp11_cpu_trace_record(
+    Pdp11CpuTrace *const self,
+    Pdp11CpuTraceEntry const entry
+) {
+    uint32_t const head =
+        atomic_load_explicit(&self->_head, memory_order_relaxed);
+    self->_entries[head & (PDP11_CPU_TRACE_LEN - 1)] = entry;
+    atomic_store_explicit(&self->_head, head + 1, memory_order_release);
+}
+// Attaches an operand address to the last recorded entry.
+static inline void
+pdp11_cpu_trace_record_addr(Pdp11CpuTrace *const self, uint16_t const addr) {
+    uint32_t const head =
+        atomic_load_explicit(&self->_head, memory_order_relaxed);
+    if (head == 0) return;
+
+    Pdp11CpuTraceEntry *const entry =
+        self->_entries + ((head - 1) & (PDP11_CPU_TRACE_LEN - 1));
+    if (entry->addr_count < PDP11_CPU_TRACE_ADDR_LEN)
+        entry->addrs[entry->addr_count++] = addr;
+}
+
+/* Prints the ring from the oldest entry on, in the same text format the CPU
+ * used to print while running. `is_verbose` adds PSW and operand addresses to
+ * the executed instructions. */
+void pdp11_cpu_trace_dump(
+    Pdp11CpuTrace const *const self,
+    FILE *const file,
+    bool const is_verbose
+);
+
+#endif
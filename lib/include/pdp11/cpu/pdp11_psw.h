@@ -1,11 +1,9 @@
 #ifndef PDP11_PSW_H
 #define PDP11_PSW_H
 
-#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 
-#include <bits/pthreadtypes.h>
 #include <result.h>
 
 #include "bits.h"
@@ -15,7 +13,6 @@ typedef struct Pdp11PswFlags {
 } Pdp11PswFlags;
 typedef struct Pdp11Psw {
     uint8_t volatile _priority : 3;
-    pthread_cond_t _priority_changed;
     Pdp11PswFlags volatile flags;
 } Pdp11Psw;
 
@@ -28,7 +25,6 @@ static inline uint8_t pdp11_psw_priority(Pdp11Psw const *const self) {
 static inline void
 pdp11_psw_set_priority(Pdp11Psw *const self, uint8_t const value) {
     self->_priority = value;
-    pthread_cond_signal(&self->_priority_changed);
 }
 
 static inline uint16_t pdp11_psw_to_word(Pdp11Psw const *const self) {
@@ -46,10 +42,4 @@ static inline void pdp11_psw_set(Pdp11Psw *const self, uint16_t const value) {
     pdp11_psw_set_priority(self, BITS(value, 5, 7));
 }
 
-void pdp11_psw_wait_for_sufficient_priority(
-    Pdp11Psw *const self,
-    uint8_t const priority,
-    pthread_mutex_t *const lock
-);
-
 #endif
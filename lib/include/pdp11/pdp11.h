@@ -20,10 +20,12 @@
 #define PDP11_RAM_SIZE (24 * 1024 * 2)
 
 #define PDP11_PAPERTAPE_READER_ADDR          (0177550)
+#define PDP11_PAPERTAPE_READER_SIZE          (4)
 #define PDP11_PAPERTAPE_READER_INTR_VEC      (070)
 #define PDP11_PAPERTAPE_READER_INTR_PRIORITY (04)
 
 #define PDP11_TELETYPE_ADDR              (0177560)
+#define PDP11_TELETYPE_SIZE              (8)
 #define PDP11_TELETYPE_KEYBOARD_INTR_VEC (060)
 #define PDP11_TELETYPE_PRINTER_INTR_VEC  (064)
 #define PDP11_TELETYPE_INTR_PRIORITY     (04)
@@ -34,10 +36,17 @@ typedef struct Pdp11 {
     Pdp11Console console;
 
     Pdp11Ram ram;
-    UnibusDevice *periphs;
 } Pdp11;
 
-Result pdp11_init(Pdp11 *const self);
+/* `ram_filepath` is where the RAM is loaded from and saved back to, `NULL`
+ * for RAM that starts cleared every time. See `pdp11_cpu_init` for what
+ * `is_cpu_threaded` does. */
+Result pdp11_init(
+    Pdp11 *const self,
+    char const *const ram_filepath,
+    Pdp11CpuEngine const cpu_engine,
+    bool const is_cpu_threaded
+);
 void pdp11_uninit(Pdp11 *const self);
 
 #endif
@@ -1,12 +1,16 @@
 #ifndef PDP11_PAPERTAPE_READER_H
 #define PDP11_PAPERTAPE_READER_H
 
-#include <pthread.h>
 #include <stdio.h>
 
 #include "pdp11/unibus/unibus.h"
 #include "pdp11/unibus/unibus_device.h"
 
+// Simulated time the reader takes per character, ten times the real speed.
+#ifndef PDP11_PAPERTAPE_READER_CHAR_NS
+#  define PDP11_PAPERTAPE_READER_CHAR_NS (1000000000 / 300 / 10)
+#endif
+
 typedef struct Pdp11PapertapeReaderStatus {
     bool error : 1;
     uint16_t : 3;
@@ -26,12 +30,9 @@ typedef struct Pdp11PapertapeReader {
 
     uint16_t _starting_addr;
     uint8_t _intr_vec;
-    unsigned _intr_priority;
 
+    // NOTE the device runs on events, so it needs no locks of its own
     Unibus *_unibus;
-
-    pthread_t _thread;
-    pthread_mutex_t _lock;
 } Pdp11PapertapeReader;
 
 Result pdp11_papertape_reader_init(
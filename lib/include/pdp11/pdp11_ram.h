@@ -31,6 +31,10 @@ void pdp11_ram_uninit(Pdp11Ram *const self);
 Result pdp11_ram_save(Pdp11Ram *const self);
 Result pdp11_ram_load(Pdp11Ram *const self);
 
+static inline void volatile *pdp11_ram_data(Pdp11Ram const *const self) {
+    return self->_data;
+}
+
 UnibusDevice pdp11_ram_ww_unibus_device(Pdp11Ram *const self);
 
 #endif
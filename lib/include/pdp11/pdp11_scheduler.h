@@ -0,0 +1,73 @@
+#ifndef PDP11_SCHEDULER_H
+#define PDP11_SCHEDULER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <result.h>
+
+// How many events may be scheduled at once.
+#ifndef PDP11_SCHEDULER_LEN
+#  define PDP11_SCHEDULER_LEN (64)
+#endif
+
+#define PDP11_SCHEDULER_NEVER (UINT64_MAX)
+
+// What a device wants done once its delay has passed.
+typedef struct Pdp11Event {
+    void (*fire)(void *const ctx, uint16_t const data);
+    void *ctx;
+    uint16_t data;
+} Pdp11Event;
+
+typedef struct Pdp11SchedulerEntry {
+    uint64_t time;
+    uint64_t seq;  // NOTE keeps the events due at the same time in order
+    Pdp11Event event;
+} Pdp11SchedulerEntry;
+
+/* Binary heap of events keyed on simulated time, in nanoseconds. Time only
+ * moves when its owner advances it, so a run fires the same events at the same
+ * points whatever the host does meanwhile. Events may be scheduled from any
+ * thread, but fire in the thread that advances time. */
+typedef struct Pdp11Scheduler {
+    uint64_t _Atomic _now;
+    uint64_t _Atomic _next;  // time of the earliest event, or `NEVER`
+
+    pthread_mutex_t _lock;
+    uint64_t _seq;
+    unsigned _len;
+    Pdp11SchedulerEntry _heap[PDP11_SCHEDULER_LEN];
+} Pdp11Scheduler;
+
+Result pdp11_scheduler_init(Pdp11Scheduler *const self);
+void pdp11_scheduler_uninit(Pdp11Scheduler *const self);
+
+static inline uint64_t pdp11_scheduler_now(Pdp11Scheduler const *const self) {
+    return atomic_load_explicit(&self->_now, memory_order_relaxed);
+}
+static inline uint64_t pdp11_scheduler_next(Pdp11Scheduler const *const self) {
+    return atomic_load_explicit(&self->_next, memory_order_acquire);
+}
+
+/* Schedules `event` to fire `delay` nanoseconds from now. Outputs, unless
+ * `NULL`, whether it has become the earliest one, so that whoever sleeps till
+ * then may be woken. Fails if the heap is full. */
+Result pdp11_scheduler_schedule(
+    Pdp11Scheduler *const self,
+    uint64_t const delay,
+    Pdp11Event const event,
+    bool *const out_is_earliest
+);
+// Drops every scheduled event with the same `fire` and `ctx`.
+void pdp11_scheduler_cancel(Pdp11Scheduler *const self, Pdp11Event const event);
+
+/* Moves time `delta` nanoseconds on, firing whatever gets due in the order of
+ * time. Events scheduled by the fired ones fire too, if already due. */
+void pdp11_scheduler_advance(Pdp11Scheduler *const self, uint64_t const delta);
+// Moves time on to the earliest event and fires it, along with the others due.
+void pdp11_scheduler_skip(Pdp11Scheduler *const self);
+
+#endif
@@ -1,12 +1,16 @@
 #ifndef PDP11_TELETYPE_H
 #define PDP11_TELETYPE_H
 
-#include <pthread.h>
 #include <stdio.h>
 
 #include "pdp11/unibus/unibus.h"
 #include "pdp11/unibus/unibus_device.h"
 
+// Simulated time the printer takes per character, ten times the real speed.
+#ifndef PDP11_TELETYPE_PRINTER_CHAR_NS
+#  define PDP11_TELETYPE_PRINTER_CHAR_NS (1000000000 / 10 / 10)
+#endif
+
 typedef struct Pdp11TeletypeKeyboardStatus {
     uint16_t : 4;
     bool : 1;
@@ -32,18 +36,17 @@ typedef struct Pdp11Teletype {
     Pdp11TeletypePrinterStatus _printer_status;
     uint8_t _printer_buffer;
 
-    char *_buf;
-
     uint16_t _starting_addr;
     uint8_t _keyboard_intr_vec, _printer_intr_vec;
-    unsigned _intr_priority;
 
-    Unibus *_unibus;
+    FILE *_printer_file;  // NOTE not owned
 
-    pthread_t _thread;
-    pthread_mutex_t _keyboard_lock, _printer_lock;
+    // NOTE the device runs on events, so it needs no locks of its own
+    Unibus *_unibus;
 } Pdp11Teletype;
 
+// Initializes the teletype, printing into `printer_file`, which stays owned by
+// the caller.
 Result pdp11_teletype_init(
     Pdp11Teletype *const self,
     Unibus *const unibus,
@@ -51,7 +54,7 @@ Result pdp11_teletype_init(
     uint8_t const keyboard_intr_vec,
     uint8_t const printer_intr_vec,
     unsigned const intr_priority,
-    size_t const buf_len
+    FILE *const printer_file
 );
 void pdp11_teletype_uninit(Pdp11Teletype *const self);
 
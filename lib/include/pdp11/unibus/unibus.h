@@ -2,27 +2,92 @@
 #define UNIBUS_H
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include <result.h>
 #include <woodi.h>
 
+#include "pdp11/pdp11_scheduler.h"
 #include "pdp11/unibus/unibus_device.h"
 
-#define UNIBUS_DEVICE_COUNT (8)
-
 #define UNIBUS_DEVICE_CPU (NULL)
 
+// Addresses below the I/O page are decoded by pages, the I/O page by words.
+#define UNIBUS_PAGE_SHIFT    (6)
+#define UNIBUS_IO_PAGE_ADDR  (0160000)
+#define UNIBUS_PAGE_COUNT    (UNIBUS_IO_PAGE_ADDR >> UNIBUS_PAGE_SHIFT)
+#define UNIBUS_IO_WORD_COUNT ((0200000 - UNIBUS_IO_PAGE_ADDR) >> 1)
+
 #define UNIBUS_CPU_PSW_ADDRESS (0177776)
 
+// How many times a master checks a bus line before it goes to sleep. Only
+// spins if there is another processor to free the line meanwhile.
+#ifndef UNIBUS_SPIN_COUNT
+#  define UNIBUS_SPIN_COUNT (256)
+#endif
+
+// How many words a block NPR transfer moves per bus mastership, before it lets
+// the others, and the CPU, have the bus.
+#ifndef UNIBUS_NPR_BURST_LEN
+#  define UNIBUS_NPR_BURST_LEN (64)
+#endif
+
+// Interrupt requests are pending by BR levels, 1 to 7, of up to
+// `UNIBUS_BR_CHAIN_LEN` devices each, all within a single word.
+#define UNIBUS_BR_LEVEL_COUNT  (8)
+#define UNIBUS_BR_CHAIN_LEN    (8)
+#define UNIBUS_BR_VECTOR_COUNT (0400 >> 2)
+
+// A bus address resolved to whatever answers it, so that accesses through it
+// skip the device scan. `ptr` is the host memory backing the word at `addr`,
+// if any, otherwise `device` handles the access, and `UNIBUS_DEVICE_CPU`
+// stands for the CPU registers mapped onto the bus.
+typedef struct UnibusLoc {
+    uint16_t addr;
+    void volatile *ptr;
+    UnibusDevice const *device;
+} UnibusLoc;
+
+typedef struct UnibusAttachedDevice {
+    UnibusDevice device;
+    struct UnibusAttachedDevice *_next;
+} UnibusAttachedDevice;
+
+// Where a vector is requested from: the BR level, zero if not wired, and the
+// position down the daisy chain of that level.
+typedef struct UnibusBrLine {
+    uint8_t level, position;
+} UnibusBrLine;
+
 typedef struct Pdp11Cpu Pdp11Cpu;
 typedef struct Unibus {
-    UnibusDevice devices[UNIBUS_DEVICE_COUNT];
+    UnibusAttachedDevice *_devices;  // NOTE in the order of attaching
+    // Owners of the addresses, `NULL` where nothing answers.
+    UnibusDevice const *_page_map[UNIBUS_PAGE_COUNT];
+    UnibusDevice const *_io_map[UNIBUS_IO_WORD_COUNT];
 
-    pthread_mutex_t _bbsy, _sack;
+    // BBSY and SACK, along with the count of masters sleeping on them, all in
+    // a single word, so that a master takes an idle bus with a single CAS
+    uint32_t _Atomic _grant;
     UnibusDevice const volatile *_master, *_next_master;
 
+    // masters that have waited for too long sleep here
+    unsigned _spin_count;
+    pthread_mutex_t _park_lock;
+    pthread_cond_t _unparked;
+
+    // bit `position` of byte `level` is the pending request of that line
+    uint64_t _Atomic _br_pending;
+    UnibusBrLine _br_lines[UNIBUS_BR_VECTOR_COUNT];  // NOTE by vector / 4
+    uint8_t _br_vectors[UNIBUS_BR_LEVEL_COUNT][UNIBUS_BR_CHAIN_LEN];
+    uint8_t _br_chain_lens[UNIBUS_BR_LEVEL_COUNT];
+
+    // NOTE only counted by the master, which the bus is exclusive to
+    uint64_t __transactions;
+
     Pdp11Cpu *_cpu;
 } Unibus;
 
@@ -30,16 +95,66 @@ void unibus_init(Unibus *const self, Pdp11Cpu *const cpu);
 void unibus_uninit(Unibus *const self);
 void unibus_reset(Unibus *const self);
 
+// Makes `device` answer the `size` bytes starting at `starting_addr`. Below the
+// I/O page the range has to be aligned to the decode pages, within it to
+// words. Fails if the range is taken by another device.
+Result unibus_attach(
+    Unibus *const self,
+    UnibusDevice const device,
+    uint16_t const starting_addr,
+    uint32_t const size
+);
+
+// DATI and DATO cycles gone through the bus, by the CPU or by NPR, a block
+// transfer counting a cycle per word. The CPU accessing its RAM directly makes
+// none.
+static inline uint64_t unibus_transactions(Unibus const *const self) {
+    return self->__transactions;
+}
+
 static inline bool unibus_is_running(Unibus const *const self) {
     return self->_master == UNIBUS_DEVICE_CPU;
 }
 
-void unibus_br_intr(
+/* Wires an interrupt request through `vector` at BR level `priority`. Lines
+ * of a level are chained in the order of wiring, so the first one wired wins
+ * among the pending requests of its level. Fails if the vector is wired
+ * already or the chain is full. */
+Result unibus_attach_br(
     Unibus *const self,
     unsigned const priority,
-    void const *const device,
-    uint8_t const intr
+    uint8_t const vector
+);
+/* Posts the interrupt request through `vector` and returns at once, the CPU
+ * takes it whenever its priority gets below the level. A request still
+ * pending is posted only once. Fails if the vector is not wired. */
+Result unibus_br_intr(Unibus *const self, uint8_t const vector);
+// Whether a request above `priority` is pending.
+static inline bool
+unibus_br_is_pending(Unibus const *const self, unsigned const priority) {
+    uint64_t const pending =
+        atomic_load_explicit(&self->_br_pending, memory_order_acquire);
+    return priority + 1 < UNIBUS_BR_LEVEL_COUNT &&
+           (pending >> (priority + 1) * UNIBUS_BR_CHAIN_LEN) != 0;
+}
+/* For the CPU only. Withdraws the highest request above `priority`, the
+ * first one down the daisy chain within a level, and outputs its vector.
+ * Returns `false` if there is none. */
+bool unibus_br_take(
+    Unibus *const self,
+    unsigned const priority,
+    uint8_t *const out_vector
+);
+
+/* Schedules `event` to fire `delay` simulated nanoseconds from now, in the
+ * CPU thread, which owns the bus meanwhile. So devices driven by events only
+ * see their registers accessed by a single master at a time. */
+Result unibus_schedule(
+    Unibus *const self,
+    uint64_t const delay,
+    Pdp11Event const event
 );
+void unibus_cancel(Unibus *const self, Pdp11Event const event);
 
 Result unibus_npr_dati(
     Unibus *const self,
@@ -59,6 +174,33 @@ Result unibus_npr_datob(
     uint16_t const addr,
     uint8_t const data
 );
+// Moves `len` words between the bus, from `addr` on, and `buf`, in bursts of
+// `UNIBUS_NPR_BURST_LEN` words. Runs a device maps to host memory are copied
+// as a whole. Fails on the first word nothing answers, having moved the ones
+// before it.
+Result unibus_npr_dati_block(
+    Unibus *const self,
+    void const *const device,
+    uint16_t addr,
+    uint16_t *buf,
+    size_t len
+);
+Result unibus_npr_dato_block(
+    Unibus *const self,
+    void const *const device,
+    uint16_t addr,
+    uint16_t const *buf,
+    size_t len
+);
+
+/* Makes the calling thread the owner of the bus as the CPU, for a run of
+ * instructions, so that its own accesses in between skip the arbitration. Other
+ * masters are asked to wait through `PDP11_CPU_ATTENTION_BUS`, and they get the
+ * bus on `unibus_cpu_release`, before the CPU can acquire it again. The NPRs
+ * the owning thread makes itself, from the events it fires, go through right
+ * away. */
+void unibus_cpu_acquire(Unibus *const self);
+void unibus_cpu_release(Unibus *const self);
 
 Result
 unibus_cpu_dati(Unibus *const self, uint16_t const addr, uint16_t *const out);
@@ -67,4 +209,25 @@ unibus_cpu_dato(Unibus *const self, uint16_t const addr, uint16_t const data);
 Result
 unibus_cpu_datob(Unibus *const self, uint16_t const addr, uint8_t const data);
 
+// Resolves `addr` once, for the CPU to access it repeatedly, e.g. for both the
+// read and the write of a read-modify-write operand. `is_byte` allows odd
+// addresses. Fails if nothing answers the address.
+Result unibus_cpu_resolve(
+    Unibus const *const self,
+    uint16_t const addr,
+    bool const is_byte,
+    UnibusLoc *const out
+);
+uint16_t unibus_cpu_loc_dati(Unibus *const self, UnibusLoc const *const loc);
+void unibus_cpu_loc_dato(
+    Unibus *const self,
+    UnibusLoc const *const loc,
+    uint16_t const data
+);
+void unibus_cpu_loc_datob(
+    Unibus *const self,
+    UnibusLoc const *const loc,
+    uint8_t const data
+);
+
 #endif
@@ -6,6 +6,9 @@
 
 #include <woodi.h>
 
+// `_try_map` claims `addr` like `_try_read` does, but without side effects. It
+// sets `out_ptr` to the host memory backing `addr`, or to `NULL` if the address
+// has to go through `_try_read` and `_try_write_*`.
 #define UNIBUS_DEVICE_INTERFACE(Self)                                          \
     {                                                                          \
         void (*const _reset)(Self *const self);                                \
@@ -24,6 +27,11 @@
             uint16_t const addr,                                               \
             uint8_t const val                                                  \
         );                                                                     \
+        bool (*const _try_map)(                                                \
+            Self *const self,                                                  \
+            uint16_t const addr,                                               \
+            void volatile **const out_ptr                                      \
+        );                                                                     \
     }
 WRAPPER(UnibusDevice, UNIBUS_DEVICE_INTERFACE);
 
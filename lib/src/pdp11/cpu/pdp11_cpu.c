@@ -1,16 +1,21 @@
 #include "pdp11/cpu/pdp11_cpu.h"
 
 #include <pthread.h>
+#include <setjmp.h>
 #include <stdalign.h>
 #include <stdatomic.h>
 #include <stddef.h>
+#include <stdnoreturn.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #include <assert.h>
 #include <unistd.h>
 
 #include "conviniences.h"
-#include "pdp11/cpu/pdp11_cpu_instr.h"
+#include "pdp11/cpu/pdp11_cpu_engine.h"
 
 #undef pdp11_cpu_rx
 #define pdp11_cpu_rx(SELF_, I_) (*(uint16_t *)pdp11_cpu_rx((SELF_), (I_)))
@@ -23,214 +28,120 @@ static inline uint8_t *pdp11_cpu_rl(Pdp11Cpu *const self, unsigned const i) {
 #undef pdp11_cpu_sp
 #define pdp11_cpu_sp(SELF_) pdp11_cpu_rx((SELF_), 6)
 
-/***********************
- ** a word and a byte **
- ***********************/
-
-typedef struct Pdp11Word Pdp11Word;
-typedef struct Pdp11WordVtbl {
-    uint16_t (*const read)(Pdp11Word const *const self);
-    void (*const write)(Pdp11Word const *const self, uint16_t const value);
-} Pdp11WordVtbl;
-struct Pdp11Word {
-    uint16_t const addr;
-    void *const owner;
-
-    Pdp11WordVtbl const *const vtbl;
-};
-
-static uint16_t pdp11_cpu_reg_word_read(Pdp11Word const *const self) {
-    return pdp11_cpu_rx((Pdp11Cpu *)self->owner, self->addr);
-}
-static void
-pdp11_cpu_reg_word_write(Pdp11Word const *const self, uint16_t const value) {
-    pdp11_cpu_rx((Pdp11Cpu *)self->owner, self->addr) = value;
-}
-static Pdp11Word
-pdp11_word_from_cpu_reg(Pdp11Cpu *const cpu, uint16_t const r_i) {
-    static Pdp11WordVtbl const vtbl = {
-        .read = pdp11_cpu_reg_word_read,
-        .write = pdp11_cpu_reg_word_write,
-    };
-    return (Pdp11Word){.addr = r_i, .owner = cpu, .vtbl = &vtbl};
-}
-
-static uint16_t pdp11_unibus_word_read(Pdp11Word const *const self) {
-    uint16_t data;
-    return unibus_cpu_dati(self->owner, self->addr, &data), data;
-}
-static void
-pdp11_unibus_word_write(Pdp11Word const *const self, uint16_t const value) {
-    unibus_cpu_dato(self->owner, self->addr, value);
-}
-static Pdp11Word
-pdp11_word_from_unibus(Unibus *const unibus, uint16_t const addr) {
-    static Pdp11WordVtbl const vtbl = {
-        .read = pdp11_unibus_word_read,
-        .write = pdp11_unibus_word_write,
-    };
-    uint16_t _;
-    if (unibus_cpu_dati(unibus, addr, &_) != Ok) return (Pdp11Word){0};
-    return (Pdp11Word){.addr = addr, .owner = unibus, .vtbl = &vtbl};
-}
-
-typedef struct Pdp11Byte Pdp11Byte;
-typedef struct Pdp11ByteVtbl {
-    uint8_t (*const read)(Pdp11Byte const *const self);
-    void (*const write)(Pdp11Byte const *const self, uint8_t const value);
-} Pdp11ByteVtbl;
-struct Pdp11Byte {
-    uint16_t const addr;
-    void *const owner;
-
-    Pdp11ByteVtbl const *const vtbl;
-};
-
-static uint8_t pdp11_cpu_reg_byte_read(Pdp11Byte const *const self) {
-    return pdp11_cpu_rl((Pdp11Cpu *)self->owner, self->addr);
-}
-static void
-pdp11_cpu_reg_byte_write(Pdp11Byte const *const self, uint8_t const value) {
-    pdp11_cpu_rl((Pdp11Cpu *)self->owner, self->addr) = value;
-}
-static Pdp11ByteVtbl const pdp11_cpu_reg_byte_vtbl = {
-    .read = pdp11_cpu_reg_byte_read,
-    .write = pdp11_cpu_reg_byte_write,
-};
-static Pdp11Byte
-pdp11_byte_from_cpu_reg(Pdp11Cpu *const cpu, uint16_t const r_i) {
-    return (Pdp11Byte
-    ){.addr = r_i, .owner = cpu, .vtbl = &pdp11_cpu_reg_byte_vtbl};
-}
-
-static uint8_t pdp11_unibus_byte_read(Pdp11Byte const *const self) {
-    uint16_t data;
-    unibus_cpu_dati(self->owner, self->addr & ~(uint16_t)1, &data);
-    return self->addr & 1 ? (uint8_t)(data >> 8) : (uint8_t)data;
-}
-static void
-pdp11_unibus_byte_write(Pdp11Byte const *const self, uint8_t const value) {
-    unibus_cpu_datob(self->owner, self->addr, value);
-}
-static Pdp11Byte
-pdp11_byte_from_unibus(Unibus *const unibus, uint16_t const addr) {
-    static Pdp11ByteVtbl const vtbl = {
-        .read = pdp11_unibus_byte_read,
-        .write = pdp11_unibus_byte_write,
-    };
-    uint16_t _;
-    if (unibus_cpu_dati(unibus, addr & ~(uint16_t)1, &_) != Ok)
-        return (Pdp11Byte){0};
-    return (Pdp11Byte){.addr = addr, .owner = unibus, .vtbl = &vtbl};
-}
-
 /****************
  ** instr decl **
  ****************/
 
+// NOTE the instructions only compute results and flags, the operands are read
+// and written by the handlers
+
 // SINGLE-OP
 
 // general
 
-forceinline void pdp11_cpu_instr_clr(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_clrb(Pdp11Cpu *const self, Pdp11Byte const dst);
-forceinline void pdp11_cpu_instr_inc(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_incb(Pdp11Cpu *const self, Pdp11Byte const dst);
-forceinline void pdp11_cpu_instr_dec(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_decb(Pdp11Cpu *const self, Pdp11Byte const dst);
+forceinline uint16_t pdp11_cpu_instr_clr(Pdp11Cpu *const self);
+forceinline uint8_t pdp11_cpu_instr_clrb(Pdp11Cpu *const self);
+forceinline uint16_t
+pdp11_cpu_instr_inc(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_incb(Pdp11Cpu *const self, uint8_t const dst_val);
+forceinline uint16_t
+pdp11_cpu_instr_dec(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_decb(Pdp11Cpu *const self, uint8_t const dst_val);
+
+forceinline uint16_t
+pdp11_cpu_instr_neg(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_negb(Pdp11Cpu *const self, uint8_t const dst_val);
 
-forceinline void pdp11_cpu_instr_neg(Pdp11Cpu *const self, Pdp11Word const dst);
 forceinline void
-pdp11_cpu_instr_negb(Pdp11Cpu *const self, Pdp11Byte const dst);
-
-forceinline void pdp11_cpu_instr_tst(Pdp11Cpu *const self, Pdp11Word const src);
+pdp11_cpu_instr_tst(Pdp11Cpu *const self, uint16_t const src_val);
 forceinline void
-pdp11_cpu_instr_tstb(Pdp11Cpu *const self, Pdp11Byte const src);
+pdp11_cpu_instr_tstb(Pdp11Cpu *const self, uint8_t const src_val);
 
 // NOTE this is a `COMplement` instruction, like `not` in intel
-forceinline void pdp11_cpu_instr_com(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_comb(Pdp11Cpu *const self, Pdp11Byte const dst);
+forceinline uint16_t
+pdp11_cpu_instr_com(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_comb(Pdp11Cpu *const self, uint8_t const dst_val);
 
 // shifts
 
-forceinline void pdp11_cpu_instr_asr(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_asrb(Pdp11Cpu *const self, Pdp11Byte const dst);
-forceinline void pdp11_cpu_instr_asl(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_aslb(Pdp11Cpu *const self, Pdp11Byte const dst);
+forceinline uint16_t
+pdp11_cpu_instr_asr(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_asrb(Pdp11Cpu *const self, uint8_t const dst_val);
+forceinline uint16_t
+pdp11_cpu_instr_asl(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_aslb(Pdp11Cpu *const self, uint8_t const dst_val);
 
 forceinline void pdp11_cpu_instr_ash(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Byte const src
+    uint8_t const src_val
 );
 forceinline void pdp11_cpu_instr_ashc(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Word const src
+    uint16_t const src_val
 );
 
 // multiple-percision
 
-forceinline void pdp11_cpu_instr_adc(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_adcb(Pdp11Cpu *const self, Pdp11Byte const dst);
-forceinline void pdp11_cpu_instr_sbc(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_sbcb(Pdp11Cpu *const self, Pdp11Byte const dst);
+forceinline uint16_t
+pdp11_cpu_instr_adc(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_adcb(Pdp11Cpu *const self, uint8_t const dst_val);
+forceinline uint16_t
+pdp11_cpu_instr_sbc(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_sbcb(Pdp11Cpu *const self, uint8_t const dst_val);
 
-forceinline void pdp11_cpu_instr_sxt(Pdp11Cpu *const self, Pdp11Word const dst);
+forceinline uint16_t pdp11_cpu_instr_sxt(Pdp11Cpu *const self);
 
 // rotates
 
-forceinline void pdp11_cpu_instr_ror(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_rorb(Pdp11Cpu *const self, Pdp11Byte const dst);
-forceinline void pdp11_cpu_instr_rol(Pdp11Cpu *const self, Pdp11Word const dst);
-forceinline void
-pdp11_cpu_instr_rolb(Pdp11Cpu *const self, Pdp11Byte const dst);
+forceinline uint16_t
+pdp11_cpu_instr_ror(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_rorb(Pdp11Cpu *const self, uint8_t const dst_val);
+forceinline uint16_t
+pdp11_cpu_instr_rol(Pdp11Cpu *const self, uint16_t const dst_val);
+forceinline uint8_t
+pdp11_cpu_instr_rolb(Pdp11Cpu *const self, uint8_t const dst_val);
 
-forceinline void
-pdp11_cpu_instr_swab(Pdp11Cpu *const self, Pdp11Word const dst);
+forceinline uint16_t
+pdp11_cpu_instr_swab(Pdp11Cpu *const self, uint16_t const dst_val);
 
 // DUAL-OP
 
 // arithmetic
 
-forceinline void pdp11_cpu_instr_mov(
+forceinline uint16_t
+pdp11_cpu_instr_mov(Pdp11Cpu *const self, uint16_t const src_val);
+forceinline uint8_t
+pdp11_cpu_instr_movb(Pdp11Cpu *const self, uint8_t const src_val);
+forceinline uint16_t pdp11_cpu_instr_add(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 );
-forceinline void pdp11_cpu_instr_movb(
+forceinline uint16_t pdp11_cpu_instr_sub(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
-);
-forceinline void pdp11_cpu_instr_add(
-    Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
-);
-forceinline void pdp11_cpu_instr_sub(
-    Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 );
 forceinline void pdp11_cpu_instr_cmp(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 );
 forceinline void pdp11_cpu_instr_cmpb(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
+    uint8_t const src_val,
+    uint8_t const dst_val
 );
 
 // register destination
@@ -238,51 +149,51 @@ forceinline void pdp11_cpu_instr_cmpb(
 forceinline void pdp11_cpu_instr_mul(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Word const src
+    uint16_t const src_val
 );
 forceinline void pdp11_cpu_instr_div(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Word const src
+    uint16_t const src_val
 );
 
-forceinline void pdp11_cpu_instr_xor(
+forceinline uint16_t pdp11_cpu_instr_xor(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Word const dst
+    uint16_t const dst_val
 );
 
 // logical
 
 forceinline void pdp11_cpu_instr_bit(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 );
 forceinline void pdp11_cpu_instr_bitb(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
+    uint8_t const src_val,
+    uint8_t const dst_val
 );
-forceinline void pdp11_cpu_instr_bis(
+forceinline uint16_t pdp11_cpu_instr_bis(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 );
-forceinline void pdp11_cpu_instr_bisb(
+forceinline uint8_t pdp11_cpu_instr_bisb(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
+    uint8_t const src_val,
+    uint8_t const dst_val
 );
-forceinline void pdp11_cpu_instr_bic(
+forceinline uint16_t pdp11_cpu_instr_bic(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 );
-forceinline void pdp11_cpu_instr_bicb(
+forceinline uint8_t pdp11_cpu_instr_bicb(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
+    uint8_t const src_val,
+    uint8_t const dst_val
 );
 
 // PROGRAM CONTROL
@@ -381,455 +292,1170 @@ forceinline void pdp11_cpu_instr_clnzvc_senzvc(
  ** private **
  *************/
 
-static Result pdp11_stack_push(Pdp11Cpu *const self, uint16_t const value) {
+// lazy flags
+
+/* Evaluates the pending lazy operation into condition codes. Left to the
+ * compiler to inline, it is too big to force into every instruction. */
+static Pdp11PswFlags pdp11_cpu_eval_flags(Pdp11Cpu const *const self) {
+    Pdp11CpuLazyFlags const *const lazy = &self->_lazy_flags;
+    unsigned const sign_i = lazy->is_byte ? 7 : 15;
+    uint16_t const mask = lazy->is_byte ? 0x00FF : 0xFFFF;
+    uint16_t const src = lazy->src & mask, dst = lazy->dst & mask,
+                   res = lazy->res & mask;
+
+    Pdp11PswFlags flags = {
+        .t = self->_psw.flags.t,
+        .n = BIT(res, sign_i),
+        .z = res == 0,
+        .v = 0,
+        .c = lazy->c,
+    };
+    switch (lazy->op) {
+    case PDP11_CPU_FLAGS_OP_LOGIC: break;
+    case PDP11_CPU_FLAGS_OP_INC: flags.v = res == 1u << sign_i; break;
+    case PDP11_CPU_FLAGS_OP_DEC: flags.v = res == (1u << sign_i) - 1; break;
+    case PDP11_CPU_FLAGS_OP_ADD: {
+        flags.v = BIT(src, sign_i) == BIT(dst, sign_i) &&
+                  BIT(src, sign_i) != BIT(res, sign_i);
+        flags.c = (uint32_t)src + dst > mask;
+    } break;
+    case PDP11_CPU_FLAGS_OP_SUB: {
+        flags.v = BIT(dst, sign_i) != BIT(src, sign_i) &&
+                  BIT(src, sign_i) == BIT(res, sign_i);
+        flags.c = src > dst;
+    } break;
+    default: assert(false);
+    }
+    return flags;
+}
+/* Computes the current condition codes without materializing them. */
+static forceinline Pdp11PswFlags pdp11_cpu_flags(Pdp11Cpu const *const self) {
+    if (self->_lazy_flags.op == PDP11_CPU_FLAGS_OP_NONE)
+        return self->_psw.flags;
+    return pdp11_cpu_eval_flags(self);
+}
+static inline bool pdp11_cpu_flag_c(Pdp11Cpu const *const self) {
+    switch (self->_lazy_flags.op) {
+    case PDP11_CPU_FLAGS_OP_NONE: return self->_psw.flags.c;
+    case PDP11_CPU_FLAGS_OP_LOGIC:
+    case PDP11_CPU_FLAGS_OP_INC:
+    case PDP11_CPU_FLAGS_OP_DEC: return self->_lazy_flags.c;
+    default: return pdp11_cpu_flags(self).c;
+    }
+}
+static forceinline void pdp11_cpu_set_lazy_flags(
+    Pdp11Cpu *const self,
+    Pdp11CpuFlagsOp const op,
+    bool const is_byte,
+    uint16_t const src,
+    uint16_t const dst,
+    uint16_t const res,
+    bool const c
+) {
+    self->_lazy_flags = (Pdp11CpuLazyFlags){
+        .op = op,
+        .is_byte = is_byte,
+        .c = c,
+        .src = src,
+        .dst = dst,
+        .res = res,
+    };
+#if !PDP11_CPU_LAZY_FLAGS
+    pdp11_cpu_sync_flags(self);
+#endif
+}
+
+/* Every state change goes through here, so that the thread sleeping in HALT
+ * or WAIT gets woken and a running batch gets cut short. */
+static void
+pdp11_cpu_set_state(Pdp11Cpu *const self, Pdp11CpuState const state) {
+    pthread_mutex_lock(&self->__state_lock);
+    {
+        self->_state = state;
+        pthread_cond_broadcast(&self->__state_changed);
+    }
+    pthread_mutex_unlock(&self->__state_lock);
+    pdp11_cpu_raise_attention(self, PDP11_CPU_ATTENTION_STATE);
+}
+// Leaves WAIT for RUN, unless the state has changed in between.
+static void pdp11_cpu_wake_from_wait(Pdp11Cpu *const self) {
+    pthread_mutex_lock(&self->__state_lock);
+    {
+        Pdp11CpuState expected = PDP11_CPU_STATE_WAIT;
+        if (atomic_compare_exchange_strong(
+                &self->_state,
+                &expected,
+                PDP11_CPU_STATE_RUN
+            ))
+            pthread_cond_broadcast(&self->__state_changed);
+    }
+    pthread_mutex_unlock(&self->__state_lock);
+}
+
+/* Bus accesses of the CPU. Words of the mapped RAM are accessed directly, as
+ * the CPU thread owns the bus for the whole batch, and every other master
+ * waits for the batch to end (see `unibus_cpu_acquire`).
+ *
+ * The instructions access memory through `pdp11_cpu_load`/`store`, which
+ * never fail: a bus error unwinds straight to the engine, which takes the trap
+ * at the instruction boundary (see `pdp11_cpu_catch_bus_error`). Only the trap
+ * entry and the fetch, which have to handle a double error themselves, check
+ * each access. */
+static forceinline bool
+pdp11_cpu_is_ram_word(Pdp11Cpu const *const self, uint16_t const addr) {
+    return addr < self->_ram_size && (addr & 1) == 0;
+}
+static forceinline Result
+pdp11_cpu_dati(Pdp11Cpu *const self, uint16_t const addr, uint16_t *const out) {
+    if (pdp11_cpu_is_ram_word(self, addr))
+        return *out = self->_ram[addr >> 1], Ok;
+    return unibus_cpu_dati(self->_unibus, addr, out);
+}
+static forceinline Result
+pdp11_cpu_dato(Pdp11Cpu *const self, uint16_t const addr, uint16_t const data) {
+    if (pdp11_cpu_is_ram_word(self, addr))
+        return self->_ram[addr >> 1] = data, pdp11_cpu_note_write(self, addr),
+               Ok;
+    return unibus_cpu_dato(self->_unibus, addr, data);
+}
+
+static noreturn void pdp11_cpu_bus_error(Pdp11Cpu *const self) {
+    longjmp(self->__bus_error, 1);
+}
+static forceinline uint16_t
+pdp11_cpu_load(Pdp11Cpu *const self, uint16_t const addr) {
+    uint16_t data;
+    if (pdp11_cpu_dati(self, addr, &data) != Ok) pdp11_cpu_bus_error(self);
+    return data;
+}
+static forceinline void pdp11_cpu_store(
+    Pdp11Cpu *const self,
+    uint16_t const addr,
+    uint16_t const data
+) {
+    if (pdp11_cpu_dato(self, addr, data) != Ok) pdp11_cpu_bus_error(self);
+}
+
+static void pdp11_stack_push(Pdp11Cpu *const self, uint16_t const value) {
     pdp11_cpu_sp(self) -= 2;
-    UNROLL(unibus_cpu_dato(self->_unibus, pdp11_cpu_sp(self), value));
-    return Ok;
+    pdp11_cpu_store(self, pdp11_cpu_sp(self), value);
 }
-static Result pdp11_stack_pop(Pdp11Cpu *const self, uint16_t *const out) {
-    UNROLL(unibus_cpu_dati(self->_unibus, pdp11_cpu_sp(self), out));
+static uint16_t pdp11_stack_pop(Pdp11Cpu *const self) {
+    uint16_t const value = pdp11_cpu_load(self, pdp11_cpu_sp(self));
     pdp11_cpu_sp(self) += 2;
-    return Ok;
+    return value;
 }
-static void pdp11_cpu_trap(Pdp11Cpu *const self, uint8_t const trap) {
-    fprintf(stderr, "==TRAP== (%03o) \n", trap);
-    fflush(stderr);
+#if PDP11_CPU_TRACE
+// PSW as it is, without syncing the lazy flags
+static uint16_t pdp11_cpu_trace_psw(Pdp11Cpu const *const self) {
+    Pdp11PswFlags const flags = pdp11_cpu_flags(self);
+    return (pdp11_psw_to_word(&self->_psw) & ~0xF) | flags.n << 3 |
+           flags.z << 2 | flags.v << 1 | flags.c << 0;
+}
+#endif
+static void pdp11_cpu_trace_event(
+    Pdp11Cpu *const self,
+    Pdp11CpuTraceKind const kind,
+    uint8_t const vec
+) {
+#if PDP11_CPU_TRACE
+    if (!pdp11_cpu_trace_is_on(&self->_trace)) return;
+    pdp11_cpu_trace_record(
+        &self->_trace,
+        (Pdp11CpuTraceEntry){
+            .kind = kind,
+            .pc = pdp11_cpu_pc(self),
+            .val = vec,
+            .psw = pdp11_cpu_trace_psw(self),
+        }
+    );
+    if (self->_trace.options & PDP11_CPU_TRACE_DUMP_ON_TRAP)
+        pdp11_cpu_trace_dump(&self->_trace, stderr, false);
+#else
+    (void)self, (void)kind, (void)vec;
+#endif
+}
+static void pdp11_cpu_trace_halt(Pdp11Cpu *const self) {
+#if PDP11_CPU_TRACE
+    if (pdp11_cpu_trace_is_on(&self->_trace) &&
+        self->_trace.options & PDP11_CPU_TRACE_DUMP_ON_HALT)
+        pdp11_cpu_trace_dump(&self->_trace, stderr, false);
+#else
+    (void)self;
+#endif
+}
+
+static void pdp11_cpu_enter_trap(Pdp11Cpu *const self, uint8_t const trap) {
+    pdp11_cpu_sync_flags(self);
     uint16_t psw_word;
-    if (pdp11_stack_push(self, pdp11_psw_to_word(&self->_psw)) != Ok ||
-        pdp11_stack_push(self, pdp11_cpu_pc(self)) != Ok ||
-        unibus_cpu_dati(self->_unibus, trap, &pdp11_cpu_pc(self)) != Ok ||
-        unibus_cpu_dati(self->_unibus, trap + 2, &psw_word) != Ok)
+    // NOTE an error in here halts the CPU, instead of trapping again
+    if (pdp11_cpu_dato(
+            self,
+            pdp11_cpu_sp(self) -= 2,
+            pdp11_psw_to_word(&self->_psw)
+        ) != Ok ||
+        pdp11_cpu_dato(self, pdp11_cpu_sp(self) -= 2, pdp11_cpu_pc(self)) !=
+            Ok ||
+        pdp11_cpu_dati(self, trap, &pdp11_cpu_pc(self)) != Ok ||
+        pdp11_cpu_dati(self, trap + 2, &psw_word) != Ok)
         return pdp11_cpu_halt(self);
 
     pdp11_psw_set(&self->_psw, psw_word);
+    pdp11_cpu_raise_attention(self, PDP11_CPU_ATTENTION_PSW);
+}
+static void pdp11_cpu_trap(Pdp11Cpu *const self, uint8_t const trap) {
+    pdp11_cpu_trace_event(self, PDP11_CPU_TRACE_KIND_TRAP, trap);
+    pdp11_cpu_enter_trap(self, trap);
 }
 
+// Takes the highest interrupt request above the current priority, if any.
 static void pdp11_cpu_service_intr(Pdp11Cpu *const self) {
-    uint8_t const pending_intr =
-        atomic_exchange(&self->__pending_intr, PDP11_CPU_NO_TRAP);
-    if (pending_intr == PDP11_CPU_NO_TRAP) return;
+    uint8_t intr;
+    if (!unibus_br_take(self->_unibus, pdp11_psw_priority(&self->_psw), &intr))
+        return;
 
-    fprintf(stderr, "  (from intr)  ");
-    pdp11_cpu_trap(self, pending_intr);
+    pdp11_cpu_trace_event(self, PDP11_CPU_TRACE_KIND_INTR, intr);
+    self->__intrs++;
+    pdp11_cpu_enter_trap(self, intr);
+    pdp11_scheduler_advance(&self->_scheduler, PDP11_CPU_INTR_NS);
+}
 
-    sem_post(&self->__pending_intr_sem);
+void pdp11_cpu_take_bus_error(Pdp11Cpu *const self) {
+    pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
 }
 
-static uint16_t pdp11_cpu_fetch(Pdp11Cpu *const self) {
+uint16_t pdp11_cpu_fetch_any(Pdp11Cpu *const self) {
     uint16_t instr;
-    if (unibus_cpu_dati(self->_unibus, pdp11_cpu_pc(self), &instr) != Ok) {
+    if (pdp11_cpu_dati(self, pdp11_cpu_pc(self), &instr) != Ok) {
         pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_pc(self), &instr) != Ok)
+        if (pdp11_cpu_dati(self, pdp11_cpu_pc(self), &instr) != Ok)
             pdp11_cpu_halt(self);
     }
     pdp11_cpu_pc(self) += 2;
+    self->__instrs++;
+
+    pdp11_cpu_trace_fetch(self, pdp11_cpu_pc(self) - 2, instr);
+
     return instr;
 }
+void pdp11_cpu_trace_fetch(
+    Pdp11Cpu *const self,
+    uint16_t const pc,
+    uint16_t const encoded
+) {
+#if PDP11_CPU_TRACE
+    if (!pdp11_cpu_trace_is_on(&self->_trace)) return;
+    pdp11_cpu_trace_record(
+        &self->_trace,
+        (Pdp11CpuTraceEntry){
+            .kind = PDP11_CPU_TRACE_KIND_INSTR,
+            .pc = pc,
+            .val = encoded,
+            .psw = pdp11_cpu_trace_psw(self),
+        }
+    );
+#else
+    (void)self, (void)pc, (void)encoded;
+#endif
+}
 
-static Pdp11Word
-pdp11_cpu_address_word(Pdp11Cpu *const self, unsigned const mode) {
+/* Computes the bus address of a non-register operand, applying the addressing
+ * mode side effects. */
+static uint16_t pdp11_cpu_effective_addr(
+    Pdp11Cpu *const self,
+    unsigned const mode,
+    bool const is_byte
+) {
     unsigned const r_i = BITS(mode, 0, 2);
+    // NOTE byte autoincrement and autodecrement still step SP and PC by words
+    uint16_t const step = is_byte && r_i < 06 ? 1 : 2;
 
+    uint16_t addr;
     switch (BITS(mode, 3, 5)) {
-    case 00: return pdp11_word_from_cpu_reg(self, r_i);
-    case 01:
-        return pdp11_word_from_unibus(self->_unibus, pdp11_cpu_rx(self, r_i));
+    case 01: addr = pdp11_cpu_rx(self, r_i); break;
     case 02: {
-        Pdp11Word const word =
-            pdp11_word_from_unibus(self->_unibus, pdp11_cpu_rx(self, r_i));
-        pdp11_cpu_rx(self, r_i) += 2;
-        return word;
+        addr = pdp11_cpu_rx(self, r_i);
+        pdp11_cpu_rx(self, r_i) += step;
     } break;
     case 03: {
-        uint16_t addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_rx(self, r_i), &addr) ==
-            Ok) {
-            pdp11_cpu_rx(self, r_i) += 2;
-            return pdp11_word_from_unibus(self->_unibus, addr);
-        }
-    } break;
-    case 04: {
-        pdp11_cpu_rx(self, r_i) -= 2;
-        return pdp11_word_from_unibus(self->_unibus, pdp11_cpu_rx(self, r_i));
+        addr = pdp11_cpu_load(self, pdp11_cpu_rx(self, r_i));
+        pdp11_cpu_rx(self, r_i) += 2;
     } break;
+    case 04: addr = pdp11_cpu_rx(self, r_i) -= step; break;
     case 05: {
         pdp11_cpu_rx(self, r_i) -= 2;
-        uint16_t addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_rx(self, r_i), &addr) ==
-            Ok)
-            return pdp11_word_from_unibus(self->_unibus, addr);
+        addr = pdp11_cpu_load(self, pdp11_cpu_rx(self, r_i));
     } break;
     case 06: {
-        uint16_t off;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_pc(self), &off) == Ok) {
-            pdp11_cpu_pc(self) += 2;
-            return pdp11_word_from_unibus(
-                self->_unibus,
-                off + pdp11_cpu_rx(self, r_i)
-            );
-        }
+        uint16_t const off = pdp11_cpu_load(self, pdp11_cpu_pc(self));
+        pdp11_cpu_pc(self) += 2;
+        addr = off + pdp11_cpu_rx(self, r_i);
     } break;
     case 07: {
-        uint16_t off, addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_pc(self), &off) == Ok) {
-            pdp11_cpu_pc(self) += 2;
-            if (unibus_cpu_dati(
-                    self->_unibus,
-                    off + pdp11_cpu_rx(self, r_i),
-                    &addr
-                ) == Ok)
-                return pdp11_word_from_unibus(self->_unibus, addr);
-        }
+        uint16_t const off = pdp11_cpu_load(self, pdp11_cpu_pc(self));
+        pdp11_cpu_pc(self) += 2;
+        addr = pdp11_cpu_load(self, off + pdp11_cpu_rx(self, r_i));
     } break;
     default: assert(false);
     }
+#if PDP11_CPU_TRACE
+    if (pdp11_cpu_trace_is_on(&self->_trace))
+        pdp11_cpu_trace_record_addr(&self->_trace, addr);
+#endif
+    return addr;
+}
 
-    return (Pdp11Word){.vtbl = NULL};
+/* Operand accessors, specialized per operand size and per mode class:
+ * `reg` for mode 0, where the location is a register index, and `mem` for
+ * the rest, where it is a bus location resolved once per operand, so that a
+ * read-modify-write costs exactly one read and one write. */
+
+// Resolves the RAM right away, and the rest through the bus.
+static forceinline UnibusLoc pdp11_cpu_resolve(
+    Pdp11Cpu *const self,
+    uint16_t const addr,
+    bool const is_byte
+) {
+    if (addr < self->_ram_size && (is_byte || (addr & 1) == 0))
+        return (UnibusLoc){
+            .addr = addr,
+            .ptr = self->_ram + (addr >> 1),
+            .device = NULL,
+        };
+    UnibusLoc loc;
+    if (unibus_cpu_resolve(self->_unibus, addr, is_byte, &loc) != Ok)
+        pdp11_cpu_bus_error(self);
+    return loc;
+}
+
+static forceinline uint16_t
+pdp11_cpu_resolve_word_reg(Pdp11Cpu *const, unsigned const mode) {
+    return BITS(mode, 0, 2);
+}
+static forceinline uint16_t
+pdp11_cpu_read_word_reg(Pdp11Cpu *const self, uint16_t const loc) {
+    return pdp11_cpu_rx(self, loc);
+}
+static forceinline void pdp11_cpu_write_word_reg(
+    Pdp11Cpu *const self,
+    uint16_t const loc,
+    uint16_t const value
+) {
+    pdp11_cpu_rx(self, loc) = value;
 }
-static Pdp11Byte
-pdp11_cpu_address_byte(Pdp11Cpu *const self, unsigned const mode) {
-    unsigned const r_i = BITS(mode, 0, 2);
 
-    switch (BITS(mode, 3, 5)) {
-    case 00: return pdp11_byte_from_cpu_reg(self, r_i);
-    case 01:
-        return pdp11_byte_from_unibus(self->_unibus, pdp11_cpu_rx(self, r_i));
-    case 02: {
-        Pdp11Byte const byte =
-            pdp11_byte_from_unibus(self->_unibus, pdp11_cpu_rx(self, r_i));
-        pdp11_cpu_rx(self, r_i) += r_i >= 06 ? 2 : 1;
-        return byte;
-    } break;
-    case 03: {
-        uint16_t addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_rx(self, r_i), &addr) ==
-            Ok) {
-            pdp11_cpu_rx(self, r_i) += 2;
-            return pdp11_byte_from_unibus(self->_unibus, addr);
-        }
-    } break;
-    case 04: {
-        pdp11_cpu_rx(self, r_i) -= r_i >= 06 ? 2 : 1;
-        return pdp11_byte_from_unibus(self->_unibus, pdp11_cpu_rx(self, r_i));
-    } break;
-    case 05: {
-        pdp11_cpu_rx(self, r_i) -= 2;
-        uint16_t addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_rx(self, r_i), &addr) ==
-            Ok)
-            return pdp11_byte_from_unibus(self->_unibus, addr);
-    } break;
-    case 06: {
-        uint16_t off;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_pc(self), &off) == Ok) {
-            pdp11_cpu_pc(self) += 2;
-            return pdp11_byte_from_unibus(
-                self->_unibus,
-                off + pdp11_cpu_rx(self, r_i)
-            );
-        }
-    } break;
-    case 07: {
-        uint16_t off, addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_pc(self), &off) == Ok) {
-            pdp11_cpu_pc(self) += 2;
-            if (unibus_cpu_dati(
-                    self->_unibus,
-                    off + pdp11_cpu_rx(self, r_i),
-                    &addr
-                ) == Ok)
-                return pdp11_byte_from_unibus(self->_unibus, addr);
-        }
-    } break;
-    default: assert(false);
-    }
+static forceinline UnibusLoc
+pdp11_cpu_resolve_word_mem(Pdp11Cpu *const self, unsigned const mode) {
+    return pdp11_cpu_resolve(
+        self,
+        pdp11_cpu_effective_addr(self, mode, false),
+        false
+    );
+}
+static forceinline uint16_t
+pdp11_cpu_read_word_mem(Pdp11Cpu *const self, UnibusLoc const loc) {
+    if (loc.ptr) return *(uint16_t volatile *)loc.ptr;
+    return unibus_cpu_loc_dati(self->_unibus, &loc);
+}
+static forceinline void pdp11_cpu_write_word_mem(
+    Pdp11Cpu *const self,
+    UnibusLoc const loc,
+    uint16_t const value
+) {
+    if (loc.ptr)
+        return *(uint16_t volatile *)loc.ptr = value,
+               pdp11_cpu_note_write(self, loc.addr);
+    unibus_cpu_loc_dato(self->_unibus, &loc, value);
+}
 
-    return (Pdp11Byte){.vtbl = NULL};
+static forceinline uint16_t
+pdp11_cpu_resolve_byte_reg(Pdp11Cpu *const, unsigned const mode) {
+    return BITS(mode, 0, 2);
 }
-static inline uint16_t
+static forceinline uint8_t
+pdp11_cpu_read_byte_reg(Pdp11Cpu *const self, uint16_t const loc) {
+    return pdp11_cpu_rl(self, loc);
+}
+static forceinline void pdp11_cpu_write_byte_reg(
+    Pdp11Cpu *const self,
+    uint16_t const loc,
+    uint8_t const value
+) {
+    pdp11_cpu_rl(self, loc) = value;
+}
+
+static forceinline UnibusLoc
+pdp11_cpu_resolve_byte_mem(Pdp11Cpu *const self, unsigned const mode) {
+    return pdp11_cpu_resolve(
+        self,
+        pdp11_cpu_effective_addr(self, mode, true),
+        true
+    );
+}
+static forceinline uint8_t
+pdp11_cpu_read_byte_mem(Pdp11Cpu *const self, UnibusLoc const loc) {
+    if (loc.ptr) return ((uint8_t volatile *)loc.ptr)[loc.addr & 1];
+    uint16_t const data = unibus_cpu_loc_dati(self->_unibus, &loc);
+    return loc.addr & 1 ? (uint8_t)(data >> 8) : (uint8_t)data;
+}
+static forceinline void pdp11_cpu_write_byte_mem(
+    Pdp11Cpu *const self,
+    UnibusLoc const loc,
+    uint8_t const value
+) {
+    if (loc.ptr)
+        return ((uint8_t volatile *)loc.ptr)[loc.addr & 1] = value,
+               pdp11_cpu_note_write(self, loc.addr);
+    unibus_cpu_loc_datob(self->_unibus, &loc, value);
+}
+
+// NOTE `movb` to a register sign-extends into the whole register
+#define pdp11_cpu_write_mov_word_reg pdp11_cpu_write_word_reg
+#define pdp11_cpu_write_mov_word_mem pdp11_cpu_write_word_mem
+static forceinline void pdp11_cpu_write_mov_byte_reg(
+    Pdp11Cpu *const self,
+    uint16_t const loc,
+    uint8_t const value
+) {
+    pdp11_cpu_rx(self, loc) = (int16_t)(int8_t)value;
+}
+#define pdp11_cpu_write_mov_byte_mem pdp11_cpu_write_byte_mem
+
+// NOTE not `inline`, the handlers `jsr_jmp` is forced into share one copy
+static uint16_t
 pdp11_cpu_jmp_jsr_effective_addr(Pdp11Cpu *const self, unsigned const mode) {
     unsigned const r_i = BITS(mode, 0, 2);
 
     switch (BITS(mode, 3, 5)) {
-    case 00: break;
+    // NOTE there is no address of a register to jump to
+    case 00: pdp11_cpu_bus_error(self);
     case 01: return pdp11_cpu_rx(self, r_i);
     case 02: return pdp11_cpu_rx(self, r_i) += 2;
     case 03: {
-        uint16_t addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_rx(self, r_i), &addr) ==
-            Ok) {
-            pdp11_cpu_rx(self, r_i) += 2;
-            return addr;
-        }
-    } break;
+        uint16_t const addr = pdp11_cpu_load(self, pdp11_cpu_rx(self, r_i));
+        pdp11_cpu_rx(self, r_i) += 2;
+        return addr;
+    }
     case 04: return pdp11_cpu_rx(self, r_i) -= 2;
     case 05: {
         pdp11_cpu_rx(self, r_i) -= 2;
-        uint16_t addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_rx(self, r_i), &addr) ==
-            Ok)
-            return addr;
-    } break;
+        return pdp11_cpu_load(self, pdp11_cpu_rx(self, r_i));
+    }
     case 06: {
-        uint16_t off;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_pc(self), &off) == Ok) {
-            pdp11_cpu_pc(self) += 2;
-            return off + pdp11_cpu_rx(self, r_i);
-        }
-    } break;
+        uint16_t const off = pdp11_cpu_load(self, pdp11_cpu_pc(self));
+        pdp11_cpu_pc(self) += 2;
+        return off + pdp11_cpu_rx(self, r_i);
+    }
     case 07: {
-        uint16_t off, addr;
-        if (unibus_cpu_dati(self->_unibus, pdp11_cpu_pc(self), &off) == Ok) {
-            pdp11_cpu_pc(self) += 2;
-            if (unibus_cpu_dati(
-                    self->_unibus,
-                    off + pdp11_cpu_rx(self, r_i),
-                    &addr
-                ) == Ok)
-                return addr;
-        }
-    } break;
-    default: assert(false);
+        uint16_t const off = pdp11_cpu_load(self, pdp11_cpu_pc(self));
+        pdp11_cpu_pc(self) += 2;
+        return pdp11_cpu_load(self, off + pdp11_cpu_rx(self, r_i));
     }
+    default: assert(false); return 0;
+    }
+}
 
-    return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR), 0;
-}
-static void pdp11_cpu_exec_oo(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
-    if (instr.u.oo.opcode & 010 && instr.u.oo.opcode != 016) {
-        Pdp11Byte const o0 = pdp11_cpu_address_byte(self, instr.u.oo.o0);
-        if (!o0.vtbl) return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        Pdp11Byte const o1 = pdp11_cpu_address_byte(self, instr.u.oo.o1);
-        if (!o1.vtbl) return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        switch (instr.u.oo.opcode) {
-        case 011: return pdp11_cpu_instr_movb(self, o0, o1);
-        case 012: return pdp11_cpu_instr_cmpb(self, o0, o1);
-        case 013: return pdp11_cpu_instr_bitb(self, o0, o1);
-        case 014: return pdp11_cpu_instr_bicb(self, o0, o1);
-        case 015: return pdp11_cpu_instr_bisb(self, o0, o1);
-        }
-    } else {
-        Pdp11Word const o0 = pdp11_cpu_address_word(self, instr.u.oo.o0);
-        if (!o0.vtbl) return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        Pdp11Word const o1 = pdp11_cpu_address_word(self, instr.u.oo.o1);
-        if (!o1.vtbl) return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        switch (instr.u.oo.opcode) {
-        case 001: return pdp11_cpu_instr_mov(self, o0, o1);
-        case 002: return pdp11_cpu_instr_cmp(self, o0, o1);
-        case 003: return pdp11_cpu_instr_bit(self, o0, o1);
-        case 004: return pdp11_cpu_instr_bic(self, o0, o1);
-        case 005: return pdp11_cpu_instr_bis(self, o0, o1);
-        case 006: return pdp11_cpu_instr_add(self, o0, o1);
-        case 016: return pdp11_cpu_instr_sub(self, o0, o1);
-        }
+// handlers
+
+#define PDP11_CPU_T_word uint16_t
+#define PDP11_CPU_T_byte uint8_t
+
+#define PDP11_CPU_LOC_reg uint16_t
+#define PDP11_CPU_LOC_mem UnibusLoc
+
+#define PDP11_CPU_IS_REG_MODE(MODE_) (BITS((unsigned)(MODE_), 3, 5) == 0)
+
+// single-operand
+
+#define PDP11_CPU_EXEC_O_RESOLVE(SIZE_, CLASS_)                                \
+    PDP11_CPU_LOC_##CLASS_ const loc =                                         \
+        pdp11_cpu_resolve_##SIZE_##_##CLASS_(self, instr.u.o.o);
+#define PDP11_CPU_EXEC_O_RMW(name_, SIZE_, CLASS_)                             \
+    PDP11_CPU_EXEC_O_RESOLVE(SIZE_, CLASS_)                                    \
+    pdp11_cpu_write_##SIZE_##_##CLASS_(                                        \
+        self,                                                                  \
+        loc,                                                                   \
+        pdp11_cpu_instr_##name_(                                               \
+            self,                                                              \
+            pdp11_cpu_read_##SIZE_##_##CLASS_(self, loc)                       \
+        )                                                                      \
+    );
+#define PDP11_CPU_EXEC_O_W(name_, SIZE_, CLASS_)                               \
+    PDP11_CPU_EXEC_O_RESOLVE(SIZE_, CLASS_)                                    \
+    pdp11_cpu_write_##SIZE_##_##CLASS_(                                        \
+        self,                                                                  \
+        loc,                                                                   \
+        pdp11_cpu_instr_##name_(self)                                          \
+    );
+#define PDP11_CPU_EXEC_O_R(name_, SIZE_, CLASS_)                               \
+    PDP11_CPU_EXEC_O_RESOLVE(SIZE_, CLASS_)                                    \
+    pdp11_cpu_instr_##name_(self, pdp11_cpu_read_##SIZE_##_##CLASS_(self, loc));
+
+#define PDP11_CPU_EXEC_O(NAME_, name_, SIZE_, KIND_)                           \
+    void pdp11_cpu_exec_##name_##_reg(                                         \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        PDP11_CPU_EXEC_O_##KIND_(name_, SIZE_, reg)                            \
+    }                                                                          \
+    void pdp11_cpu_exec_##name_##_mem(                                         \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        PDP11_CPU_EXEC_O_##KIND_(name_, SIZE_, mem)                            \
+    }                                                                          \
+    void pdp11_cpu_exec_##name_(                                               \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        return PDP11_CPU_IS_REG_MODE(instr.u.o.o)                              \
+                 ? pdp11_cpu_exec_##name_##_reg(self, instr)                   \
+                 : pdp11_cpu_exec_##name_##_mem(self, instr);                  \
     }
+PDP11_CPU_O_OPS(PDP11_CPU_EXEC_O)
+
+#undef PDP11_CPU_EXEC_O
+#undef PDP11_CPU_EXEC_O_R
+#undef PDP11_CPU_EXEC_O_W
+#undef PDP11_CPU_EXEC_O_RMW
+#undef PDP11_CPU_EXEC_O_RESOLVE
+
+// dual-operand
+
+#define PDP11_CPU_EXEC_OO_RESOLVE(SIZE_, SRC_CLASS_, DST_CLASS_)               \
+    PDP11_CPU_LOC_##SRC_CLASS_ const src_loc =                                 \
+        pdp11_cpu_resolve_##SIZE_##_##SRC_CLASS_(self, instr.u.oo.o0);         \
+    PDP11_CPU_LOC_##DST_CLASS_ const dst_loc =                                 \
+        pdp11_cpu_resolve_##SIZE_##_##DST_CLASS_(self, instr.u.oo.o1);         \
+    PDP11_CPU_T_##SIZE_ const src_val =                                        \
+        pdp11_cpu_read_##SIZE_##_##SRC_CLASS_(self, src_loc);
+#define PDP11_CPU_EXEC_OO_MOV(name_, SIZE_, SRC_CLASS_, DST_CLASS_)            \
+    PDP11_CPU_EXEC_OO_RESOLVE(SIZE_, SRC_CLASS_, DST_CLASS_)                   \
+    pdp11_cpu_write_mov_##SIZE_##_##DST_CLASS_(                                \
+        self,                                                                  \
+        dst_loc,                                                               \
+        pdp11_cpu_instr_##name_(self, src_val)                                 \
+    );
+#define PDP11_CPU_EXEC_OO_RMW(name_, SIZE_, SRC_CLASS_, DST_CLASS_)            \
+    PDP11_CPU_EXEC_OO_RESOLVE(SIZE_, SRC_CLASS_, DST_CLASS_)                   \
+    pdp11_cpu_write_##SIZE_##_##DST_CLASS_(                                    \
+        self,                                                                  \
+        dst_loc,                                                               \
+        pdp11_cpu_instr_##name_(                                               \
+            self,                                                              \
+            src_val,                                                           \
+            pdp11_cpu_read_##SIZE_##_##DST_CLASS_(self, dst_loc)               \
+        )                                                                      \
+    );
+#define PDP11_CPU_EXEC_OO_R(name_, SIZE_, SRC_CLASS_, DST_CLASS_)              \
+    PDP11_CPU_EXEC_OO_RESOLVE(SIZE_, SRC_CLASS_, DST_CLASS_)                   \
+    pdp11_cpu_instr_##name_(                                                   \
+        self,                                                                  \
+        src_val,                                                               \
+        pdp11_cpu_read_##SIZE_##_##DST_CLASS_(self, dst_loc)                   \
+    );
+
+#define PDP11_CPU_EXEC_OO_AS(name_, SIZE_, KIND_, SRC_CLASS_, DST_CLASS_)      \
+    void pdp11_cpu_exec_##name_##_##SRC_CLASS_##_##DST_CLASS_(                 \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        PDP11_CPU_EXEC_OO_##KIND_(name_, SIZE_, SRC_CLASS_, DST_CLASS_)        \
+    }
+#define PDP11_CPU_EXEC_OO(NAME_, name_, SIZE_, KIND_)                          \
+    PDP11_CPU_EXEC_OO_AS(name_, SIZE_, KIND_, reg, reg)                        \
+    PDP11_CPU_EXEC_OO_AS(name_, SIZE_, KIND_, reg, mem)                        \
+    PDP11_CPU_EXEC_OO_AS(name_, SIZE_, KIND_, mem, reg)                        \
+    PDP11_CPU_EXEC_OO_AS(name_, SIZE_, KIND_, mem, mem)                        \
+    void pdp11_cpu_exec_##name_(                                               \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        if (PDP11_CPU_IS_REG_MODE(instr.u.oo.o0))                              \
+            return PDP11_CPU_IS_REG_MODE(instr.u.oo.o1)                        \
+                     ? pdp11_cpu_exec_##name_##_reg_reg(self, instr)           \
+                     : pdp11_cpu_exec_##name_##_reg_mem(self, instr);          \
+        else                                                                   \
+            return PDP11_CPU_IS_REG_MODE(instr.u.oo.o1)                        \
+                     ? pdp11_cpu_exec_##name_##_mem_reg(self, instr)           \
+                     : pdp11_cpu_exec_##name_##_mem_mem(self, instr);          \
+    }
+PDP11_CPU_OO_OPS(PDP11_CPU_EXEC_OO)
+
+#undef PDP11_CPU_EXEC_OO
+#undef PDP11_CPU_EXEC_OO_AS
+#undef PDP11_CPU_EXEC_OO_R
+#undef PDP11_CPU_EXEC_OO_RMW
+#undef PDP11_CPU_EXEC_OO_MOV
+#undef PDP11_CPU_EXEC_OO_RESOLVE
+
+// register and operand
+
+#define PDP11_CPU_EXEC_RO_RESOLVE(SIZE_, CLASS_)                               \
+    PDP11_CPU_LOC_##CLASS_ const loc =                                         \
+        pdp11_cpu_resolve_##SIZE_##_##CLASS_(self, instr.u.ro.o);
+#define PDP11_CPU_EXEC_RO_RMW(name_, SIZE_, CLASS_)                            \
+    PDP11_CPU_EXEC_RO_RESOLVE(SIZE_, CLASS_)                                   \
+    pdp11_cpu_write_##SIZE_##_##CLASS_(                                        \
+        self,                                                                  \
+        loc,                                                                   \
+        pdp11_cpu_instr_##name_(                                               \
+            self,                                                              \
+            instr.u.ro.r,                                                      \
+            pdp11_cpu_read_##SIZE_##_##CLASS_(self, loc)                       \
+        )                                                                      \
+    );
+#define PDP11_CPU_EXEC_RO_R(name_, SIZE_, CLASS_)                              \
+    PDP11_CPU_EXEC_RO_RESOLVE(SIZE_, CLASS_)                                   \
+    pdp11_cpu_instr_##name_(                                                   \
+        self,                                                                  \
+        instr.u.ro.r,                                                          \
+        pdp11_cpu_read_##SIZE_##_##CLASS_(self, loc)                           \
+    );
+
+#define PDP11_CPU_EXEC_RO(NAME_, name_, SIZE_, KIND_)                          \
+    void pdp11_cpu_exec_##name_##_reg(                                         \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        PDP11_CPU_EXEC_RO_##KIND_(name_, SIZE_, reg)                           \
+    }                                                                          \
+    void pdp11_cpu_exec_##name_##_mem(                                         \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        PDP11_CPU_EXEC_RO_##KIND_(name_, SIZE_, mem)                           \
+    }                                                                          \
+    void pdp11_cpu_exec_##name_(                                               \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        return PDP11_CPU_IS_REG_MODE(instr.u.ro.o)                             \
+                 ? pdp11_cpu_exec_##name_##_reg(self, instr)                   \
+                 : pdp11_cpu_exec_##name_##_mem(self, instr);                  \
+    }
+PDP11_CPU_RO_OPS(PDP11_CPU_EXEC_RO)
+
+#undef PDP11_CPU_EXEC_RO
+#undef PDP11_CPU_EXEC_RO_R
+#undef PDP11_CPU_EXEC_RO_RMW
+#undef PDP11_CPU_EXEC_RO_RESOLVE
+
+// the rest
+
+#define PDP11_CPU_EXEC_BRANCH(NAME_)                                           \
+    void pdp11_cpu_exec_##NAME_(                                               \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const instr                                              \
+    ) {                                                                        \
+        pdp11_cpu_instr_##NAME_(                                               \
+            self,                                                              \
+            instr.u.branch.cond,                                               \
+            instr.u.branch.off                                                 \
+        );                                                                     \
+    }
+#define PDP11_CPU_EXEC_MISC(NAME_)                                             \
+    void pdp11_cpu_exec_##NAME_(                                               \
+        Pdp11Cpu *const self,                                                  \
+        Pdp11CpuInstr const                                                    \
+    ) {                                                                        \
+        pdp11_cpu_instr_##NAME_(self);                                         \
+    }
+
+PDP11_CPU_EXEC_BRANCH(bne_be)
+PDP11_CPU_EXEC_BRANCH(bge_bl)
+PDP11_CPU_EXEC_BRANCH(bg_ble)
+PDP11_CPU_EXEC_BRANCH(bpl_bmi)
+PDP11_CPU_EXEC_BRANCH(bhi_blos)
+PDP11_CPU_EXEC_BRANCH(bvc_bvs)
+PDP11_CPU_EXEC_BRANCH(bcc_bcs)
+
+PDP11_CPU_EXEC_MISC(emt)
+PDP11_CPU_EXEC_MISC(trap)
+PDP11_CPU_EXEC_MISC(rti_rtt)
+PDP11_CPU_EXEC_MISC(bpt)
+PDP11_CPU_EXEC_MISC(iot)
+PDP11_CPU_EXEC_MISC(halt)
+PDP11_CPU_EXEC_MISC(wait)
+PDP11_CPU_EXEC_MISC(reset)
+
+#undef PDP11_CPU_EXEC_BRANCH
+#undef PDP11_CPU_EXEC_MISC
+
+void pdp11_cpu_exec_br(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
+    pdp11_cpu_instr_br(self, instr.u.branch.off);
 }
-static void pdp11_cpu_exec_ro(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
-    if (instr.u.ro.opcode == 0072) {
-        uint16_t const r = instr.u.ro.r;
-        Pdp11Byte const o = pdp11_cpu_address_byte(self, instr.u.ro.o);
-        if (!o.vtbl) return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        return pdp11_cpu_instr_ash(self, r, o);
-    } else {
-        uint16_t const r = instr.u.ro.r;
-        Pdp11Word const o = pdp11_cpu_address_word(self, instr.u.ro.o);
-        if (!o.vtbl) return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        switch (instr.u.ro.opcode) {
-        case 0070: return pdp11_cpu_instr_mul(self, r, o);
-        case 0071: return pdp11_cpu_instr_div(self, r, o);
-        case 0073: return pdp11_cpu_instr_ashc(self, r, o);
-        case 0074: return pdp11_cpu_instr_xor(self, r, o);
-        }
+void pdp11_cpu_exec_rts(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
+    pdp11_cpu_instr_rts(self, instr.u.r.r);
+}
+void pdp11_cpu_exec_spl(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
+    pdp11_cpu_instr_spl(self, instr.u.r.r);
+}
+void pdp11_cpu_exec_sob(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
+    pdp11_cpu_instr_sob(self, instr.u.sob.r, instr.u.sob.off);
+}
+void pdp11_cpu_exec_jsr(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
+    pdp11_cpu_instr_jsr_jmp(self, instr.u.jsr.r, instr.u.jsr.o);
+}
+void pdp11_cpu_exec_jmp(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
+    pdp11_cpu_instr_jsr_jmp(self, -1, instr.u.jmp.o);
+}
+void pdp11_cpu_exec_mark(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
+    pdp11_cpu_instr_mark(self, BITS(instr.u.misc.opcode, 0, 5));
+}
+void pdp11_cpu_exec_clnzvc_senzvc(
+    Pdp11Cpu *const self,
+    Pdp11CpuInstr const instr
+) {
+    uint16_t const opcode = instr.u.misc.opcode;
+    pdp11_cpu_instr_clnzvc_senzvc(
+        self,
+        BIT(opcode, 4),
+        BIT(opcode, 3),
+        BIT(opcode, 2),
+        BIT(opcode, 1),
+        BIT(opcode, 0)
+    );
+}
+void pdp11_cpu_exec_reserved(Pdp11Cpu *const self, Pdp11CpuInstr const) {
+    pdp11_cpu_trap(self, PDP11_CPU_TRAP_RESERVED_INSTR);
+}
+
+// dispatch
+
+Pdp11CpuExec *const pdp11_cpu_execs[PDP11_CPU_OP_COUNT] = {
+#define PDP11_CPU_EXEC_ENTRY(NAME_, name_)                                     \
+    [PDP11_CPU_OP_##NAME_] = pdp11_cpu_exec_##name_,
+    PDP11_CPU_OPS(PDP11_CPU_EXEC_ENTRY)
+#undef PDP11_CPU_EXEC_ENTRY
+};
+
+// handlers specialized by operand class, indexed by `!PDP11_CPU_IS_REG_MODE`
+static Pdp11CpuExec *const pdp11_cpu_execs_o[PDP11_CPU_OP_COUNT][2] = {
+#define PDP11_CPU_EXECS_ENTRY(NAME_, name_, ...)                               \
+    [PDP11_CPU_OP_##NAME_] = {                                                 \
+        pdp11_cpu_exec_##name_##_reg,                                          \
+        pdp11_cpu_exec_##name_##_mem,                                          \
+    },
+    PDP11_CPU_O_OPS(PDP11_CPU_EXECS_ENTRY)
+    PDP11_CPU_RO_OPS(PDP11_CPU_EXECS_ENTRY)
+#undef PDP11_CPU_EXECS_ENTRY
+};
+static Pdp11CpuExec *const pdp11_cpu_execs_oo[PDP11_CPU_OP_COUNT][2][2] = {
+#define PDP11_CPU_EXECS_ENTRY(NAME_, name_, ...)                               \
+    [PDP11_CPU_OP_##NAME_] = {                                                 \
+        {pdp11_cpu_exec_##name_##_reg_reg, pdp11_cpu_exec_##name_##_reg_mem}, \
+        {pdp11_cpu_exec_##name_##_mem_reg, pdp11_cpu_exec_##name_##_mem_mem}, \
+    },
+    PDP11_CPU_OO_OPS(PDP11_CPU_EXECS_ENTRY)
+#undef PDP11_CPU_EXECS_ENTRY
+};
+
+/* The classes of the operands of `instr`, `!PDP11_CPU_IS_REG_MODE` of each,
+ * the source first, as the specialized handlers are indexed by them. */
+static unsigned pdp11_cpu_classes(Pdp11CpuInstr const instr) {
+    switch (instr.type) {
+    case PDP11_CPU_INSTR_TYPE_OO:
+        return 2 * !PDP11_CPU_IS_REG_MODE(instr.u.oo.o0) +
+               !PDP11_CPU_IS_REG_MODE(instr.u.oo.o1);
+    case PDP11_CPU_INSTR_TYPE_O: return !PDP11_CPU_IS_REG_MODE(instr.u.o.o);
+    case PDP11_CPU_INSTR_TYPE_RO: return !PDP11_CPU_IS_REG_MODE(instr.u.ro.o);
+    default: return 0;
     }
 }
-static void
-pdp11_cpu_exec_branch(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
-    uint16_t const cond = instr.u.branch.cond;
-    uint16_t const off = instr.u.branch.off;
-    switch (instr.u.branch.opcode) {
-    case 0000: return assert(cond == 1), pdp11_cpu_instr_br(self, off);
-    case 0001: return pdp11_cpu_instr_bne_be(self, cond, off);
-    case 0002: return pdp11_cpu_instr_bge_bl(self, cond, off);
-    case 0003: return pdp11_cpu_instr_bg_ble(self, cond, off);
-    case 0100: return pdp11_cpu_instr_bpl_bmi(self, cond, off);
-    case 0101: return pdp11_cpu_instr_bhi_blos(self, cond, off);
-    case 0102: return pdp11_cpu_instr_bvc_bvs(self, cond, off);
-    case 0103: return pdp11_cpu_instr_bcc_bcs(self, cond, off);
+
+static Pdp11CpuExec *pdp11_cpu_exec_specialized(
+    Pdp11CpuOp const op,
+    Pdp11CpuInstr const instr
+) {
+    unsigned const classes = pdp11_cpu_classes(instr);
+    Pdp11CpuExec *exec = NULL;
+    switch (instr.type) {
+    case PDP11_CPU_INSTR_TYPE_OO:
+        exec = pdp11_cpu_execs_oo[op][classes / 2][classes % 2];
+        break;
+    case PDP11_CPU_INSTR_TYPE_O:
+    case PDP11_CPU_INSTR_TYPE_RO: exec = pdp11_cpu_execs_o[op][classes]; break;
+    default: break;
     }
+    return exec ? exec : pdp11_cpu_execs[op];
 }
-static void pdp11_cpu_exec_o(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
-    if (instr.u.o.opcode & 01000) {
-        Pdp11Byte const o = pdp11_cpu_address_byte(self, instr.u.o.o);
-        if (!o.vtbl) return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        switch (instr.u.o.opcode) {
-        case 01050: return pdp11_cpu_instr_clrb(self, o);
-        case 01051: return pdp11_cpu_instr_comb(self, o);
-        case 01052: return pdp11_cpu_instr_incb(self, o);
-        case 01053: return pdp11_cpu_instr_decb(self, o);
-        case 01055: return pdp11_cpu_instr_adcb(self, o);
-        case 01056: return pdp11_cpu_instr_sbcb(self, o);
-        case 01054: return pdp11_cpu_instr_negb(self, o);
-        case 01057: return pdp11_cpu_instr_tstb(self, o);
-        case 01060: return pdp11_cpu_instr_rorb(self, o);
-        case 01061: return pdp11_cpu_instr_rolb(self, o);
-        case 01062: return pdp11_cpu_instr_asrb(self, o);
-        case 01063: return pdp11_cpu_instr_aslb(self, o);
-        }
-    } else {
-        Pdp11Word const o = pdp11_cpu_address_word(self, instr.u.o.o);
-        if (!o.vtbl) return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        switch (instr.u.o.opcode) {
-        case 00003: return pdp11_cpu_instr_swab(self, o);
-        case 00050: return pdp11_cpu_instr_clr(self, o);
-        case 00051: return pdp11_cpu_instr_com(self, o);
-        case 00052: return pdp11_cpu_instr_inc(self, o);
-        case 00053: return pdp11_cpu_instr_dec(self, o);
-        case 00054: return pdp11_cpu_instr_neg(self, o);
-        case 00055: return pdp11_cpu_instr_adc(self, o);
-        case 00056: return pdp11_cpu_instr_sbc(self, o);
-        case 00057: return pdp11_cpu_instr_tst(self, o);
-        case 00060: return pdp11_cpu_instr_ror(self, o);
-        case 00061: return pdp11_cpu_instr_rol(self, o);
-        case 00062: return pdp11_cpu_instr_asr(self, o);
-        case 00063: return pdp11_cpu_instr_asl(self, o);
-        case 00067: return pdp11_cpu_instr_sxt(self, o);
-        }
+
+Pdp11CpuDecoded pdp11_cpu_decoded[UINT16_MAX + 1];
+static pthread_once_t pdp11_cpu_decoded_once = PTHREAD_ONCE_INIT;
+static void pdp11_cpu_decoded_build(void) {
+    for (uint32_t encoded = 0; encoded <= UINT16_MAX; encoded++) {
+        Pdp11CpuInstr const instr = pdp11_cpu_instr(encoded);
+        Pdp11CpuOp const op = pdp11_cpu_op(instr);
+        // NOTE instr fields are `const`, so a plain assignment is not allowed
+        memcpy(
+            pdp11_cpu_decoded + encoded,
+            &(Pdp11CpuDecoded){
+                .exec = pdp11_cpu_exec_specialized(op, instr),
+                .instr = instr,
+                .op = op,
+                .classes = pdp11_cpu_classes(instr),
+                .time = pdp11_cpu_instr_ns(op, instr),
+            },
+            sizeof(Pdp11CpuDecoded)
+        );
     }
 }
-static void pdp11_cpu_exec_r(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
-    uint16_t const opcode = instr.u.r.opcode;
-    uint16_t const r = instr.u.r.r;
-    switch (opcode) {
-    case 000020: return pdp11_cpu_instr_rts(self, r);
-    case 000023: return pdp11_cpu_instr_spl(self, r);
+
+// engines
+
+// Host time in nanoseconds, on the clock `__state_changed` waits on.
+static uint64_t pdp11_cpu_host_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 * 1000 * 1000 + now.tv_nsec;
+}
+
+/* Simulated time the host clock has got to at the pace of `speed`, counted
+ * from the last anchor. Takes a new anchor instead when the speed has changed
+ * or the CPU has fallen too far behind, e.g. after having been halted. */
+static uint64_t
+pdp11_cpu_paced_time(Pdp11Cpu *const self, unsigned const speed) {
+    uint64_t const host = pdp11_cpu_host_ns(), time = pdp11_cpu_time(self);
+    uint64_t const paced =
+        self->__pace_time + (host - self->__pace_host) * speed;
+    if (speed != self->__pace_speed ||
+        paced > time + PDP11_CPU_PACE_BEHIND_NS * speed) {
+        self->__pace_host = host, self->__pace_time = time;
+        self->__pace_speed = speed;
+        return time;
     }
+    return paced;
+}
+// Sleeps off however far the CPU has run ahead of the host clock, if paced.
+static void pdp11_cpu_pace(Pdp11Cpu *const self) {
+    unsigned const speed = self->_speed;
+    if (speed == 0) return;
+
+    uint64_t const paced = pdp11_cpu_paced_time(self, speed),
+                   time = pdp11_cpu_time(self);
+    // NOTE sleeps are only taken once worth it, most batches take none
+    if (time <= paced + PDP11_CPU_PACE_AHEAD_NS * speed) return;
+    uint64_t const ahead = (time - paced) / speed;
+    struct timespec const duration = {
+        .tv_sec = ahead / (1000 * 1000 * 1000),
+        .tv_nsec = ahead % (1000 * 1000 * 1000),
+    };
+    nanosleep(&duration, NULL);
 }
-static void
-pdp11_cpu_exec_misc(Pdp11Cpu *const self, Pdp11CpuInstr const instr) {
-    uint16_t const opcode = instr.u.misc.opcode;
-    switch (opcode) {
-    case 0104000 ... 0104377: return pdp11_cpu_instr_emt(self);
-    case 0104400 ... 0104777: return pdp11_cpu_instr_trap(self);
 
-    case 0000240 ... 0000277:
-        return pdp11_cpu_instr_clnzvc_senzvc(
-            self,
-            BIT(opcode, 4),
-            BIT(opcode, 3),
-            BIT(opcode, 2),
-            BIT(opcode, 1),
-            BIT(opcode, 0)
-        );
+int32_t pdp11_cpu_before_batch(Pdp11Cpu *const self) {
+    uint64_t const instrs_left = pdp11_cpu_instrs_left(self);
+    if (!self->__should_thread_run || instrs_left == 0 ||
+        (self->_state != PDP11_CPU_STATE_RUN &&
+         self->_state != PDP11_CPU_STATE_STEP))
+        return pdp11_cpu_sync_flags(self), 0;
 
-    case 0006400 ... 0006477:
-        return pdp11_cpu_instr_mark(self, BITS(opcode, 0, 5));
+    unibus_cpu_acquire(self->_unibus);
 
-    case 0000006:
-    case 0000002: return pdp11_cpu_instr_rti_rtt(self);
-    case 0000003: return pdp11_cpu_instr_bpt(self);
-    case 0000004: return pdp11_cpu_instr_iot(self);
+    // NOTE pacing counts from the first batch of a run, before anything has
+    // moved time on
+    unsigned const speed = self->_speed;
+    if (speed != 0 && speed != self->__pace_speed)
+        pdp11_cpu_paced_time(self, speed);
 
-    case 0000000: return pdp11_cpu_instr_halt(self);
-    case 0000001: return pdp11_cpu_instr_wait(self);
-    case 0000005: return pdp11_cpu_instr_reset(self);
+    // NOTE the interrupt that has ended WAIT is taken before anything else
+    if (self->__has_waited)
+        self->__has_waited = false, pdp11_cpu_service_intr(self);
+
+    if (self->__should_trace_trap) {
+        pdp11_cpu_trap(self, PDP11_CPU_TRAP_BPT);
+        pdp11_scheduler_advance(&self->_scheduler, PDP11_CPU_TRAP_NS);
+    }
+    self->__should_trace_trap = self->_psw.flags.t;
+
+    // NOTE the trace trap and single-stepping are due after every instruction,
+    // which any instruction overruns
+    int32_t ns =
+        self->__should_trace_trap || self->_state == PDP11_CPU_STATE_STEP
+            ? 1
+            : PDP11_CPU_BATCH_LEN * PDP11_CPU_MIN_INSTR_NS;
+    // NOTE and the next event right at the instruction it is due after
+    uint64_t const next = pdp11_scheduler_next(&self->_scheduler),
+                   now = pdp11_cpu_time(self);
+    if (next != PDP11_SCHEDULER_NEVER) {
+        uint64_t const due = next > now ? next - now : 1;
+        if (due < (uint64_t)ns) ns = due;
+    }
+    // NOTE and never more instructions than are left, even the quickest ones
+    if (instrs_left - 1 < (uint64_t)ns / PDP11_CPU_MIN_INSTR_NS)
+        ns = (instrs_left - 1) * PDP11_CPU_MIN_INSTR_NS + 1;
+    return self->__batch_ns = ns;
+}
+void pdp11_cpu_after_batch(Pdp11Cpu *const self, int32_t const left) {
+    // NOTE cleared before anything is checked, so that whatever gets raised
+    // from now on cuts the next batch short
+    atomic_store(&self->__attention, 0);
+
+    // NOTE before the interrupts, so that the ones requested by the events
+    // are taken at once
+    pdp11_scheduler_advance(&self->_scheduler, self->__batch_ns - left);
+
+    if (self->_state != PDP11_CPU_STATE_HALT &&
+        self->_state != PDP11_CPU_STATE_WAIT)
+        pdp11_cpu_service_intr(self);
+
+    if (self->_state == PDP11_CPU_STATE_STEP)
+        pdp11_cpu_set_state(self, PDP11_CPU_STATE_HALT);
+
+    // NOTE only a batch that has run out may be spinning in a loop
+    if (left <= 0 && self->_state == PDP11_CPU_STATE_RUN &&
+        !self->_psw.flags.t) {
+        pdp11_cpu_skip_idle_loop(self);
+        pdp11_cpu_skip_delay_loop(self);
+        pdp11_cpu_skip_copy_loop(self);
     }
-}
 
-static void pdp11_cpu_thread_helper(Pdp11Cpu *const self) {
-    bool should_trap = false;
-    while (self->__should_thread_run) {
-        while (self->__should_thread_run &&
-               (self->_state == PDP11_CPU_STATE_HALT ||
-                self->_state == PDP11_CPU_STATE_WAIT))
-            sleep(0);
-        if (!self->__should_thread_run) break;
-
-        if (should_trap) pdp11_cpu_trap(self, PDP11_CPU_TRAP_BPT);
-        should_trap = self->_psw.flags.t;
-
-        uint16_t const encoded = pdp11_cpu_fetch(self);
-        fprintf(
-            stderr,
-            "exec at %06o : %06o\n",
-            pdp11_cpu_pc(self) - 2,
-            encoded
-        ),
-            fflush(stderr);
-
-        // TODO temporary breakpoint for debugging
-        // if (pdp11_cpu_pc(self) - 2 == 0006070 ||
-        //     pdp11_cpu_pc(self) - 2 == 0006130)
-        //     self->_state = PDP11_CPU_STATE_HALT;
+    // NOTE the bus no longer syncs the flags once the CPU has let it go, so
+    // that the PSW the other masters see between batches is up to date
+    pdp11_cpu_sync_flags(self);
+    unibus_cpu_release(self->_unibus);
+    pdp11_cpu_pace(self);
+}
 
-        Pdp11CpuInstr const instr = pdp11_cpu_instr(encoded);
+void pdp11_cpu_loop_run(Pdp11Cpu *const self) {
+    // NOTE `volatile` to be kept across a bus error
+    for (int32_t volatile ns; (ns = pdp11_cpu_before_batch(self));) {
+        if (setjmp(self->__bus_error)) {
+            pdp11_cpu_take_bus_error(self);
+            pdp11_cpu_after_batch(self, ns - PDP11_CPU_TRAP_NS);
+            continue;
+        }
+        do {
+            uint16_t const encoded = pdp11_cpu_fetch(self);
+
+#if PDP11_CPU_REFERENCE_DECODE
+            Pdp11CpuInstr const instr = pdp11_cpu_instr(encoded);
+            Pdp11CpuOp const op = pdp11_cpu_op(instr);
+            pdp11_cpu_execs[op](self, instr);
+            ns -= pdp11_cpu_instr_ns(op, instr);
+#else
+            Pdp11CpuDecoded const *const decoded = pdp11_cpu_decoded + encoded;
+            decoded->exec(self, decoded->instr);
+            ns -= decoded->time;
+#endif
+        } while (ns > 0 && !pdp11_cpu_needs_attention(self));
+        pdp11_cpu_after_batch(self, ns);
+    }
+}
 
-        uint16_t const next_pc = pdp11_cpu_pc(self);
-        switch (instr.type) {
-        case PDP11_CPU_INSTR_TYPE_OO: pdp11_cpu_exec_oo(self, instr); break;
-        case PDP11_CPU_INSTR_TYPE_RO: pdp11_cpu_exec_ro(self, instr); break;
-        case PDP11_CPU_INSTR_TYPE_O: pdp11_cpu_exec_o(self, instr); break;
-        case PDP11_CPU_INSTR_TYPE_BRANCH:
-            pdp11_cpu_exec_branch(self, instr);
-            break;
-        case PDP11_CPU_INSTR_TYPE_R: pdp11_cpu_exec_r(self, instr); break;
-        case PDP11_CPU_INSTR_TYPE_SOB:
-            pdp11_cpu_instr_sob(self, instr.u.sob.r, instr.u.sob.off);
-            break;
-        case PDP11_CPU_INSTR_TYPE_JSR:
-            pdp11_cpu_instr_jsr_jmp(self, instr.u.jsr.r, instr.u.jsr.o);
-            break;
-        case PDP11_CPU_INSTR_TYPE_JMP:
-            pdp11_cpu_instr_jsr_jmp(self, -1, instr.u.jmp.o);
-            break;
-        case PDP11_CPU_INSTR_TYPE_MISC: pdp11_cpu_exec_misc(self, instr); break;
-        case PDP11_CPU_INSTR_TYPE_RESERVED:
-            pdp11_cpu_trap(self, PDP11_CPU_TRAP_RESERVED_INSTR);
-            break;
+/* Waits for the next event, and fires it. Unpaced, simulated time skips
+ * straight to it. Paced, the host clock has to get there first, unless the
+ * state changes or an earlier event is scheduled meanwhile. */
+static void pdp11_cpu_idle(Pdp11Cpu *const self) {
+    unsigned const speed = self->_speed;
+    if (speed != 0) {
+        uint64_t const next = pdp11_scheduler_next(&self->_scheduler),
+                       paced = pdp11_cpu_paced_time(self, speed);
+        if (next > paced) {
+            uint64_t const host =
+                self->__pace_host + (next - self->__pace_time) / speed;
+            struct timespec const deadline = {
+                .tv_sec = host / (1000 * 1000 * 1000),
+                .tv_nsec = host % (1000 * 1000 * 1000),
+            };
+            pthread_mutex_lock(&self->__state_lock);
+            if (self->__should_thread_run &&
+                self->_state == PDP11_CPU_STATE_WAIT &&
+                pdp11_scheduler_next(&self->_scheduler) == next)
+                pthread_cond_timedwait(
+                    &self->__state_changed,
+                    &self->__state_lock,
+                    &deadline
+                );
+            pthread_mutex_unlock(&self->__state_lock);
         }
+    }
 
-        if ((uint16_t)(pdp11_cpu_pc(self) - next_pc) > 4)
-            fprintf(stderr, "\n"), fflush(stderr);
+    unibus_cpu_acquire(self->_unibus);
+    if (speed == 0) {
+        pdp11_scheduler_skip(&self->_scheduler);
+    } else {
+        // NOTE time only catches up with the host, never past the next event
+        uint64_t const next = pdp11_scheduler_next(&self->_scheduler),
+                       paced = pdp11_cpu_paced_time(self, speed),
+                       now = pdp11_cpu_time(self),
+                       until = paced < next ? paced : next;
+        if (until > now)
+            pdp11_scheduler_advance(&self->_scheduler, until - now);
+    }
+    unibus_cpu_release(self->_unibus);
+}
 
-        if (self->_state != PDP11_CPU_STATE_HALT &&
-            self->_state != PDP11_CPU_STATE_WAIT)
-            pdp11_cpu_service_intr(self);
+/* Runs the CPU until it halts, waits with nothing to wake it, or has run into
+ * `__instrs_limit`. Everything on the CPU thread happens in here. */
+static Pdp11CpuStop pdp11_cpu_exec(Pdp11Cpu *const self) {
+    while (self->__should_thread_run) {
+        switch (self->_state) {
+        case PDP11_CPU_STATE_HALT: return PDP11_CPU_STOP_HALT;
+        case PDP11_CPU_STATE_WAIT:
+            if (pdp11_scheduler_next(&self->_scheduler) ==
+                PDP11_SCHEDULER_NEVER)
+                return PDP11_CPU_STOP_WAIT;
+            pdp11_cpu_idle(self);
+            continue;
+        default: break;
+        }
+        if (pdp11_cpu_instrs_left(self) == 0) return PDP11_CPU_STOP_INSTRS;
 
-        if (self->_state == PDP11_CPU_STATE_STEP)
-            self->_state = PDP11_CPU_STATE_HALT;
+        switch (self->_engine) {
+        case PDP11_CPU_ENGINE_LOOP: pdp11_cpu_loop_run(self); break;
+        case PDP11_CPU_ENGINE_THREADED: pdp11_cpu_threaded_run(self); break;
+        case PDP11_CPU_ENGINE_BLOCK:
+        case PDP11_CPU_ENGINE_JIT: pdp11_cpu_block_run(self); break;
+        }
+        // NOTE so that pacing counts afresh once running again
+        self->__pace_speed = 0;
+    }
+    // NOTE only the thread is ever told to stop, and it does not care why
+    return PDP11_CPU_STOP_HALT;
+}
+
+static void pdp11_cpu_thread_helper(Pdp11Cpu *const self) {
+    while (self->__should_thread_run) {
+        pthread_mutex_lock(&self->__state_lock);
+        while (self->__should_thread_run &&
+               (self->_state == PDP11_CPU_STATE_HALT ||
+                (self->_state == PDP11_CPU_STATE_WAIT &&
+                 pdp11_scheduler_next(&self->_scheduler) ==
+                     PDP11_SCHEDULER_NEVER)))
+            pthread_cond_wait(&self->__state_changed, &self->__state_lock);
+        pthread_mutex_unlock(&self->__state_lock);
 
-        usleep(1);
+        pdp11_cpu_exec(self);
     }
 }
 static void *pdp11_cpu_thread(void *const vself) {
     return pdp11_cpu_thread_helper(vself), NULL;
 };
 
+/* The lock and the condition the CPU state is handed between threads by.
+ * Leaves nothing behind on failure. */
+static Result pdp11_cpu_state_sync_init(Pdp11Cpu *const self) {
+    if (pthread_mutex_init(&self->__state_lock, NULL) != 0) return UnknownErr;
+
+    // NOTE paced waits are timed on the same clock pacing counts by
+    pthread_condattr_t state_changed_attr;
+    if (pthread_condattr_init(&state_changed_attr) != 0) {
+        pthread_mutex_destroy(&self->__state_lock);
+        return UnknownErr;
+    }
+    pthread_condattr_setclock(&state_changed_attr, CLOCK_MONOTONIC);
+    bool const is_cond_init =
+        pthread_cond_init(&self->__state_changed, &state_changed_attr) == 0;
+    pthread_condattr_destroy(&state_changed_attr);
+    if (!is_cond_init) {
+        pthread_mutex_destroy(&self->__state_lock);
+        return UnknownErr;
+    }
+
+    return Ok;
+}
+static void pdp11_cpu_state_sync_uninit(Pdp11Cpu *const self) {
+    pthread_cond_destroy(&self->__state_changed);
+    pthread_mutex_destroy(&self->__state_lock);
+}
+
 /************
  ** public **
  ************/
 
-Result pdp11_cpu_init(Pdp11Cpu *const self, Unibus *const unibus) {
+Result pdp11_cpu_init(
+    Pdp11Cpu *const self,
+    Unibus *const unibus,
+    Pdp11CpuEngine const engine,
+    bool const is_threaded
+) {
     for (unsigned i = 0; i < PDP11_CPU_REG_COUNT; i++)
         pdp11_cpu_rx(self, i) = 0;
     UNROLL(pdp11_psw_init(&self->_psw));
+    self->_lazy_flags.op = PDP11_CPU_FLAGS_OP_NONE;
+
+    pthread_once(&pdp11_cpu_decoded_once, pdp11_cpu_decoded_build);
 
     self->_unibus = unibus;
+    self->_ram = NULL;
+    self->_ram_size = 0;
 
-    sem_init(&self->__pending_intr_sem, false, 1);
-    self->__pending_intr = PDP11_CPU_NO_TRAP;
+    atomic_init(&self->__attention, 0);
 
-    self->_state = PDP11_CPU_STATE_HALT;
+    UNROLL(pdp11_scheduler_init(&self->_scheduler));
+    self->__batch_ns = 0;
 
+    self->_speed = 0;
+    self->__pace_host = self->__pace_time = 0;
+    self->__pace_speed = 0;
+    self->__instrs = 0, self->__instrs_limit = PDP11_CPU_NO_LIMIT;
+    self->__intrs = 0;
+    self->__idle_skipped_ns = self->__delay_skipped_ns = 0;
+    self->__copy_skipped_ns = 0;
+
+    self->_state = PDP11_CPU_STATE_HALT;
+    UNROLL_CLEANUP(pdp11_cpu_state_sync_init(self), {
+        pdp11_scheduler_uninit(&self->_scheduler);
+    });
+
+    self->_engine = engine;
+    self->__should_trace_trap = false;
+    self->__has_waited = false;
+#if PDP11_CPU_TRACE
+    pdp11_cpu_trace_init(&self->_trace);
+#endif
+
+    self->_blocks = NULL;
+    if (engine == PDP11_CPU_ENGINE_BLOCK || engine == PDP11_CPU_ENGINE_JIT) {
+        self->_blocks = calloc(PDP11_CPU_BLOCK_COUNT, sizeof(Pdp11CpuBlock));
+        if (!self->_blocks) {
+            pdp11_cpu_state_sync_uninit(self);
+            pdp11_scheduler_uninit(&self->_scheduler);
+            return OutOfMemErr;
+        }
+    }
+    for (unsigned i = 0; i < lenof(self->__is_code_word); i++)
+        atomic_init(self->__is_code_word + i, 0);
+    for (unsigned i = 0; i < PDP11_CPU_CODE_PAGE_COUNT; i++)
+        atomic_init(self->__code_page_gen + i, 0);
+    self->__block_hits = self->__block_misses = 0;
+    atomic_init(&self->__block_invalidations, 0);
+
+    self->_jit_code = NULL, self->_jit_code_len = 0;
+    self->__jit_compiles = 0;
+    if (engine == PDP11_CPU_ENGINE_JIT) pdp11_cpu_jit_init(self);
+
+    // NOTE the runs on the calling thread check this as well
     self->__should_thread_run = true;
-    if (pthread_create(&self->_thread, NULL, pdp11_cpu_thread, self) != 0)
+    self->_is_threaded = is_threaded;
+    if (is_threaded &&
+        pthread_create(&self->_thread, NULL, pdp11_cpu_thread, self) != 0) {
+        pdp11_cpu_jit_uninit(self);
+        free(self->_blocks), self->_blocks = NULL;
+        pdp11_cpu_state_sync_uninit(self);
+        pdp11_scheduler_uninit(&self->_scheduler);
         return UnknownErr;
+    }
 
     return Ok;
 }
 void pdp11_cpu_uninit(Pdp11Cpu *const self) {
-    self->__should_thread_run = false;
-    pthread_join(self->_thread, NULL);
+    pthread_mutex_lock(&self->__state_lock);
+    {
+        self->__should_thread_run = false;
+        pthread_cond_broadcast(&self->__state_changed);
+    }
+    pthread_mutex_unlock(&self->__state_lock);
+    pdp11_cpu_raise_attention(self, PDP11_CPU_ATTENTION_STATE);
+    if (self->_is_threaded) pthread_join(self->_thread, NULL);
+
+    pdp11_cpu_state_sync_uninit(self);
+    pdp11_scheduler_uninit(&self->_scheduler);
 
-    sem_destroy(&self->__pending_intr_sem);
+    free(self->_blocks), self->_blocks = NULL;
+    pdp11_cpu_jit_uninit(self);
 
     pdp11_psw_uninit(&self->_psw);
     pdp11_cpu_pc(self) = 0;
@@ -838,30 +1464,124 @@ void pdp11_cpu_reset(Pdp11Cpu *const self) {
     // for (unsigned i = 0; i < PDP11_CPU_REG_COUNT - 1; i++)
     //     pdp11_cpu_rx(self, i) = 0;
     self->_psw = (Pdp11Psw){0};
-    atomic_exchange(&self->__pending_intr, PDP11_CPU_NO_TRAP);
+    self->_lazy_flags.op = PDP11_CPU_FLAGS_OP_NONE;
 }
 
-void pdp11_cpu_intr(Pdp11Cpu *const self, uint8_t const intr) {
-    sem_wait(&self->__pending_intr_sem);
-    uint8_t const old_intr = atomic_exchange(&self->__pending_intr, intr);
-    // TODO this assumes no two interrupts can happen at the same time, which
-    // is defenetely false, just a bit unlikely
-    assert(old_intr == PDP11_CPU_NO_TRAP), (void)old_intr;
+void pdp11_cpu_drop_code_page(Pdp11Cpu *const self, unsigned const page) {
+    unsigned const page_words = (1 << PDP11_CPU_CODE_PAGE_SHIFT) / 2 / 64;
+    for (unsigned i = 0; i < page_words; i++)
+        atomic_store(self->__is_code_word + page * page_words + i, 0);
+    atomic_fetch_add(self->__code_page_gen + page, 1);
+    atomic_fetch_add(&self->__block_invalidations, 1);
+    // NOTE the engine checks its block only on entering it, or on attention
+    pdp11_cpu_raise_attention(self, PDP11_CPU_ATTENTION_CODE);
+}
+void pdp11_cpu_note_write_run(
+    Pdp11Cpu *const self,
+    uint32_t const addr,
+    uint32_t const end
+) {
+    for (uint32_t word_addr = addr & ~1; word_addr < end; word_addr += 2)
+        pdp11_cpu_note_write(self, word_addr);
+}
+
+Pdp11CpuBlockStats pdp11_cpu_block_stats(Pdp11Cpu const *const self) {
+    return (Pdp11CpuBlockStats){
+        .hits = self->__block_hits,
+        .misses = self->__block_misses,
+        .invalidations = self->__block_invalidations,
+        .compiled = self->__jit_compiles,
+    };
+}
 
-    // TODO this can happen right before the `wait` instr is executed, so not an
-    // ideal way
-    if (self->_state == PDP11_CPU_STATE_WAIT)
-        self->_state = PDP11_CPU_STATE_RUN;
+Pdp11CpuDecoded const *pdp11_cpu_decode(uint16_t const encoded) {
+    pthread_once(&pdp11_cpu_decoded_once, pdp11_cpu_decoded_build);
+    return pdp11_cpu_decoded + encoded;
+}
+
+void pdp11_cpu_map_ram(
+    Pdp11Cpu *const self,
+    void volatile *const ram,
+    uint16_t const size
+) {
+    self->_ram = ram;
+    self->_ram_size = size;
+}
+
+Result pdp11_cpu_schedule(
+    Pdp11Cpu *const self,
+    uint64_t const delay,
+    Pdp11Event const event
+) {
+    bool is_earliest;
+    UNROLL(pdp11_scheduler_schedule(
+        &self->_scheduler,
+        delay,
+        event,
+        &is_earliest
+    ));
+
+    // NOTE the thread only sleeps in WAIT while there is nothing to skip to
+    if (is_earliest) {
+        pthread_mutex_lock(&self->__state_lock);
+        pthread_cond_broadcast(&self->__state_changed);
+        pthread_mutex_unlock(&self->__state_lock);
+    }
+    return Ok;
+}
+void pdp11_cpu_cancel(Pdp11Cpu *const self, Pdp11Event const event) {
+    pdp11_scheduler_cancel(&self->_scheduler, event);
+}
+
+void pdp11_cpu_set_speed(Pdp11Cpu *const self, unsigned const speed) {
+    self->_speed = speed;
+
+    // NOTE a paced wait for the next event has to be cut short
+    pthread_mutex_lock(&self->__state_lock);
+    pthread_cond_broadcast(&self->__state_changed);
+    pthread_mutex_unlock(&self->__state_lock);
+}
+
+void pdp11_cpu_intr(Pdp11Cpu *const self) {
+    // NOTE `wait` checks for a pending interrupt after entering WAIT, so one
+    // arriving right before it is not lost
+    if (unibus_br_is_pending(self->_unibus, pdp11_psw_priority(&self->_psw)))
+        pdp11_cpu_wake_from_wait(self);
+    pdp11_cpu_raise_attention(self, PDP11_CPU_ATTENTION_INTR);
+}
+
+void pdp11_cpu_sync_flags(Pdp11Cpu *const self) {
+    if (self->_lazy_flags.op == PDP11_CPU_FLAGS_OP_NONE) return;
+    self->_psw.flags = pdp11_cpu_flags(self);
+    self->_lazy_flags.op = PDP11_CPU_FLAGS_OP_NONE;
 }
 
 void pdp11_cpu_halt(Pdp11Cpu *const self) {
-    self->_state = PDP11_CPU_STATE_HALT;
+    pdp11_cpu_set_state(self, PDP11_CPU_STATE_HALT);
+    pdp11_cpu_trace_halt(self);
 }
 void pdp11_cpu_continue(Pdp11Cpu *const self) {
-    self->_state = PDP11_CPU_STATE_RUN;
+    pdp11_cpu_set_state(self, PDP11_CPU_STATE_RUN);
 }
 void pdp11_cpu_single_step(Pdp11Cpu *const self) {
-    self->_state = PDP11_CPU_STATE_STEP;
+    pdp11_cpu_set_state(self, PDP11_CPU_STATE_STEP);
+}
+
+Pdp11CpuStop pdp11_cpu_run(Pdp11Cpu *const self, uint64_t const max_instrs) {
+    assert(!self->_is_threaded);
+    if (self->_state == PDP11_CPU_STATE_HALT) pdp11_cpu_continue(self);
+
+    self->__instrs_limit = max_instrs < PDP11_CPU_NO_LIMIT - self->__instrs
+                               ? self->__instrs + max_instrs
+                               : PDP11_CPU_NO_LIMIT;
+    Pdp11CpuStop const stop = pdp11_cpu_exec(self);
+    self->__instrs_limit = PDP11_CPU_NO_LIMIT;
+    return stop;
+}
+Pdp11CpuStop pdp11_cpu_step(Pdp11Cpu *const self) {
+    pdp11_cpu_single_step(self);
+    // NOTE a `wait` stepped into may only be woken, not run past
+    return pdp11_cpu_run(self, 1);
 }
 
 /****************
@@ -873,97 +1593,98 @@ static inline uint32_t xword(uint16_t const word) {
 }
 
 static inline void
-pdp11_psw_set_flags_from_word(Pdp11Psw *const self, uint16_t const value) {
-    self->flags = (Pdp11PswFlags){
-        .t = self->flags.t,
-        .n = BIT(value, 15),
-        .z = value == 0,
-        .v = 0,
-        .c = self->flags.c,
-    };
+pdp11_cpu_set_flags_from_word(Pdp11Cpu *const self, uint16_t const value) {
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_LOGIC,
+        false,
+        0,
+        0,
+        value,
+        pdp11_cpu_flag_c(self)
+    );
 }
 static inline void
-pdp11_psw_set_flags_from_byte(Pdp11Psw *const self, uint8_t const value) {
-    self->flags = (Pdp11PswFlags){
-        .t = self->flags.t,
-        .n = BIT(value, 7),
-        .z = value == 0,
-        .v = 0,
-        .c = self->flags.c,
-    };
+pdp11_cpu_set_flags_from_byte(Pdp11Cpu *const self, uint8_t const value) {
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_LOGIC,
+        true,
+        0,
+        0,
+        value,
+        pdp11_cpu_flag_c(self)
+    );
 }
 
 // SINGLE-OP
 
 // general
 
-void pdp11_cpu_instr_clr(Pdp11Cpu *const self, Pdp11Word const dst) {
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = 0,
-        .z = 1,
-        .v = 0,
-        .c = 0,
-    };
-    dst.vtbl->write(&dst, 0);
-}
-void pdp11_cpu_instr_clrb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = 0,
-        .z = 1,
-        .v = 0,
-        .c = 0,
-    };
-    dst.vtbl->write(&dst, 0);
-}
-void pdp11_cpu_instr_inc(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const res = dst.vtbl->read(&dst) + 1;
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(res, 15),
-        .z = res == 0,
-        .v = res == 0x8000,
-        .c = self->_psw.flags.c,
-    };
-    dst.vtbl->write(&dst, res);
-}
-void pdp11_cpu_instr_incb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const res = dst.vtbl->read(&dst) + 1;
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(res, 7),
-        .z = res == 0,
-        .v = res == 0x80,
-        .c = self->_psw.flags.c,
-    };
-    dst.vtbl->write(&dst, res);
-}
-void pdp11_cpu_instr_dec(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const res = dst.vtbl->read(&dst) - 1;
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(res, 15),
-        .z = res == 0,
-        .v = res == 0x7FFF,
-        .c = self->_psw.flags.c,
-    };
-    dst.vtbl->write(&dst, res);
-}
-void pdp11_cpu_instr_decb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const res = dst.vtbl->read(&dst) - 1;
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(res, 7),
-        .z = res == 0,
-        .v = res == 0x7F,
-        .c = self->_psw.flags.c,
-    };
-    dst.vtbl->write(&dst, res);
+uint16_t pdp11_cpu_instr_clr(Pdp11Cpu *const self) {
+    pdp11_cpu_set_lazy_flags(self, PDP11_CPU_FLAGS_OP_LOGIC, false, 0, 0, 0, 0);
+    return 0;
+}
+uint8_t pdp11_cpu_instr_clrb(Pdp11Cpu *const self) {
+    pdp11_cpu_set_lazy_flags(self, PDP11_CPU_FLAGS_OP_LOGIC, true, 0, 0, 0, 0);
+    return 0;
+}
+uint16_t pdp11_cpu_instr_inc(Pdp11Cpu *const self, uint16_t const dst_val) {
+    uint16_t const res = dst_val + 1;
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_INC,
+        false,
+        0,
+        dst_val,
+        res,
+        pdp11_cpu_flag_c(self)
+    );
+    return res;
+}
+uint8_t pdp11_cpu_instr_incb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    uint8_t const res = dst_val + 1;
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_INC,
+        true,
+        0,
+        dst_val,
+        res,
+        pdp11_cpu_flag_c(self)
+    );
+    return res;
+}
+uint16_t pdp11_cpu_instr_dec(Pdp11Cpu *const self, uint16_t const dst_val) {
+    uint16_t const res = dst_val - 1;
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_DEC,
+        false,
+        0,
+        dst_val,
+        res,
+        pdp11_cpu_flag_c(self)
+    );
+    return res;
+}
+uint8_t pdp11_cpu_instr_decb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    uint8_t const res = dst_val - 1;
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_DEC,
+        true,
+        0,
+        dst_val,
+        res,
+        pdp11_cpu_flag_c(self)
+    );
+    return res;
 }
 
-void pdp11_cpu_instr_neg(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const res = -dst.vtbl->read(&dst);
+uint16_t pdp11_cpu_instr_neg(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
+    uint16_t const res = -dst_val;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 15),
@@ -971,10 +1692,11 @@ void pdp11_cpu_instr_neg(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = res == 0x8000,
         .c = res != 0,
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_negb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const res = -dst.vtbl->read(&dst);
+uint8_t pdp11_cpu_instr_negb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
+    uint8_t const res = -dst_val;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 7),
@@ -982,32 +1704,35 @@ void pdp11_cpu_instr_negb(Pdp11Cpu *const self, Pdp11Byte const dst) {
         .v = res == 0x80,
         .c = res != 0,
     };
-    dst.vtbl->write(&dst, res);
-}
-
-void pdp11_cpu_instr_tst(Pdp11Cpu *const self, Pdp11Word const src) {
-    uint16_t const src_val = src.vtbl->read(&src);
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(src_val, 15),
-        .z = src_val == 0,
-        .v = 0,
-        .c = 0,
-    };
+    return res;
+}
+
+void pdp11_cpu_instr_tst(Pdp11Cpu *const self, uint16_t const src_val) {
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_LOGIC,
+        false,
+        0,
+        0,
+        src_val,
+        0
+    );
 }
-void pdp11_cpu_instr_tstb(Pdp11Cpu *const self, Pdp11Byte const src) {
-    uint8_t const src_val = src.vtbl->read(&src);
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(src_val, 7),
-        .z = src_val == 0,
-        .v = 0,
-        .c = 0,
-    };
+void pdp11_cpu_instr_tstb(Pdp11Cpu *const self, uint8_t const src_val) {
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_LOGIC,
+        true,
+        0,
+        0,
+        src_val,
+        0
+    );
 }
 
-void pdp11_cpu_instr_com(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const res = ~dst.vtbl->read(&dst);
+uint16_t pdp11_cpu_instr_com(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
+    uint16_t const res = ~dst_val;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 15),
@@ -1015,10 +1740,11 @@ void pdp11_cpu_instr_com(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = 0,
         .c = 1,
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_comb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const res = ~dst.vtbl->read(&dst);
+uint8_t pdp11_cpu_instr_comb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
+    uint8_t const res = ~dst_val;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 7),
@@ -1026,13 +1752,13 @@ void pdp11_cpu_instr_comb(Pdp11Cpu *const self, Pdp11Byte const dst) {
         .v = 0,
         .c = 1,
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
 
 // shifts
 
-void pdp11_cpu_instr_asr(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const dst_val = dst.vtbl->read(&dst);
+uint16_t pdp11_cpu_instr_asr(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint16_t const res = (int16_t)dst_val >> 1;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
@@ -1041,10 +1767,10 @@ void pdp11_cpu_instr_asr(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = BIT(res, 15) ^ BIT(dst_val, 0),
         .c = BIT(dst_val, 0),
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_asrb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const dst_val = dst.vtbl->read(&dst);
+uint8_t pdp11_cpu_instr_asrb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint8_t const res = (int8_t)dst_val >> 1;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
@@ -1053,10 +1779,10 @@ void pdp11_cpu_instr_asrb(Pdp11Cpu *const self, Pdp11Byte const dst) {
         .v = BIT(res, 7) ^ BIT(dst_val, 0),
         .c = BIT(dst_val, 0),
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_asl(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const dst_val = dst.vtbl->read(&dst);
+uint16_t pdp11_cpu_instr_asl(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint16_t const res = dst_val << 1;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
@@ -1065,10 +1791,10 @@ void pdp11_cpu_instr_asl(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = BIT(res, 15) ^ BIT(dst_val, 15),
         .c = BIT(dst_val, 15),
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_aslb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const dst_val = dst.vtbl->read(&dst);
+uint8_t pdp11_cpu_instr_aslb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint8_t const res = dst_val << 1;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
@@ -1077,19 +1803,17 @@ void pdp11_cpu_instr_aslb(Pdp11Cpu *const self, Pdp11Byte const dst) {
         .v = BIT(res, 7) ^ BIT(dst_val, 7),
         .c = BIT(dst_val, 7),
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
 
 void pdp11_cpu_instr_ash(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Byte const src
+    uint8_t const src_val
 ) {
-    Pdp11Word const dst = pdp11_word_from_cpu_reg(self, r_i);
+    pdp11_cpu_sync_flags(self);
+    uint16_t const dst_val = pdp11_cpu_rx(self, r_i);
 
-    uint16_t const dst_val = dst.vtbl->read(&dst);
-
-    uint8_t const src_val = src.vtbl->read(&src);
     bool const do_shift_right = BIT(src_val, 5);
     uint8_t const shift_amount = BITS(src_val, 0, 4);
 
@@ -1104,20 +1828,17 @@ void pdp11_cpu_instr_ash(
         .v = BIT(res, 15) ^ BIT(dst_val, 15),
         .c = BIT(dst_val, do_shift_right ? shift_amount : 16 - shift_amount),
     };
-    dst.vtbl->write(&dst, res);
+    pdp11_cpu_rx(self, r_i) = res;
 }
 void pdp11_cpu_instr_ashc(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Word const src
+    uint16_t const src_val
 ) {
-    Pdp11Word const dst0 = pdp11_word_from_cpu_reg(self, r_i),
-                    dst1 = pdp11_word_from_cpu_reg(self, r_i | 1);
-
+    pdp11_cpu_sync_flags(self);
     uint32_t const dst_val =
-        dst0.vtbl->read(&dst0) | (dst1.vtbl->read(&dst1) << 16);
+        pdp11_cpu_rx(self, r_i) | (pdp11_cpu_rx(self, r_i | 1) << 16);
 
-    uint8_t const src_val = src.vtbl->read(&src);
     bool const do_shift_right = BIT(src_val, 5);
     uint8_t const shift_amount = BITS(src_val, 0, 4);
 
@@ -1132,14 +1853,15 @@ void pdp11_cpu_instr_ashc(
         .v = BIT(res, 31) ^ BIT(dst_val, 31),
         .c = BIT(dst_val, do_shift_right ? shift_amount : 31 - shift_amount),
     };
-    dst0.vtbl->write(&dst0, (uint16_t)res);
-    if ((r_i & 1) == 0) dst1.vtbl->write(&dst1, (uint16_t)(res >> 16));
+    pdp11_cpu_rx(self, r_i) = (uint16_t)res;
+    if ((r_i & 1) == 0) pdp11_cpu_rx(self, r_i | 1) = (uint16_t)(res >> 16);
 }
 
 // multiple-percision
 
-void pdp11_cpu_instr_adc(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const res = dst.vtbl->read(&dst) + self->_psw.flags.c;
+uint16_t pdp11_cpu_instr_adc(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
+    uint16_t const res = dst_val + self->_psw.flags.c;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 15),
@@ -1147,10 +1869,11 @@ void pdp11_cpu_instr_adc(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = self->_psw.flags.c && res == 0x8000,
         .c = self->_psw.flags.c && res == 0x0000,
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_adcb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const res = dst.vtbl->read(&dst) + self->_psw.flags.c;
+uint8_t pdp11_cpu_instr_adcb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
+    uint8_t const res = dst_val + self->_psw.flags.c;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 7),
@@ -1158,10 +1881,11 @@ void pdp11_cpu_instr_adcb(Pdp11Cpu *const self, Pdp11Byte const dst) {
         .v = self->_psw.flags.c && res == 0x80,
         .c = self->_psw.flags.c && res == 0x00,
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_sbc(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const res = dst.vtbl->read(&dst) - self->_psw.flags.c;
+uint16_t pdp11_cpu_instr_sbc(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
+    uint16_t const res = dst_val - self->_psw.flags.c;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 15),
@@ -1169,10 +1893,11 @@ void pdp11_cpu_instr_sbc(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = self->_psw.flags.c && res == 0x7FFF,
         .c = self->_psw.flags.c && res == 0xFFFF,
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_sbcb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const res = dst.vtbl->read(&dst) - self->_psw.flags.c;
+uint8_t pdp11_cpu_instr_sbcb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
+    uint8_t const res = dst_val - self->_psw.flags.c;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 7),
@@ -1180,10 +1905,11 @@ void pdp11_cpu_instr_sbcb(Pdp11Cpu *const self, Pdp11Byte const dst) {
         .v = self->_psw.flags.c && res == 0x7F,
         .c = self->_psw.flags.c && res == 0xFF,
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
 
-void pdp11_cpu_instr_sxt(Pdp11Cpu *const self, Pdp11Word const dst) {
+uint16_t pdp11_cpu_instr_sxt(Pdp11Cpu *const self) {
+    pdp11_cpu_sync_flags(self);
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = self->_psw.flags.n,
@@ -1191,13 +1917,13 @@ void pdp11_cpu_instr_sxt(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = 0,
         .c = self->_psw.flags.c,
     };
-    dst.vtbl->write(&dst, self->_psw.flags.n ? 0xFFFF : 0x0000);
+    return self->_psw.flags.n ? 0xFFFF : 0x0000;
 }
 
 // rotates
 
-void pdp11_cpu_instr_ror(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const dst_val = dst.vtbl->read(&dst);
+uint16_t pdp11_cpu_instr_ror(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint16_t const res = (dst_val >> 1) | (self->_psw.flags.c << 15);
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
@@ -1206,10 +1932,10 @@ void pdp11_cpu_instr_ror(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = BIT(res, 15) ^ BIT(dst_val, 0),
         .c = BIT(dst_val, 0),
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_rorb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const dst_val = dst.vtbl->read(&dst);
+uint8_t pdp11_cpu_instr_rorb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint8_t const res = (dst_val >> 1) | (self->_psw.flags.c << 7);
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
@@ -1218,10 +1944,10 @@ void pdp11_cpu_instr_rorb(Pdp11Cpu *const self, Pdp11Byte const dst) {
         .v = BIT(res, 7) ^ BIT(dst_val, 0),
         .c = BIT(dst_val, 0),
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_rol(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const dst_val = dst.vtbl->read(&dst);
+uint16_t pdp11_cpu_instr_rol(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint16_t const res = (dst_val << 1) | self->_psw.flags.c;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
@@ -1230,10 +1956,10 @@ void pdp11_cpu_instr_rol(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = BIT(res, 15) ^ BIT(dst_val, 15),
         .c = BIT(dst_val, 15),
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
-void pdp11_cpu_instr_rolb(Pdp11Cpu *const self, Pdp11Byte const dst) {
-    uint8_t const dst_val = dst.vtbl->read(&dst);
+uint8_t pdp11_cpu_instr_rolb(Pdp11Cpu *const self, uint8_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint8_t const res = (dst_val << 1) | self->_psw.flags.c;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
@@ -1242,11 +1968,11 @@ void pdp11_cpu_instr_rolb(Pdp11Cpu *const self, Pdp11Byte const dst) {
         .v = BIT(res, 7) ^ BIT(dst_val, 7),
         .c = BIT(dst_val, 7),
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
 
-void pdp11_cpu_instr_swab(Pdp11Cpu *const self, Pdp11Word const dst) {
-    uint16_t const dst_val = dst.vtbl->read(&dst);
+uint16_t pdp11_cpu_instr_swab(Pdp11Cpu *const self, uint16_t const dst_val) {
+    pdp11_cpu_sync_flags(self);
     uint16_t const res =
         (uint16_t)(dst_val << 8) | (uint16_t)(uint8_t)(dst_val >> 8);
     self->_psw.flags = (Pdp11PswFlags){
@@ -1256,106 +1982,86 @@ void pdp11_cpu_instr_swab(Pdp11Cpu *const self, Pdp11Word const dst) {
         .v = 0,
         .c = 0,
     };
-    dst.vtbl->write(&dst, res);
+    return res;
 }
 
 // DUAL-OP
 
 // arithmetic
 
-void pdp11_cpu_instr_mov(
-    Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
-) {
-    uint16_t const src_val = src.vtbl->read(&src);
-    pdp11_psw_set_flags_from_word(&self->_psw, src_val);
-    dst.vtbl->write(&dst, src_val);
+uint16_t pdp11_cpu_instr_mov(Pdp11Cpu *const self, uint16_t const src_val) {
+    pdp11_cpu_set_flags_from_word(self, src_val);
+    return src_val;
 }
-void pdp11_cpu_instr_movb(
-    Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
-) {
-    uint8_t const src_val = src.vtbl->read(&src);
-    pdp11_psw_set_flags_from_byte(&self->_psw, src_val);
-    if (dst.vtbl == &pdp11_cpu_reg_byte_vtbl) {
-        Pdp11Word const dstw = pdp11_word_from_cpu_reg(self, dst.addr);
-        pdp11_cpu_reg_word_write(&dstw, (int16_t)(int8_t)src_val);
-    } else {
-        dst.vtbl->write(&dst, src_val);
-    }
+uint8_t pdp11_cpu_instr_movb(Pdp11Cpu *const self, uint8_t const src_val) {
+    pdp11_cpu_set_flags_from_byte(self, src_val);
+    return src_val;
 }
-void pdp11_cpu_instr_add(
+uint16_t pdp11_cpu_instr_add(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 ) {
-    uint32_t const res =
-        xword(src.vtbl->read(&src)) + xword(dst.vtbl->read(&dst));
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(res, 15),
-        .z = (uint16_t)res == 0,
-        // TODO? maybe excessive and can be the same as in sub
-        .v = BIT(res, 16) != BIT(res, 15),
-        .c = BIT(res, 17),
-    };
-    dst.vtbl->write(&dst, res);
+    uint16_t const res = src_val + dst_val;
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_ADD,
+        false,
+        src_val,
+        dst_val,
+        res,
+        0
+    );
+    return res;
 }
-void pdp11_cpu_instr_sub(
+uint16_t pdp11_cpu_instr_sub(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 ) {
-    uint16_t const dst_val = dst.vtbl->read(&dst),
-                   src_val = src.vtbl->read(&src);
     uint16_t const res = dst_val - src_val;
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(res, 15),
-        .z = (uint16_t)res == 0,
-        .v = BIT(dst_val, 15) != BIT(src_val, 15) &&
-             BIT(src_val, 15) == BIT(res, 15),
-        .c = src_val > dst_val,
-    };
-    dst.vtbl->write(&dst, res);
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_SUB,
+        false,
+        src_val,
+        dst_val,
+        res,
+        0
+    );
+    return res;
 }
 void pdp11_cpu_instr_cmp(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 ) {
-    // NOTE args are swapped on purpose
-    uint16_t const dst_val = src.vtbl->read(&src),
-                   src_val = dst.vtbl->read(&dst);
-    uint16_t const res = dst_val - src_val;
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(res, 15),
-        .z = (uint16_t)res == 0,
-        .v = BIT(dst_val, 15) != BIT(src_val, 15) &&
-             BIT(src_val, 15) == BIT(res, 15),
-        .c = src_val > dst_val,
-    };
+    // NOTE operands are swapped relative to `sub` on purpose
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_SUB,
+        false,
+        dst_val,
+        src_val,
+        src_val - dst_val,
+        0
+    );
 }
 void pdp11_cpu_instr_cmpb(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
+    uint8_t const src_val,
+    uint8_t const dst_val
 ) {
-    // NOTE args are swapped on purpose
-    uint8_t const dst_val = src.vtbl->read(&src),
-                  src_val = dst.vtbl->read(&dst);
-    uint8_t const res = dst_val - src_val;
-    self->_psw.flags = (Pdp11PswFlags){
-        .t = self->_psw.flags.t,
-        .n = BIT(res, 7),
-        .z = (uint8_t)res == 0,
-        .v = BIT(dst_val, 7) != BIT(src_val, 7) &&
-             BIT(src_val, 7) == BIT(res, 7),
-        .c = src_val > dst_val,
-    };
+    // NOTE operands are swapped relative to `sub` on purpose
+    pdp11_cpu_set_lazy_flags(
+        self,
+        PDP11_CPU_FLAGS_OP_SUB,
+        true,
+        dst_val,
+        src_val,
+        src_val - dst_val,
+        0
+    );
 }
 
 // register destination
@@ -1363,13 +2069,10 @@ void pdp11_cpu_instr_cmpb(
 void pdp11_cpu_instr_mul(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Word const src
+    uint16_t const src_val
 ) {
-    Pdp11Word const dst0 = pdp11_word_from_cpu_reg(self, r_i),
-                    dst1 = pdp11_word_from_cpu_reg(self, r_i | 1);
-
-    uint32_t const res =
-        (int16_t)dst0.vtbl->read(&dst0) * (int16_t)src.vtbl->read(&src);
+    pdp11_cpu_sync_flags(self);
+    uint32_t const res = (int16_t)pdp11_cpu_rx(self, r_i) * (int16_t)src_val;
     self->_psw.flags = (Pdp11PswFlags){
         .t = self->_psw.flags.t,
         .n = BIT(res, 15),
@@ -1377,25 +2080,22 @@ void pdp11_cpu_instr_mul(
         .v = 0,
         .c = (uint16_t)(res >> 16) != (BIT(res, 15) ? 0xFFFF : 0x0000),
     };
-    dst0.vtbl->write(&dst0, (uint16_t)res);
-    if ((r_i & 1) == 0) dst1.vtbl->write(&dst1, (uint16_t)(res >> 16));
+    pdp11_cpu_rx(self, r_i) = (uint16_t)res;
+    if ((r_i & 1) == 0) pdp11_cpu_rx(self, r_i | 1) = (uint16_t)(res >> 16);
 }
 void pdp11_cpu_instr_div(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Word const src
+    uint16_t const src_val
 ) {
-    Pdp11Word const dst0 = pdp11_word_from_cpu_reg(self, r_i),
-                    dst1 = pdp11_word_from_cpu_reg(self, r_i | 1);
-
-    uint16_t const src_val = src.vtbl->read(&src);
+    pdp11_cpu_sync_flags(self);
     if (src_val == 0) {
         self->_psw.flags.v = self->_psw.flags.c = 1;
         return;
     }
     uint32_t const dst_val =
-        dst0.vtbl->read(&dst0) |
-        ((r_i & 1) == 0 ? dst1.vtbl->read(&dst1) << 16 : 0);
+        pdp11_cpu_rx(self, r_i) |
+        ((r_i & 1) == 0 ? pdp11_cpu_rx(self, r_i | 1) << 16 : 0);
 
     uint32_t const quotient = dst_val / src_val;
     uint32_t const remainder = dst_val % src_val;
@@ -1410,74 +2110,71 @@ void pdp11_cpu_instr_div(
         .v = 0,
         .c = 0,
     };
-    dst0.vtbl->write(&dst0, quotient);
-    if ((r_i & 1) == 0) dst1.vtbl->write(&dst1, remainder);
+    pdp11_cpu_rx(self, r_i) = quotient;
+    if ((r_i & 1) == 0) pdp11_cpu_rx(self, r_i | 1) = remainder;
 }
 
-void pdp11_cpu_instr_xor(
+uint16_t pdp11_cpu_instr_xor(
     Pdp11Cpu *const self,
     unsigned const r_i,
-    Pdp11Word const dst
+    uint16_t const dst_val
 ) {
-    Pdp11Word const src = pdp11_word_from_cpu_reg(self, r_i);
-    uint16_t const res = dst.vtbl->read(&dst) ^ src.vtbl->read(&src);
-    pdp11_psw_set_flags_from_word(&self->_psw, res);
-    dst.vtbl->write(&dst, res);
+    uint16_t const res = dst_val ^ pdp11_cpu_rx(self, r_i);
+    pdp11_cpu_set_flags_from_word(self, res);
+    return res;
 }
 
 // logical
 
 void pdp11_cpu_instr_bit(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 ) {
-    pdp11_psw_set_flags_from_word(
-        &self->_psw,
-        dst.vtbl->read(&dst) & src.vtbl->read(&src)
-    );
+    pdp11_cpu_set_flags_from_word(self, dst_val & src_val);
 }
 void pdp11_cpu_instr_bitb(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
+    uint8_t const src_val,
+    uint8_t const dst_val
 ) {
-    pdp11_psw_set_flags_from_byte(
-        &self->_psw,
-        dst.vtbl->read(&dst) & src.vtbl->read(&src)
-    );
+    pdp11_cpu_set_flags_from_byte(self, dst_val & src_val);
 }
-void pdp11_cpu_instr_bis(
+uint16_t pdp11_cpu_instr_bis(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 ) {
-    dst.vtbl->write(&dst, dst.vtbl->read(&dst) | src.vtbl->read(&src));
-    pdp11_cpu_instr_bit(self, dst, dst);
+    uint16_t const res = dst_val | src_val;
+    pdp11_cpu_set_flags_from_word(self, res);
+    return res;
 }
-void pdp11_cpu_instr_bisb(
+uint8_t pdp11_cpu_instr_bisb(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
+    uint8_t const src_val,
+    uint8_t const dst_val
 ) {
-    dst.vtbl->write(&dst, dst.vtbl->read(&dst) | src.vtbl->read(&src));
-    pdp11_cpu_instr_bitb(self, dst, dst);
+    uint8_t const res = dst_val | src_val;
+    pdp11_cpu_set_flags_from_byte(self, res);
+    return res;
 }
-void pdp11_cpu_instr_bic(
+uint16_t pdp11_cpu_instr_bic(
     Pdp11Cpu *const self,
-    Pdp11Word const src,
-    Pdp11Word const dst
+    uint16_t const src_val,
+    uint16_t const dst_val
 ) {
-    dst.vtbl->write(&dst, dst.vtbl->read(&dst) & ~src.vtbl->read(&src));
-    pdp11_cpu_instr_bit(self, dst, dst);
+    uint16_t const res = dst_val & ~src_val;
+    pdp11_cpu_set_flags_from_word(self, res);
+    return res;
 }
-void pdp11_cpu_instr_bicb(
+uint8_t pdp11_cpu_instr_bicb(
     Pdp11Cpu *const self,
-    Pdp11Byte const src,
-    Pdp11Byte const dst
+    uint8_t const src_val,
+    uint8_t const dst_val
 ) {
-    dst.vtbl->write(&dst, dst.vtbl->read(&dst) & ~src.vtbl->read(&src));
-    pdp11_cpu_instr_bitb(self, dst, dst);
+    uint8_t const res = dst_val & ~src_val;
+    pdp11_cpu_set_flags_from_byte(self, res);
+    return res;
 }
 
 // PROGRAM CONTROL
@@ -1493,28 +2190,32 @@ void pdp11_cpu_instr_bne_be(
     bool const cond,
     uint8_t const off
 ) {
-    if (self->_psw.flags.z == cond) pdp11_cpu_instr_br(self, off);
+    Pdp11PswFlags const flags = pdp11_cpu_flags(self);
+    if (flags.z == cond) pdp11_cpu_instr_br(self, off);
 }
 void pdp11_cpu_instr_bpl_bmi(
     Pdp11Cpu *const self,
     bool const cond,
     uint8_t const off
 ) {
-    if (self->_psw.flags.n == cond) pdp11_cpu_instr_br(self, off);
+    Pdp11PswFlags const flags = pdp11_cpu_flags(self);
+    if (flags.n == cond) pdp11_cpu_instr_br(self, off);
 }
 void pdp11_cpu_instr_bcc_bcs(
     Pdp11Cpu *const self,
     bool const cond,
     uint8_t const off
 ) {
-    if (self->_psw.flags.c == cond) pdp11_cpu_instr_br(self, off);
+    Pdp11PswFlags const flags = pdp11_cpu_flags(self);
+    if (flags.c == cond) pdp11_cpu_instr_br(self, off);
 }
 void pdp11_cpu_instr_bvc_bvs(
     Pdp11Cpu *const self,
     bool const cond,
     uint8_t const off
 ) {
-    if (self->_psw.flags.v == cond) pdp11_cpu_instr_br(self, off);
+    Pdp11PswFlags const flags = pdp11_cpu_flags(self);
+    if (flags.v == cond) pdp11_cpu_instr_br(self, off);
 }
 
 void pdp11_cpu_instr_bge_bl(
@@ -1522,16 +2223,16 @@ void pdp11_cpu_instr_bge_bl(
     bool const cond,
     uint8_t const off
 ) {
-    if ((self->_psw.flags.n ^ self->_psw.flags.v) == cond)
-        pdp11_cpu_instr_br(self, off);
+    Pdp11PswFlags const flags = pdp11_cpu_flags(self);
+    if ((flags.n ^ flags.v) == cond) pdp11_cpu_instr_br(self, off);
 }
 void pdp11_cpu_instr_bg_ble(
     Pdp11Cpu *const self,
     bool const cond,
     uint8_t const off
 ) {
-    if ((self->_psw.flags.z || self->_psw.flags.n ^ self->_psw.flags.v) == cond)
-        pdp11_cpu_instr_br(self, off);
+    Pdp11PswFlags const flags = pdp11_cpu_flags(self);
+    if ((flags.z || flags.n ^ flags.v) == cond) pdp11_cpu_instr_br(self, off);
 }
 
 void pdp11_cpu_instr_bhi_blos(
@@ -1539,8 +2240,8 @@ void pdp11_cpu_instr_bhi_blos(
     bool const cond,
     uint8_t const off
 ) {
-    if ((self->_psw.flags.c || self->_psw.flags.z) == cond)
-        pdp11_cpu_instr_br(self, off);
+    Pdp11PswFlags const flags = pdp11_cpu_flags(self);
+    if ((flags.c || flags.z) == cond) pdp11_cpu_instr_br(self, off);
 }
 
 // subroutine
@@ -1553,29 +2254,27 @@ void pdp11_cpu_instr_jsr_jmp(
     uint16_t const effective_addr =
         pdp11_cpu_jmp_jsr_effective_addr(self, mode);
     if (r_i < PDP11_CPU_REG_COUNT) {
-        Pdp11Word const dst = pdp11_word_from_cpu_reg(self, r_i);
-        if (pdp11_stack_push(self, dst.vtbl->read(&dst)) != Ok)
-            return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
-        dst.vtbl->write(&dst, pdp11_cpu_pc(self));
+        pdp11_stack_push(self, pdp11_cpu_rx(self, r_i));
+        pdp11_cpu_rx(self, r_i) = pdp11_cpu_pc(self);
     }
     pdp11_cpu_pc(self) = effective_addr;
 }
 void pdp11_cpu_instr_mark(Pdp11Cpu *const self, unsigned const param_count) {
     pdp11_cpu_sp(self) = pdp11_cpu_pc(self) + 2 * param_count;
     pdp11_cpu_pc(self) = pdp11_cpu_rx(self, 5);
-    if (pdp11_stack_pop(self, &pdp11_cpu_rx(self, 5)) != Ok)
-        return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
+    pdp11_cpu_rx(self, 5) = pdp11_stack_pop(self);
 }
 void pdp11_cpu_instr_rts(Pdp11Cpu *const self, unsigned const r_i) {
     pdp11_cpu_pc(self) = pdp11_cpu_rx(self, r_i);
-    if (pdp11_stack_pop(self, &pdp11_cpu_rx(self, r_i)) != Ok)
-        return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
+    pdp11_cpu_rx(self, r_i) = pdp11_stack_pop(self);
 }
 
 // program control
 
 void pdp11_cpu_instr_spl(Pdp11Cpu *const self, uint8_t const value) {
     pdp11_psw_set_priority(&self->_psw, value);
+    // NOTE so that a request the old priority has held back is taken
+    pdp11_cpu_raise_attention(self, PDP11_CPU_ATTENTION_PSW);
 }
 
 void pdp11_cpu_instr_sob(
@@ -1583,10 +2282,7 @@ void pdp11_cpu_instr_sob(
     unsigned const r_i,
     uint8_t const off
 ) {
-    Pdp11Word const dst = pdp11_word_from_cpu_reg(self, r_i);
-    uint16_t const res = dst.vtbl->read(&dst) - 1;
-    dst.vtbl->write(&dst, res);
-    if (res != 0) pdp11_cpu_pc(self) -= 2 * off;
+    if (--pdp11_cpu_rx(self, r_i) != 0) pdp11_cpu_pc(self) -= 2 * off;
 }
 
 // trap
@@ -1604,20 +2300,26 @@ void pdp11_cpu_instr_iot(Pdp11Cpu *const self) {
     pdp11_cpu_trap(self, PDP11_CPU_TRAP_IOT);
 }
 void pdp11_cpu_instr_rti_rtt(Pdp11Cpu *const self) {
-    uint16_t psw_word;
-    if (pdp11_stack_pop(self, &pdp11_cpu_pc(self)) != Ok ||
-        pdp11_stack_pop(self, &psw_word) != Ok)
-        return pdp11_cpu_trap(self, PDP11_CPU_TRAP_CPU_ERR);
+    pdp11_cpu_pc(self) = pdp11_stack_pop(self);
+    uint16_t const psw_word = pdp11_stack_pop(self);
+    pdp11_cpu_sync_flags(self);
     pdp11_psw_set(&self->_psw, psw_word);
+    pdp11_cpu_raise_attention(self, PDP11_CPU_ATTENTION_PSW);
 }
 
 // MISC.
 
 void pdp11_cpu_instr_halt(Pdp11Cpu *const self) {
-    self->_state = PDP11_CPU_STATE_HALT;
+    pdp11_cpu_sync_flags(self);
+    pdp11_cpu_set_state(self, PDP11_CPU_STATE_HALT);
+    pdp11_cpu_trace_halt(self);
 }
 void pdp11_cpu_instr_wait(Pdp11Cpu *const self) {
-    self->_state = PDP11_CPU_STATE_WAIT;
+    pdp11_cpu_sync_flags(self);
+    pdp11_cpu_set_state(self, PDP11_CPU_STATE_WAIT);
+    self->__has_waited = true;
+    if (unibus_br_is_pending(self->_unibus, pdp11_psw_priority(&self->_psw)))
+        pdp11_cpu_wake_from_wait(self);
 }
 void pdp11_cpu_instr_reset(Pdp11Cpu *const self) {
     unibus_reset(self->_unibus);
@@ -1633,6 +2335,7 @@ void pdp11_cpu_instr_clnzvc_senzvc(
     bool const do_affect_vf,
     bool const do_affect_cf
 ) {
+    pdp11_cpu_sync_flags(self);
     if (do_affect_nf) self->_psw.flags.n = value;
     if (do_affect_zf) self->_psw.flags.z = value;
     if (do_affect_vf) self->_psw.flags.v = value;
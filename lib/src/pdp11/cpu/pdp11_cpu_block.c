@@ -0,0 +1,214 @@
+#include "pdp11/cpu/pdp11_cpu_engine.h"
+
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bits.h"
+#include "pdp11/unibus/unibus.h"
+
+/* Basic-block engine. Straight-line runs of instructions are decoded once
+ * into a direct-mapped cache keyed by their start PC, so the hot path only
+ * walks an array of already decoded records. A block never crosses a code
+ * page, and the blocks of a page are dropped as soon as anything writes to a
+ * word any of them has been decoded from (see `pdp11_cpu_note_write`), data
+ * next to the code being left alone. A block is only checked on being entered,
+ * a write to it raises `PDP11_CPU_ATTENTION_CODE` to have it checked again. */
+
+/*************
+ ** private **
+ *************/
+
+static inline unsigned pdp11_cpu_code_page(uint16_t const addr) {
+    return addr >> PDP11_CPU_CODE_PAGE_SHIFT;
+}
+static inline uint32_t
+pdp11_cpu_code_page_gen(Pdp11Cpu const *const self, uint16_t const addr) {
+    return atomic_load_explicit(
+        self->__code_page_gen + pdp11_cpu_code_page(addr),
+        memory_order_acquire
+    );
+}
+
+// Number of index words that follow the opcode for operand `o`.
+static inline unsigned pdp11_cpu_o_extra_words(unsigned const o) {
+    unsigned const mode = BITS(o, 3, 5), r = BITS(o, 0, 2);
+    return mode >= 6 || ((mode == 2 || mode == 3) && r == 7);
+}
+static unsigned pdp11_cpu_extra_words(Pdp11CpuDecoded const *const decoded) {
+    Pdp11CpuInstr const instr = decoded->instr;
+    switch (instr.type) {
+    case PDP11_CPU_INSTR_TYPE_O:
+        return pdp11_cpu_o_extra_words(instr.u.o.o);
+    case PDP11_CPU_INSTR_TYPE_OO:
+        return pdp11_cpu_o_extra_words(instr.u.oo.o0) +
+               pdp11_cpu_o_extra_words(instr.u.oo.o1);
+    case PDP11_CPU_INSTR_TYPE_RO:
+        return pdp11_cpu_o_extra_words(instr.u.ro.o);
+    case PDP11_CPU_INSTR_TYPE_JSR:
+        return pdp11_cpu_o_extra_words(instr.u.jsr.o);
+    case PDP11_CPU_INSTR_TYPE_JMP:
+        return pdp11_cpu_o_extra_words(instr.u.jmp.o);
+    default: return 0;
+    }
+}
+
+// Whether the block has to end after the operation, because it transfers
+// control or changes the state of the CPU. NOTE a conditional branch does not,
+// the block goes on for when it is not taken.
+static bool pdp11_cpu_ends_block(Pdp11CpuOp const op) {
+    switch (op) {
+    case PDP11_CPU_OP_RESERVED:
+    case PDP11_CPU_OP_BR:
+    case PDP11_CPU_OP_RTS:
+    case PDP11_CPU_OP_SOB:
+    case PDP11_CPU_OP_JSR:
+    case PDP11_CPU_OP_JMP:
+    case PDP11_CPU_OP_MARK:
+    case PDP11_CPU_OP_EMT:
+    case PDP11_CPU_OP_TRAP:
+    case PDP11_CPU_OP_RTI_RTT:
+    case PDP11_CPU_OP_BPT:
+    case PDP11_CPU_OP_IOT:
+    case PDP11_CPU_OP_HALT:
+    case PDP11_CPU_OP_WAIT:
+    case PDP11_CPU_OP_RESET: return true;
+    default: return false;
+    }
+}
+
+static Pdp11CpuBlock *
+pdp11_cpu_block_build(Pdp11Cpu *const self, uint16_t const pc) {
+    Pdp11CpuBlock *const block =
+        self->_blocks + ((pc >> 1) & (PDP11_CPU_BLOCK_COUNT - 1));
+    unsigned const page = pdp11_cpu_code_page(pc);
+
+    if (block->len == 0 || block->pc != pc) block->runs = 0;
+    block->gen = pdp11_cpu_code_page_gen(self, pc);
+    block->pc = pc;
+    block->len = 0;
+    block->jit_starts = 0;
+    block->is_jit_scanned = false;
+
+    uint16_t addr = pc;
+    while (block->len < PDP11_CPU_BLOCK_MAX_LEN &&
+           pdp11_cpu_code_page(addr) == page) {
+        // NOTE the word is marked before it is read, so that any write racing
+        // with the decoding bumps the generation and the block gets dropped.
+        // Only the opcodes are, the index words are read as the code runs
+        unsigned const word = addr >> 1;
+        atomic_fetch_or(self->__is_code_word + word / 64, 1ull << word % 64);
+        uint16_t encoded;
+        if (addr < self->_ram_size) encoded = self->_ram[word];
+        else if (unibus_cpu_dati(self->_unibus, addr, &encoded) != Ok) break;
+
+        Pdp11CpuDecoded const *const decoded = pdp11_cpu_decoded + encoded;
+        // NOTE `Pdp11CpuInstr` is all const fields, so it can only be copied
+        Pdp11CpuBlockRecord *const record = block->records + block->len++;
+        record->exec = decoded->exec;
+        memcpy(&record->instr, &decoded->instr, sizeof(record->instr));
+        record->time = decoded->time;
+        record->pc = addr;
+        record->encoded = encoded;
+        if (pdp11_cpu_ends_block(decoded->op)) break;
+        addr += 2 + 2 * pdp11_cpu_extra_words(decoded);
+    }
+    return block->len == 0 ? NULL : block;
+}
+static Pdp11CpuBlock *
+pdp11_cpu_block_lookup(Pdp11Cpu *const self, uint16_t const pc) {
+    Pdp11CpuBlock *const block =
+        self->_blocks + ((pc >> 1) & (PDP11_CPU_BLOCK_COUNT - 1));
+    if (block->len != 0 && block->pc == pc &&
+        block->gen == pdp11_cpu_code_page_gen(self, pc)) {
+        self->__block_hits++;
+        if (self->_engine == PDP11_CPU_ENGINE_JIT && !block->is_jit_scanned &&
+            ++block->runs >= PDP11_CPU_JIT_THRESHOLD)
+            pdp11_cpu_jit_compile(self, block);
+        return block;
+    }
+
+    self->__block_misses++;
+    return pdp11_cpu_block_build(self, pc);
+}
+
+// Runs a single instruction, or a compiled run, at PC, with `ns` left in the
+// batch. Returns the simulated nanoseconds it has taken.
+static inline uint32_t pdp11_cpu_block_step(
+    Pdp11Cpu *const self,
+    Pdp11CpuBlock **const block,
+    unsigned *const i,
+    int32_t const ns
+) {
+    uint16_t const pc = pdp11_cpu_pc(self);
+
+    // NOTE anything that leaves the straight line (a taken branch, a trap,
+    // an interrupt, a write to PC) just shows as a PC mismatch
+    if (!*block || *i >= (*block)->len || (*block)->records[*i].pc != pc) {
+        *block = pdp11_cpu_block_lookup(self, pc), *i = 0;
+        if (!*block) {
+            Pdp11CpuDecoded const *const decoded =
+                pdp11_cpu_decoded + pdp11_cpu_fetch(self);
+            decoded->exec(self, decoded->instr);
+            return decoded->time;
+        }
+    }
+
+    Pdp11CpuBlockRecord const *const record = (*block)->records + *i;
+    // NOTE compiled code neither traces nor steps instruction by instruction,
+    // so it is only entered while freely running, and with room for a whole
+    // pass, which it goes for another of only if there is room again
+    if ((*block)->jit_starts >> *i & 1 &&
+        self->_state == PDP11_CPU_STATE_RUN && !self->_psw.flags.t &&
+        !pdp11_cpu_is_tracing(self) && (int32_t)(*block)->jits[*i].time <= ns &&
+        (*block)->jits[*i].len <= pdp11_cpu_instrs_left(self)) {
+        uint32_t const spent = pdp11_cpu_jit_run(self, *block, *i, ns);
+        if (spent) {
+            // NOTE it may have left off anywhere, in the block or out of it
+            while (*i < (*block)->len &&
+                   (*block)->records[*i].pc != pdp11_cpu_pc(self))
+                ++*i;
+            return spent;
+        }
+    }
+
+    ++*i;
+    if (pdp11_cpu_is_tracing(self))
+        pdp11_cpu_trace_fetch(self, pc, record->encoded);
+    pdp11_cpu_pc(self) += 2;
+    self->__instrs++;
+    record->exec(self, record->instr);
+    return record->time;
+}
+
+/************
+ ** public **
+ ************/
+
+void pdp11_cpu_block_run(Pdp11Cpu *const self) {
+    // NOTE `volatile` to be kept across a bus error, the block carries over
+    // from batch to batch
+    Pdp11CpuBlock *volatile last_block = NULL;
+    unsigned volatile last_i = 0;
+
+    for (int32_t volatile ns; (ns = pdp11_cpu_before_batch(self));) {
+        if (setjmp(self->__bus_error)) {
+            // NOTE the block has been left halfway, wherever it was
+            last_block = NULL, last_i = 0;
+            pdp11_cpu_take_bus_error(self);
+            pdp11_cpu_after_batch(self, ns - PDP11_CPU_TRAP_NS);
+            continue;
+        }
+        Pdp11CpuBlock *block = last_block;
+        unsigned i = last_i;
+        // NOTE its code may have been written to while it was not running
+        if (block && block->gen != pdp11_cpu_code_page_gen(self, block->pc))
+            block = NULL;
+        do ns -= pdp11_cpu_block_step(self, &block, &i, ns);
+        while (ns > 0 && !pdp11_cpu_needs_attention(self));
+        last_block = block, last_i = i;
+        pdp11_cpu_after_batch(self, ns);
+    }
+}
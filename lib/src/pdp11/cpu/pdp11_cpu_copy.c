@@ -0,0 +1,134 @@
+#include "pdp11/cpu/pdp11_cpu_engine.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bits.h"
+#include "pdp11/unibus/unibus.h"
+
+/* Copy and fill loops move words through autoincremented registers, as
+ * `mov (R1)+, (R2)+; sob R0, .-4` and `clr (R2)+; sob R0, .-2` do. While all
+ * of it stays in the RAM the CPU accesses directly, whole iterations are done
+ * on the host memory in one go. The last one is left to the CPU, which then
+ * falls out of the loop as it always does. */
+
+/*************
+ ** private **
+ *************/
+
+typedef struct Pdp11CpuCopyLoop {
+    bool is_fill;
+    unsigned src, dst, counter;  // registers, `src` unused for a fill
+    uint32_t time;               // of a single iteration
+} Pdp11CpuCopyLoop;
+
+static bool pdp11_cpu_copy_loop_find(
+    Pdp11Cpu *const self,
+    uint16_t const pc,
+    Pdp11CpuCopyLoop *const out
+) {
+    uint16_t encoded, sob_encoded;
+    if (unibus_cpu_dati(self->_unibus, pc, &encoded) != Ok ||
+        unibus_cpu_dati(self->_unibus, pc + 2, &sob_encoded) != Ok)
+        return false;
+    Pdp11CpuDecoded const *const decoded = pdp11_cpu_decoded + encoded;
+    Pdp11CpuDecoded const *const sob = pdp11_cpu_decoded + sob_encoded;
+    if (sob->op != PDP11_CPU_OP_SOB || sob->instr.u.sob.off != 2) return false;
+
+    // NOTE both operands have to be `(Rn)+`
+    unsigned src = 020, dst;
+    switch (decoded->op) {
+    case PDP11_CPU_OP_MOV:
+        src = decoded->instr.u.oo.o0, dst = decoded->instr.u.oo.o1;
+        break;
+    case PDP11_CPU_OP_CLR: dst = decoded->instr.u.o.o; break;
+    default: return false;
+    }
+    if (BITS(src, 3, 5) != 2 || BITS(dst, 3, 5) != 2) return false;
+
+    *out = (Pdp11CpuCopyLoop){
+        .is_fill = decoded->op == PDP11_CPU_OP_CLR,
+        .src = BITS(src, 0, 2),
+        .dst = BITS(dst, 0, 2),
+        .counter = sob->instr.u.sob.r,
+        .time = decoded->time + sob->time,
+    };
+    // NOTE the registers have to be distinct, and none of them PC
+    return out->dst != 7 && out->counter != 7 && out->dst != out->counter &&
+           (out->is_fill ||
+            (out->src != 7 && out->src != out->dst &&
+             out->src != out->counter));
+}
+
+// Whether the `count` words from `addr` on are all in the directly accessed
+// RAM.
+static bool pdp11_cpu_copy_is_ram(
+    Pdp11Cpu const *const self,
+    uint16_t const addr,
+    uint64_t const count
+) {
+    return (addr & 1) == 0 && addr + 2 * count <= self->_ram_size;
+}
+
+/************
+ ** public **
+ ************/
+
+void pdp11_cpu_skip_copy_loop(Pdp11Cpu *const self) {
+    uint16_t const pc = pdp11_cpu_pc(self);
+    Pdp11CpuCopyLoop loop;
+    // NOTE only from the top of the loop, which a batch ends at often enough
+    if (!pdp11_cpu_copy_loop_find(self, pc, &loop)) return;
+
+    // NOTE `0` counts down the whole 65536 iterations
+    uint16_t const counter = pdp11_cpu_rx(self, loop.counter);
+    uint64_t count = (counter == 0 ? UINT16_MAX + 1 : counter) - 1;
+    // NOTE and only what ends before the next event
+    uint64_t const until = pdp11_cpu_iters_before_event(self, loop.time);
+    if (until < count) count = until;
+    uint64_t const instrs = pdp11_cpu_instrs_left(self) / 2;
+    if (instrs < count) count = instrs;
+    if (count == 0) return;
+
+    // NOTE anything else, I/O above all, is left to the CPU, as is a loop
+    // that would overwrite itself
+    uint16_t const src = pdp11_cpu_rx(self, loop.src),
+                   dst = pdp11_cpu_rx(self, loop.dst);
+    if (!pdp11_cpu_copy_is_ram(self, dst, count) ||
+        (!loop.is_fill && !pdp11_cpu_copy_is_ram(self, src, count)) ||
+        (dst < pc + 4 && pc < dst + 2 * count))
+        return;
+
+    uint16_t *const ram = (uint16_t *)self->_ram;
+    uint16_t last = 0;
+    if (loop.is_fill) {
+        memset(ram + (dst >> 1), 0, 2 * count);
+    } else {
+        last = ram[(src >> 1) + count - 1];
+        // NOTE a copy up into itself repeats what it has copied, word by word
+        if (dst <= src || dst >= src + 2 * count) {
+            memmove(ram + (dst >> 1), ram + (src >> 1), 2 * count);
+        } else {
+            for (uint64_t i = 0; i < count; i++)
+                ram[(dst >> 1) + i] = ram[(src >> 1) + i];
+            last = ram[(src >> 1) + count - 1];
+        }
+        pdp11_cpu_rx(self, loop.src) = src + 2 * count;
+    }
+    pdp11_cpu_note_write_run(self, dst, dst + 2 * count);
+    pdp11_cpu_rx(self, loop.dst) = dst + 2 * count;
+    pdp11_cpu_rx(self, loop.counter) = counter - count;
+
+    // NOTE as the last `mov` or `clr` run has left them
+    pdp11_cpu_sync_flags(self);
+    self->_psw.flags.n = last >> 15;
+    self->_psw.flags.z = last == 0;
+    self->_psw.flags.v = false;
+    if (loop.is_fill) self->_psw.flags.c = false;
+
+    uint64_t const skipped = count * loop.time;
+    pdp11_scheduler_advance(&self->_scheduler, skipped);
+    self->__instrs += 2 * count;
+    self->__copy_skipped_ns += skipped;
+}
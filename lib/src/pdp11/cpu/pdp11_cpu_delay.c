@@ -0,0 +1,93 @@
+#include "pdp11/cpu/pdp11_cpu_engine.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pdp11/unibus/unibus.h"
+
+/* Delay loops only count a register down, as `sob R0, .` or `dec R0; bne .-2`
+ * do. Where one iteration leaves the counter, and the flags, is known in
+ * advance, so whole iterations are run in one go instead. The last one is left
+ * to the CPU, which then falls out of the loop as it always does. */
+
+/*************
+ ** private **
+ *************/
+
+typedef struct Pdp11CpuDelayLoop {
+    unsigned r;
+    bool sets_flags;  // NOTE `dec` does, `sob` does not
+    uint32_t time;    // of a single iteration
+} Pdp11CpuDelayLoop;
+
+static bool pdp11_cpu_delay_loop_find(
+    Pdp11Cpu *const self,
+    uint16_t const pc,
+    Pdp11CpuDelayLoop *const out
+) {
+    uint16_t encoded;
+    if (unibus_cpu_dati(self->_unibus, pc, &encoded) != Ok) return false;
+    Pdp11CpuDecoded const *const decoded = pdp11_cpu_decoded + encoded;
+
+    // sob Rn, .
+    if (decoded->op == PDP11_CPU_OP_SOB) {
+        if (decoded->instr.u.sob.off != 1 || decoded->instr.u.sob.r == 7)
+            return false;
+        *out = (Pdp11CpuDelayLoop){
+            .r = decoded->instr.u.sob.r,
+            .sets_flags = false,
+            .time = decoded->time,
+        };
+        return true;
+    }
+
+    // dec Rn; bne .-2
+    unsigned const o = decoded->instr.u.o.o;
+    uint16_t next_encoded;
+    if (decoded->op != PDP11_CPU_OP_DEC || o >> 3 != 0 || o == 7 ||
+        unibus_cpu_dati(self->_unibus, pc + 2, &next_encoded) != Ok ||
+        next_encoded != 0001376 /* bne .-2 */)
+        return false;
+    *out = (Pdp11CpuDelayLoop){
+        .r = o,
+        .sets_flags = true,
+        .time = decoded->time + pdp11_cpu_decoded[next_encoded].time,
+    };
+    return true;
+}
+
+/************
+ ** public **
+ ************/
+
+void pdp11_cpu_skip_delay_loop(Pdp11Cpu *const self) {
+    Pdp11CpuDelayLoop loop;
+    // NOTE only from the top of the loop, which a batch ends at often enough
+    if (!pdp11_cpu_delay_loop_find(self, pdp11_cpu_pc(self), &loop)) return;
+
+    // NOTE `0` counts down the whole 65536 iterations
+    uint16_t const counter = pdp11_cpu_rx(self, loop.r);
+    uint64_t count = (counter == 0 ? UINT16_MAX + 1 : counter) - 1;
+    // NOTE and only what ends before the next event
+    uint64_t const until = pdp11_cpu_iters_before_event(self, loop.time);
+    if (until < count) count = until;
+    uint64_t const instrs = pdp11_cpu_instrs_left(self) /
+                            (loop.sets_flags ? 2 : 1);
+    if (instrs < count) count = instrs;
+    if (count == 0) return;
+
+    uint16_t const res = counter - count;
+    pdp11_cpu_rx(self, loop.r) = res;
+    // NOTE as the last `dec` run has left them, `c` is kept
+    if (loop.sets_flags) {
+        pdp11_cpu_sync_flags(self);
+        self->_psw.flags.n = res >> 15;
+        self->_psw.flags.z = false;
+        self->_psw.flags.v = res == 077777;
+    }
+
+    uint64_t const skipped = count * loop.time;
+    pdp11_scheduler_advance(&self->_scheduler, skipped);
+    self->__instrs += loop.sets_flags ? 2 * count : count;
+    self->__delay_skipped_ns += skipped;
+}
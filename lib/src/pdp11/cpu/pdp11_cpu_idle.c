@@ -0,0 +1,197 @@
+#include "pdp11/cpu/pdp11_cpu_engine.h"
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bits.h"
+#include "pdp11/unibus/unibus.h"
+
+/* Idle loops are short backward loops that only test device registers, like
+ * `tstb (R1); bpl .-2` waiting for the reader. Nothing they do changes
+ * anything but the flags, and devices only change as their events fire, so
+ * once an iteration has gone round the loop, every later one goes round the
+ * same way until the next event. Those iterations are skipped in one go. */
+
+/*************
+ ** private **
+ *************/
+
+/* Whether operand `o`, with its index words at `*at`, leaves the registers
+ * alone and is either a register or in the I/O page. Moves `*at` past the
+ * index words. */
+static bool pdp11_cpu_idle_operand(
+    Pdp11Cpu *const self,
+    unsigned const o,
+    uint16_t *const at
+) {
+    unsigned const mode = BITS(o, 3, 5), r = BITS(o, 0, 2);
+    uint16_t addr, index;
+    switch (mode) {
+    case 0: return r != 7;
+    case 1:
+        if (r == 7) return false;
+        addr = pdp11_cpu_rx(self, r);
+        break;
+    case 2:
+        // NOTE an immediate, the only autoincrement that changes no register
+        if (r != 7) return false;
+        *at += 2;
+        return true;
+    case 3:
+        if (r != 7 || unibus_cpu_dati(self->_unibus, *at, &addr) != Ok)
+            return false;
+        *at += 2;
+        break;
+    case 6:
+        if (unibus_cpu_dati(self->_unibus, *at, &index) != Ok) return false;
+        *at += 2;
+        addr = index + (r == 7 ? *at : pdp11_cpu_rx(self, r));
+        break;
+    default: return false;
+    }
+    return addr >= UNIBUS_IO_PAGE_ADDR;
+}
+
+/* Whether the instruction at `*at` only reads device registers and sets the
+ * flags. Moves `*at` to the next instruction. */
+static bool pdp11_cpu_idle_is_pure(
+    Pdp11Cpu *const self,
+    Pdp11CpuDecoded const *const decoded,
+    uint16_t *const at
+) {
+    *at += 2;
+    switch (decoded->op) {
+    case PDP11_CPU_OP_TST:
+    case PDP11_CPU_OP_TSTB:
+        return pdp11_cpu_idle_operand(self, decoded->instr.u.o.o, at);
+    case PDP11_CPU_OP_CMP:
+    case PDP11_CPU_OP_CMPB:
+    case PDP11_CPU_OP_BIT:
+    case PDP11_CPU_OP_BITB:
+        return pdp11_cpu_idle_operand(self, decoded->instr.u.oo.o0, at) &&
+               pdp11_cpu_idle_operand(self, decoded->instr.u.oo.o1, at);
+    default: return false;
+    }
+}
+
+static bool pdp11_cpu_idle_is_branch(Pdp11CpuOp const op) {
+    switch (op) {
+    case PDP11_CPU_OP_BR:
+    case PDP11_CPU_OP_BNE_BE:
+    case PDP11_CPU_OP_BGE_BL:
+    case PDP11_CPU_OP_BG_BLE:
+    case PDP11_CPU_OP_BPL_BMI:
+    case PDP11_CPU_OP_BHI_BLOS:
+    case PDP11_CPU_OP_BVC_BVS:
+    case PDP11_CPU_OP_BCC_BCS: return true;
+    default: return false;
+    }
+}
+
+/* Finds the idle loop PC is in, which runs from `*out_start` to the branch
+ * back at `*out_branch`. */
+static bool pdp11_cpu_idle_loop_find(
+    Pdp11Cpu *const self,
+    uint16_t *const out_start,
+    uint16_t *const out_branch
+) {
+    uint16_t const pc = pdp11_cpu_pc(self);
+    uint16_t at = pc, encoded;
+    for (unsigned len = 0;; len++) {
+        if (len == PDP11_CPU_IDLE_LOOP_MAX_LEN ||
+            unibus_cpu_dati(self->_unibus, at, &encoded) != Ok)
+            return false;
+        Pdp11CpuDecoded const *const decoded = pdp11_cpu_decoded + encoded;
+        if (pdp11_cpu_idle_is_branch(decoded->op)) {
+            *out_branch = at;
+            *out_start =
+                at + 2 + 2 * (int16_t)(int8_t)decoded->instr.u.branch.off;
+            break;
+        }
+        if (!pdp11_cpu_idle_is_pure(self, decoded, &at)) return false;
+    }
+    if (*out_start > pc) return false;
+
+    // NOTE the part before PC has to be pure as well, and end at the branch
+    at = *out_start;
+    for (unsigned len = 0; at < *out_branch; len++) {
+        if (len == PDP11_CPU_IDLE_LOOP_MAX_LEN ||
+            unibus_cpu_dati(self->_unibus, at, &encoded) != Ok ||
+            !pdp11_cpu_idle_is_pure(self, pdp11_cpu_decoded + encoded, &at))
+            return false;
+    }
+    return at == *out_branch;
+}
+
+/* Runs the loop up to and including its branch, adding the time it takes to
+ * `*ns`, and the instructions it runs to `*instrs`. Returns whether the branch
+ * has gone back to the start without an event firing or anything else needing
+ * the CPU meanwhile. */
+static bool pdp11_cpu_idle_loop_run(
+    Pdp11Cpu *const self,
+    uint16_t const start,
+    uint16_t const branch,
+    uint64_t *const ns,
+    unsigned *const instrs
+) {
+    for (unsigned len = 0; len <= PDP11_CPU_IDLE_LOOP_MAX_LEN; len++) {
+        uint16_t const pc = pdp11_cpu_pc(self);
+        Pdp11CpuDecoded const *const decoded =
+            pdp11_cpu_decoded + pdp11_cpu_fetch(self);
+        decoded->exec(self, decoded->instr);
+        pdp11_scheduler_advance(&self->_scheduler, decoded->time);
+        *ns += decoded->time;
+        ++*instrs;
+
+        if (pdp11_cpu_needs_attention(self) ||
+            self->_state != PDP11_CPU_STATE_RUN ||
+            pdp11_cpu_time(self) >= pdp11_scheduler_next(&self->_scheduler))
+            return false;
+        if (pc == branch) return pdp11_cpu_pc(self) == start;
+    }
+    return false;
+}
+
+/************
+ ** public **
+ ************/
+
+void pdp11_cpu_skip_idle_loop(Pdp11Cpu *const self) {
+    uint16_t start, branch;
+    // NOTE with no event to wait for, the loop is left to spin, as it is with
+    // too few instructions left to go round it twice
+    if (pdp11_scheduler_next(&self->_scheduler) == PDP11_SCHEDULER_NEVER ||
+        pdp11_cpu_instrs_left(self) < 2 * (PDP11_CPU_IDLE_LOOP_MAX_LEN + 1) ||
+        !pdp11_cpu_idle_loop_find(self, &start, &branch))
+        return;
+
+    // NOTE a bus error in the loop is taken as the engines take it, the batch
+    // being over already
+    if (setjmp(self->__bus_error)) {
+        pdp11_cpu_take_bus_error(self);
+        pdp11_scheduler_advance(&self->_scheduler, PDP11_CPU_TRAP_NS);
+        return;
+    }
+
+    // NOTE the first run may start mid-loop, the second is a whole iteration,
+    // after which device registers read the same
+    uint64_t ns = 0;
+    unsigned instrs = 0;
+    if (!pdp11_cpu_idle_loop_run(self, start, branch, &ns, &instrs)) return;
+    ns = 0, instrs = 0;
+    if (!pdp11_cpu_idle_loop_run(self, start, branch, &ns, &instrs)) return;
+
+    // NOTE only whole iterations ending before the event are skipped, the CPU
+    // runs the rest itself, so that the event fires at the very instruction
+    // it would have, and not before pacing has slept off the skipped time,
+    // an event scheduled while going round included
+    uint64_t count = pdp11_cpu_iters_before_event(self, ns);
+    if (pdp11_cpu_instrs_left(self) / instrs < count)
+        count = pdp11_cpu_instrs_left(self) / instrs;
+    if (count == 0) return;
+    uint64_t const skipped = count * ns;
+    pdp11_scheduler_advance(&self->_scheduler, skipped);
+    self->__instrs += count * instrs;
+    self->__idle_skipped_ns += skipped;
+}
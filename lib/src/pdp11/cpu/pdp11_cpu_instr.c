@@ -106,3 +106,101 @@ Pdp11CpuInstr pdp11_cpu_instr(uint16_t const encoded) {
 
     return pdp11_cpu_instr_reserved();
 }
+
+Pdp11CpuOp pdp11_cpu_op(Pdp11CpuInstr const instr) {
+    switch (instr.type) {
+    case PDP11_CPU_INSTR_TYPE_OO:
+        switch (instr.u.oo.opcode) {
+        case 001: return PDP11_CPU_OP_MOV;
+        case 002: return PDP11_CPU_OP_CMP;
+        case 003: return PDP11_CPU_OP_BIT;
+        case 004: return PDP11_CPU_OP_BIC;
+        case 005: return PDP11_CPU_OP_BIS;
+        case 006: return PDP11_CPU_OP_ADD;
+        case 016: return PDP11_CPU_OP_SUB;
+        case 011: return PDP11_CPU_OP_MOVB;
+        case 012: return PDP11_CPU_OP_CMPB;
+        case 013: return PDP11_CPU_OP_BITB;
+        case 014: return PDP11_CPU_OP_BICB;
+        case 015: return PDP11_CPU_OP_BISB;
+        }
+        break;
+    case PDP11_CPU_INSTR_TYPE_RO:
+        switch (instr.u.ro.opcode) {
+        case 0070: return PDP11_CPU_OP_MUL;
+        case 0071: return PDP11_CPU_OP_DIV;
+        case 0072: return PDP11_CPU_OP_ASH;
+        case 0073: return PDP11_CPU_OP_ASHC;
+        case 0074: return PDP11_CPU_OP_XOR;
+        }
+        break;
+    case PDP11_CPU_INSTR_TYPE_O:
+        switch (instr.u.o.opcode) {
+        case 00003: return PDP11_CPU_OP_SWAB;
+        case 00050: return PDP11_CPU_OP_CLR;
+        case 00051: return PDP11_CPU_OP_COM;
+        case 00052: return PDP11_CPU_OP_INC;
+        case 00053: return PDP11_CPU_OP_DEC;
+        case 00054: return PDP11_CPU_OP_NEG;
+        case 00055: return PDP11_CPU_OP_ADC;
+        case 00056: return PDP11_CPU_OP_SBC;
+        case 00057: return PDP11_CPU_OP_TST;
+        case 00060: return PDP11_CPU_OP_ROR;
+        case 00061: return PDP11_CPU_OP_ROL;
+        case 00062: return PDP11_CPU_OP_ASR;
+        case 00063: return PDP11_CPU_OP_ASL;
+        case 00067: return PDP11_CPU_OP_SXT;
+        case 01050: return PDP11_CPU_OP_CLRB;
+        case 01051: return PDP11_CPU_OP_COMB;
+        case 01052: return PDP11_CPU_OP_INCB;
+        case 01053: return PDP11_CPU_OP_DECB;
+        case 01054: return PDP11_CPU_OP_NEGB;
+        case 01055: return PDP11_CPU_OP_ADCB;
+        case 01056: return PDP11_CPU_OP_SBCB;
+        case 01057: return PDP11_CPU_OP_TSTB;
+        case 01060: return PDP11_CPU_OP_RORB;
+        case 01061: return PDP11_CPU_OP_ROLB;
+        case 01062: return PDP11_CPU_OP_ASRB;
+        case 01063: return PDP11_CPU_OP_ASLB;
+        }
+        break;
+    case PDP11_CPU_INSTR_TYPE_BRANCH:
+        switch (instr.u.branch.opcode) {
+        case 0000: return assert(instr.u.branch.cond), PDP11_CPU_OP_BR;
+        case 0001: return PDP11_CPU_OP_BNE_BE;
+        case 0002: return PDP11_CPU_OP_BGE_BL;
+        case 0003: return PDP11_CPU_OP_BG_BLE;
+        case 0100: return PDP11_CPU_OP_BPL_BMI;
+        case 0101: return PDP11_CPU_OP_BHI_BLOS;
+        case 0102: return PDP11_CPU_OP_BVC_BVS;
+        case 0103: return PDP11_CPU_OP_BCC_BCS;
+        }
+        break;
+    case PDP11_CPU_INSTR_TYPE_R:
+        switch (instr.u.r.opcode) {
+        case 000020: return PDP11_CPU_OP_RTS;
+        case 000023: return PDP11_CPU_OP_SPL;
+        }
+        break;
+    case PDP11_CPU_INSTR_TYPE_SOB: return PDP11_CPU_OP_SOB;
+    case PDP11_CPU_INSTR_TYPE_JSR: return PDP11_CPU_OP_JSR;
+    case PDP11_CPU_INSTR_TYPE_JMP: return PDP11_CPU_OP_JMP;
+    case PDP11_CPU_INSTR_TYPE_MISC:
+        switch (instr.u.misc.opcode) {
+        case 0104000 ... 0104377: return PDP11_CPU_OP_EMT;
+        case 0104400 ... 0104777: return PDP11_CPU_OP_TRAP;
+        case 0000240 ... 0000277: return PDP11_CPU_OP_CLNZVC_SENZVC;
+        case 0006400 ... 0006477: return PDP11_CPU_OP_MARK;
+        case 0000006:
+        case 0000002: return PDP11_CPU_OP_RTI_RTT;
+        case 0000003: return PDP11_CPU_OP_BPT;
+        case 0000004: return PDP11_CPU_OP_IOT;
+        case 0000000: return PDP11_CPU_OP_HALT;
+        case 0000001: return PDP11_CPU_OP_WAIT;
+        case 0000005: return PDP11_CPU_OP_RESET;
+        }
+        break;
+    case PDP11_CPU_INSTR_TYPE_RESERVED: break;
+    }
+    return PDP11_CPU_OP_RESERVED;
+}
@@ -0,0 +1,1374 @@
+#include "pdp11/cpu/pdp11_cpu_engine.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <assert.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bits.h"
+
+/* x86-64 translation of hot blocks. A run of instructions is compiled as a
+ * whole, with R0-R6 held in host registers, the {nzvc} flags in host byte
+ * registers, and PC, which is known at every point of the run, in the code
+ * itself. Whatever the compiled code cannot do, it leaves to the interpreter,
+ * exiting right before the instruction: an access to anything but RAM, an odd
+ * word address, which would trap, and a write to code. Nothing is committed
+ * before the last such check of an instruction, so that the interpreter runs
+ * it again from scratch. A taken branch exits as well, unless it goes back to
+ * the start of the run, which is then run again without leaving the code as
+ * long as the batch has room for a whole pass, and nothing needs attention. */
+
+#define PDP11_CPU_JIT_CODE_SIZE (1024 * 1024)
+// NOTE generous upper bounds on the host code of a run, and on that of each
+// of its instructions, along with its exits
+#define PDP11_CPU_JIT_RUN_MAX_SIZE   (256)
+#define PDP11_CPU_JIT_INSTR_MAX_SIZE (1024)
+#define PDP11_CPU_JIT_MAX_EXITS      (12 * PDP11_CPU_BLOCK_MAX_LEN)
+#ifndef PDP11_CPU_JIT_MIN_LEN
+#define PDP11_CPU_JIT_MIN_LEN (4)
+#endif
+
+#if defined(__x86_64__)
+
+/*************
+ ** private **
+ *************/
+
+// What an operand is, as far as the compiled code goes.
+typedef enum Pdp11CpuJitOperandKind {
+    PDP11_CPU_JIT_O_NONE,
+    PDP11_CPU_JIT_O_REG,  // R0-R6
+    PDP11_CPU_JIT_O_MEM,  // any mode but `0`, on PC only `@#a`, `a` and `@a`
+    PDP11_CPU_JIT_O_IMM,  // `#n`
+} Pdp11CpuJitOperandKind;
+typedef struct Pdp11CpuJitOperand {
+    Pdp11CpuJitOperandKind kind;
+    uint8_t mode, r;
+    uint16_t word;  // where the index, or the value of `#n`, is
+} Pdp11CpuJitOperand;
+
+// How an instruction accesses its destination.
+typedef enum Pdp11CpuJitAccess {
+    PDP11_CPU_JIT_ACCESS_R,
+    PDP11_CPU_JIT_ACCESS_W,
+    PDP11_CPU_JIT_ACCESS_RMW,
+} Pdp11CpuJitAccess;
+
+// An instruction of a run, worked out before any code is emitted.
+typedef struct Pdp11CpuJitInstr {
+    Pdp11CpuDecoded const *decoded;
+    bool is_byte;
+    Pdp11CpuJitAccess access;
+    Pdp11CpuJitOperand src, dst;  // NOTE `src` is the register of `xor`
+    uint16_t pc, next_pc;
+    bool is_branch;
+    uint16_t target;  // where it goes when taken
+    uint32_t time;
+} Pdp11CpuJitInstr;
+
+// host registers
+enum {
+    PDP11_CPU_JIT_AX = 0,  // scratch, the address of a memory operand
+    PDP11_CPU_JIT_CX = 1,  // scratch, the destination
+    PDP11_CPU_JIT_DX = 2,
+    PDP11_CPU_JIT_BX = 3,
+    PDP11_CPU_JIT_BP = 5,  // scratch, the source
+    PDP11_CPU_JIT_SI = 6,  // the RAM
+    PDP11_CPU_JIT_DI = 7,  // the CPU
+    PDP11_CPU_JIT_R8 = 8,  // R0, the rest follow in order up to R6 in r14
+    PDP11_CPU_JIT_R15 = 15,  // the frame
+    // NOTE the high bytes, which only exist in instructions without a REX
+    PDP11_CPU_JIT_DH = 16 | 6,
+    PDP11_CPU_JIT_BH = 16 | 7,
+};
+// the flags, each held in a host byte register
+enum {
+    PDP11_CPU_JIT_C = 1 << 0,
+    PDP11_CPU_JIT_V = 1 << 1,
+    PDP11_CPU_JIT_Z = 1 << 2,
+    PDP11_CPU_JIT_N = 1 << 3,
+};
+static unsigned const pdp11_cpu_jit_flag_regs[] = {
+    PDP11_CPU_JIT_DH,
+    PDP11_CPU_JIT_DX,
+    PDP11_CPU_JIT_BH,
+    PDP11_CPU_JIT_BX,
+};
+// condition codes
+enum {
+    PDP11_CPU_JIT_ALWAYS = -1,
+    PDP11_CPU_JIT_CC_O = 0x0,
+    PDP11_CPU_JIT_CC_B = 0x2,
+    PDP11_CPU_JIT_CC_AE = 0x3,
+    PDP11_CPU_JIT_CC_Z = 0x4,
+    PDP11_CPU_JIT_CC_NZ = 0x5,
+    PDP11_CPU_JIT_CC_S = 0x8,
+    PDP11_CPU_JIT_CC_L = 0xC,
+};
+// `setcc` of each flag, in the order of `pdp11_cpu_jit_flag_regs`
+static uint8_t const pdp11_cpu_jit_flag_ccs[] = {
+    PDP11_CPU_JIT_CC_B,
+    PDP11_CPU_JIT_CC_O,
+    PDP11_CPU_JIT_CC_Z,
+    PDP11_CPU_JIT_CC_S,
+};
+
+// A register, or memory at `[reg + index + disp]`.
+typedef struct Pdp11CpuJitRm {
+    bool is_mem;
+    uint8_t reg;
+    int8_t index;  // `-1` for none
+    int32_t disp;
+} Pdp11CpuJitRm;
+
+// A way out of the code, back to the interpreter.
+typedef struct Pdp11CpuJitExit {
+    uint8_t *site;  // the `rel32` of the jump that takes it
+    uint8_t *stub;
+    uint16_t pc;
+    uint8_t done;  // instructions of the pass run by then
+    bool is_loop;  // back to the start of the run, for another pass
+} Pdp11CpuJitExit;
+
+typedef struct Pdp11CpuJitEmitter {
+    uint8_t *ptr;
+    uint16_t ram_size;
+
+    Pdp11CpuJitInstr const *instrs;
+    unsigned len;
+    unsigned k;  // the instruction being emitted
+    uint8_t regs;  // a bit per register of R0-R6 the run uses
+    uint32_t times[PDP11_CPU_BLOCK_MAX_LEN + 1];  // of the first `i` of them
+    uint8_t *pass;  // where a pass of the run starts
+
+    Pdp11CpuJitExit exits[PDP11_CPU_JIT_MAX_EXITS];
+    unsigned exit_count;
+    // NOTE the autoincrements and autodecrements of the instruction, made
+    // once nothing can exit anymore
+    struct {
+        uint8_t r;
+        int8_t delta;
+    } steps[2];
+    unsigned step_count;
+} Pdp11CpuJitEmitter;
+
+static inline unsigned pdp11_cpu_jit_host(unsigned const r) {
+    return PDP11_CPU_JIT_R8 + r;
+}
+static inline Pdp11CpuJitRm pdp11_cpu_jit_r(unsigned const reg) {
+    return (Pdp11CpuJitRm){.reg = reg, .index = -1};
+}
+static inline Pdp11CpuJitRm
+pdp11_cpu_jit_m(unsigned const base, int const index, int32_t const disp) {
+    return (Pdp11CpuJitRm){
+        .is_mem = true,
+        .reg = base,
+        .index = index,
+        .disp = disp,
+    };
+}
+
+// plan
+
+/* Works out the operand `o`, the index word of which, if any, is at `*addr`,
+ * moving `*addr` past it. Returns `false` if it is not supported. NOTE the
+ * index words are read as the code runs, the way the interpreter does, so
+ * that writing to them, which programs do, does not drop the code. */
+static bool pdp11_cpu_jit_plan_operand(
+    Pdp11Cpu *const self,
+    unsigned const o,
+    bool const is_written,
+    uint16_t *const addr,
+    Pdp11CpuJitOperand *const out
+) {
+    unsigned const mode = BITS(o, 3, 5), r = BITS(o, 0, 2);
+    *out = (Pdp11CpuJitOperand){
+        .kind = mode == 0 ? PDP11_CPU_JIT_O_REG : PDP11_CPU_JIT_O_MEM,
+        .mode = mode,
+        .r = r,
+    };
+    if (r == 7) {
+        if (mode == 2) out->kind = PDP11_CPU_JIT_O_IMM;
+        else if (mode != 3 && mode != 6 && mode != 7) return false;
+    }
+    if (r != 7 && mode < 6) return true;
+
+    out->word = *addr, *addr += 2;
+    return out->word < self->_ram_size &&
+           !(is_written && out->kind == PDP11_CPU_JIT_O_IMM);
+}
+
+static inline bool
+pdp11_cpu_jit_has_side_effect(Pdp11CpuJitOperand const *const o) {
+    return o->kind == PDP11_CPU_JIT_O_MEM && o->r != 7 && o->mode >= 2 &&
+           o->mode <= 5;
+}
+
+// Works out the instruction of `record`, returns `false` if it is not
+// supported.
+static bool pdp11_cpu_jit_plan(
+    Pdp11Cpu *const self,
+    Pdp11CpuBlockRecord const *const record,
+    Pdp11CpuJitInstr *const out
+) {
+    Pdp11CpuDecoded const *const decoded = pdp11_cpu_decoded + record->encoded;
+    Pdp11CpuInstr const instr = decoded->instr;
+    *out = (Pdp11CpuJitInstr){
+        .decoded = decoded,
+        .pc = record->pc,
+        .time = record->time,
+    };
+    uint16_t addr = record->pc + 2;
+
+    unsigned src = 0, dst;
+    bool has_src = true;
+    switch (decoded->op) {
+    case PDP11_CPU_OP_MOVB:
+    case PDP11_CPU_OP_CMPB:
+    case PDP11_CPU_OP_BITB:
+    case PDP11_CPU_OP_BICB:
+    case PDP11_CPU_OP_BISB:
+    case PDP11_CPU_OP_CLRB:
+    case PDP11_CPU_OP_COMB:
+    case PDP11_CPU_OP_INCB:
+    case PDP11_CPU_OP_DECB:
+    case PDP11_CPU_OP_NEGB:
+    case PDP11_CPU_OP_ADCB:
+    case PDP11_CPU_OP_SBCB:
+    case PDP11_CPU_OP_TSTB:
+    case PDP11_CPU_OP_RORB:
+    case PDP11_CPU_OP_ROLB:
+    case PDP11_CPU_OP_ASRB:
+    case PDP11_CPU_OP_ASLB: out->is_byte = true; break;
+    default: break;
+    }
+
+    switch (decoded->op) {
+    case PDP11_CPU_OP_MOVB:
+    case PDP11_CPU_OP_CMPB:
+    case PDP11_CPU_OP_BITB:
+    case PDP11_CPU_OP_BICB:
+    case PDP11_CPU_OP_BISB:
+    case PDP11_CPU_OP_MOV:
+    case PDP11_CPU_OP_CMP:
+    case PDP11_CPU_OP_BIT:
+    case PDP11_CPU_OP_BIC:
+    case PDP11_CPU_OP_BIS:
+    case PDP11_CPU_OP_ADD:
+    case PDP11_CPU_OP_SUB: src = instr.u.oo.o0, dst = instr.u.oo.o1; break;
+    case PDP11_CPU_OP_XOR: {
+        if (instr.u.ro.r == 7) return false;
+        src = instr.u.ro.r, dst = instr.u.ro.o;
+    } break;
+
+    case PDP11_CPU_OP_CLRB:
+    case PDP11_CPU_OP_COMB:
+    case PDP11_CPU_OP_INCB:
+    case PDP11_CPU_OP_DECB:
+    case PDP11_CPU_OP_NEGB:
+    case PDP11_CPU_OP_ADCB:
+    case PDP11_CPU_OP_SBCB:
+    case PDP11_CPU_OP_TSTB:
+    case PDP11_CPU_OP_RORB:
+    case PDP11_CPU_OP_ROLB:
+    case PDP11_CPU_OP_ASRB:
+    case PDP11_CPU_OP_ASLB:
+    case PDP11_CPU_OP_SWAB:
+    case PDP11_CPU_OP_CLR:
+    case PDP11_CPU_OP_COM:
+    case PDP11_CPU_OP_INC:
+    case PDP11_CPU_OP_DEC:
+    case PDP11_CPU_OP_NEG:
+    case PDP11_CPU_OP_ADC:
+    case PDP11_CPU_OP_SBC:
+    case PDP11_CPU_OP_TST:
+    case PDP11_CPU_OP_ROR:
+    case PDP11_CPU_OP_ROL:
+    case PDP11_CPU_OP_ASR:
+    case PDP11_CPU_OP_ASL:
+    case PDP11_CPU_OP_SXT: has_src = false, dst = instr.u.o.o; break;
+
+    case PDP11_CPU_OP_BR:
+    case PDP11_CPU_OP_BNE_BE:
+    case PDP11_CPU_OP_BGE_BL:
+    case PDP11_CPU_OP_BG_BLE:
+    case PDP11_CPU_OP_BPL_BMI:
+    case PDP11_CPU_OP_BHI_BLOS:
+    case PDP11_CPU_OP_BVC_BVS:
+    case PDP11_CPU_OP_BCC_BCS: {
+        out->is_branch = true, out->next_pc = addr;
+        out->target = addr + 2 * (int16_t)(int8_t)instr.u.branch.off;
+        return true;
+    }
+    case PDP11_CPU_OP_SOB: {
+        out->is_branch = true, out->next_pc = addr;
+        out->target = addr - 2 * instr.u.sob.off;
+        return instr.u.sob.r != 7;
+    }
+    case PDP11_CPU_OP_CLNZVC_SENZVC: return out->next_pc = addr, true;
+
+    default: return false;
+    }
+
+    switch (decoded->op) {
+    case PDP11_CPU_OP_MOV:
+    case PDP11_CPU_OP_MOVB:
+    case PDP11_CPU_OP_CLR:
+    case PDP11_CPU_OP_CLRB:
+    case PDP11_CPU_OP_SXT: out->access = PDP11_CPU_JIT_ACCESS_W; break;
+    case PDP11_CPU_OP_CMP:
+    case PDP11_CPU_OP_CMPB:
+    case PDP11_CPU_OP_BIT:
+    case PDP11_CPU_OP_BITB:
+    case PDP11_CPU_OP_TST:
+    case PDP11_CPU_OP_TSTB: out->access = PDP11_CPU_JIT_ACCESS_R; break;
+    default: out->access = PDP11_CPU_JIT_ACCESS_RMW; break;
+    }
+
+    if (decoded->op == PDP11_CPU_OP_XOR)
+        out->src = (Pdp11CpuJitOperand){
+            .kind = PDP11_CPU_JIT_O_REG,
+            .r = src,
+        };
+    else if (has_src &&
+             !pdp11_cpu_jit_plan_operand(self, src, false, &addr, &out->src))
+        return false;
+    if (!pdp11_cpu_jit_plan_operand(
+            self,
+            dst,
+            out->access != PDP11_CPU_JIT_ACCESS_R,
+            &addr,
+            &out->dst
+        ))
+        return false;
+    out->next_pc = addr;
+
+    // NOTE the interpreter resolves the destination before it reads the
+    // source, which only matters when the two share a stepped register
+    bool const is_shared = out->src.kind != PDP11_CPU_JIT_O_NONE &&
+                           out->src.r == out->dst.r &&
+                           (out->src.kind == PDP11_CPU_JIT_O_REG ||
+                            out->src.kind == PDP11_CPU_JIT_O_MEM) &&
+                           (out->dst.kind == PDP11_CPU_JIT_O_REG ||
+                            out->dst.kind == PDP11_CPU_JIT_O_MEM);
+    return !is_shared || (!pdp11_cpu_jit_has_side_effect(&out->src) &&
+                          !pdp11_cpu_jit_has_side_effect(&out->dst));
+}
+
+// encoding
+
+static inline void pdp11_cpu_jit_emit(Pdp11CpuJitEmitter *const self, int b) {
+    *self->ptr++ = b;
+}
+static void pdp11_cpu_jit_emit_imm(
+    Pdp11CpuJitEmitter *const self,
+    unsigned const size,
+    uint32_t const value
+) {
+    for (unsigned i = 0; i < size; i++)
+        pdp11_cpu_jit_emit(self, value >> 8 * i);
+}
+
+/* Emits `opcode`, `size` bytes wide, with a ModRM for `reg`, or for the opcode
+ * extension `reg` if `is_ext`, and for `rm`. A two byte opcode has its `0x0F`
+ * in the high byte. */
+static void pdp11_cpu_jit_emit_modrm(
+    Pdp11CpuJitEmitter *const self,
+    unsigned const size,
+    unsigned const opcode,
+    unsigned const reg,
+    bool const is_ext,
+    Pdp11CpuJitRm const rm
+) {
+    bool const is_rm_byte =
+        size == 1 || opcode == 0x0FB6 || opcode == 0x0FBE;
+    bool const is_high =
+        (!is_ext && reg >= 16) || (!rm.is_mem && rm.reg >= 16);
+    // NOTE without a REX, the byte registers 4-7 are the high bytes
+    bool const is_low_byte =
+        (size == 1 && !is_ext && reg >= 4 && reg < 8) ||
+        (is_rm_byte && !rm.is_mem && rm.reg >= 4 && rm.reg < 8);
+    unsigned const rex = (size == 8) << 3 |
+                         (!is_ext && reg >= 8 && reg < 16) << 2 |
+                         (rm.is_mem && rm.index >= 8) << 1 |
+                         (rm.reg >= 8 && rm.reg < 16);
+    assert(!is_high || (rex == 0 && !is_low_byte));
+
+    if (size == 2) pdp11_cpu_jit_emit(self, 0x66);
+    if (rex || is_low_byte) pdp11_cpu_jit_emit(self, 0x40 | rex);
+    if (opcode > 0xFF) pdp11_cpu_jit_emit(self, opcode >> 8);
+    pdp11_cpu_jit_emit(self, opcode);
+
+    unsigned const field = (reg & 7) << 3;
+    if (!rm.is_mem)
+        return pdp11_cpu_jit_emit(self, 0xC0 | field | (rm.reg & 7));
+    unsigned const base = rm.reg & 7;
+    unsigned const mod = rm.disp == 0 && base != 5      ? 0
+                       : rm.disp == (int8_t)rm.disp ? 1
+                                                    : 2;
+    if (rm.index < 0 && base != 4) {
+        pdp11_cpu_jit_emit(self, mod << 6 | field | base);
+    } else {
+        pdp11_cpu_jit_emit(self, mod << 6 | field | 4);
+        pdp11_cpu_jit_emit(self, (rm.index < 0 ? 4 : rm.index & 7) << 3 | base);
+    }
+    if (mod != 0) pdp11_cpu_jit_emit_imm(self, mod == 1 ? 1 : 4, rm.disp);
+}
+// `op r/m, reg` or `op reg, r/m`, whichever `opcode` is
+static inline void pdp11_cpu_jit_emit_rm(
+    Pdp11CpuJitEmitter *const self,
+    unsigned const size,
+    unsigned const opcode,
+    unsigned const reg,
+    Pdp11CpuJitRm const rm
+) {
+    pdp11_cpu_jit_emit_modrm(self, size, opcode, reg, false, rm);
+}
+// one of the `op r/m` groups, `ext` picking the operation
+static inline void pdp11_cpu_jit_emit_ext(
+    Pdp11CpuJitEmitter *const self,
+    unsigned const size,
+    unsigned const opcode,
+    unsigned const ext,
+    Pdp11CpuJitRm const rm
+) {
+    pdp11_cpu_jit_emit_modrm(self, size, opcode, ext, true, rm);
+}
+
+// Emits a `jcc`, or a `jmp` for `PDP11_CPU_JIT_ALWAYS`, returns its `rel32`.
+static uint8_t *
+pdp11_cpu_jit_emit_jump(Pdp11CpuJitEmitter *const self, int const cc) {
+    if (cc == PDP11_CPU_JIT_ALWAYS) {
+        pdp11_cpu_jit_emit(self, 0xE9);
+    } else {
+        pdp11_cpu_jit_emit(self, 0x0F);
+        pdp11_cpu_jit_emit(self, 0x80 | cc);
+    }
+    uint8_t *const site = self->ptr;
+    pdp11_cpu_jit_emit_imm(self, 4, 0);
+    return site;
+}
+static void
+pdp11_cpu_jit_patch(uint8_t *const site, uint8_t const *const target) {
+    int32_t const rel = target - (site + 4);
+    memcpy(site, &rel, sizeof(rel));
+}
+
+// exits
+
+static void pdp11_cpu_jit_emit_exit(
+    Pdp11CpuJitEmitter *const self,
+    int const cc,
+    unsigned const done,
+    uint16_t const pc,
+    bool const is_loop
+) {
+    assert(self->exit_count < PDP11_CPU_JIT_MAX_EXITS);
+    self->exits[self->exit_count++] = (Pdp11CpuJitExit){
+        .site = pdp11_cpu_jit_emit_jump(self, cc),
+        .pc = pc,
+        .done = done,
+        .is_loop = is_loop,
+    };
+}
+// Exits right before the instruction being emitted, if `cc`.
+static void pdp11_cpu_jit_emit_bail(Pdp11CpuJitEmitter *const self, int cc) {
+    pdp11_cpu_jit_emit_exit(
+        self,
+        cc,
+        self->k,
+        self->instrs[self->k].pc,
+        false
+    );
+}
+
+// Takes the first `done` instructions of a pass off the frame.
+static void
+pdp11_cpu_jit_emit_spend(Pdp11CpuJitEmitter *const self, unsigned const done) {
+    if (done == 0) return;
+    pdp11_cpu_jit_emit_ext(
+        self,
+        4,
+        0x81,
+        5,
+        pdp11_cpu_jit_m(PDP11_CPU_JIT_R15, -1, offsetof(Pdp11CpuJitFrame, ns))
+    );
+    pdp11_cpu_jit_emit_imm(self, 4, self->times[done]);
+    pdp11_cpu_jit_emit_ext(
+        self,
+        4,
+        0x83,
+        5,
+        pdp11_cpu_jit_m(
+            PDP11_CPU_JIT_R15,
+            -1,
+            offsetof(Pdp11CpuJitFrame, instrs)
+        )
+    );
+    pdp11_cpu_jit_emit_imm(self, 1, done);
+}
+static void pdp11_cpu_jit_emit_leave(
+    Pdp11CpuJitEmitter *const self,
+    uint16_t const pc,
+    uint8_t const *const epilogue
+) {
+    pdp11_cpu_jit_emit(self, 0xB8);  // mov eax, imm32
+    pdp11_cpu_jit_emit_imm(self, 4, pc);
+    pdp11_cpu_jit_patch(
+        pdp11_cpu_jit_emit_jump(self, PDP11_CPU_JIT_ALWAYS),
+        epilogue
+    );
+}
+
+static void pdp11_cpu_jit_emit_exits(
+    Pdp11CpuJitEmitter *const self,
+    uint8_t const *const epilogue
+) {
+    for (unsigned i = 0; i < self->exit_count; i++) {
+        Pdp11CpuJitExit *const exit = self->exits + i;
+        // NOTE the exits to the same place share their stub
+        unsigned j = 0;
+        while (j < i && (self->exits[j].pc != exit->pc ||
+                         self->exits[j].done != exit->done ||
+                         self->exits[j].is_loop != exit->is_loop))
+            j++;
+        exit->stub = j < i ? self->exits[j].stub : self->ptr;
+        pdp11_cpu_jit_patch(exit->site, exit->stub);
+        if (j < i) continue;
+
+        pdp11_cpu_jit_emit_spend(self, exit->done);
+        if (exit->is_loop) {
+            // NOTE goes for another pass only if the interpreter would have
+            // run the whole of it as well
+            uint8_t *outs[3];
+            pdp11_cpu_jit_emit_ext(
+                self,
+                4,
+                0x81,
+                7,
+                pdp11_cpu_jit_m(
+                    PDP11_CPU_JIT_R15,
+                    -1,
+                    offsetof(Pdp11CpuJitFrame, ns)
+                )
+            );
+            pdp11_cpu_jit_emit_imm(self, 4, self->times[self->len]);
+            outs[0] = pdp11_cpu_jit_emit_jump(self, PDP11_CPU_JIT_CC_L);
+            pdp11_cpu_jit_emit_ext(
+                self,
+                4,
+                0x83,
+                7,
+                pdp11_cpu_jit_m(
+                    PDP11_CPU_JIT_R15,
+                    -1,
+                    offsetof(Pdp11CpuJitFrame, instrs)
+                )
+            );
+            pdp11_cpu_jit_emit_imm(self, 1, self->len);
+            outs[1] = pdp11_cpu_jit_emit_jump(self, PDP11_CPU_JIT_CC_B);
+            pdp11_cpu_jit_emit_ext(
+                self,
+                1,
+                0x80,
+                7,
+                pdp11_cpu_jit_m(
+                    PDP11_CPU_JIT_DI,
+                    -1,
+                    offsetof(Pdp11Cpu, __attention)
+                )
+            );
+            pdp11_cpu_jit_emit_imm(self, 1, 0);
+            outs[2] = pdp11_cpu_jit_emit_jump(self, PDP11_CPU_JIT_CC_NZ);
+            pdp11_cpu_jit_patch(
+                pdp11_cpu_jit_emit_jump(self, PDP11_CPU_JIT_ALWAYS),
+                self->pass
+            );
+            for (unsigned o = 0; o < lenof(outs); o++)
+                pdp11_cpu_jit_patch(outs[o], self->ptr);
+        }
+        pdp11_cpu_jit_emit_leave(self, exit->pc, epilogue);
+    }
+}
+
+// flags
+
+// Takes `flags` from the host flags, as the last host instruction has set
+// them.
+static void
+pdp11_cpu_jit_emit_flags(Pdp11CpuJitEmitter *const self, unsigned const flags) {
+    for (unsigned i = lenof(pdp11_cpu_jit_flag_regs); i-- > 0;)
+        if (flags >> i & 1)
+            pdp11_cpu_jit_emit_ext(
+                self,
+                1,
+                0x0F90 | pdp11_cpu_jit_flag_ccs[i],
+                0,
+                pdp11_cpu_jit_r(pdp11_cpu_jit_flag_regs[i])
+            );
+}
+static void pdp11_cpu_jit_emit_set_flags(
+    Pdp11CpuJitEmitter *const self,
+    unsigned const flags,
+    bool const value
+) {
+    for (unsigned i = lenof(pdp11_cpu_jit_flag_regs); i-- > 0;)
+        if (flags >> i & 1) {
+            pdp11_cpu_jit_emit_ext(
+                self,
+                1,
+                0xC6,
+                0,
+                pdp11_cpu_jit_r(pdp11_cpu_jit_flag_regs[i])
+            );
+            pdp11_cpu_jit_emit_imm(self, 1, value);
+        }
+}
+// V as N ^ C, the way the shifts and rotates set it
+static void pdp11_cpu_jit_emit_v_of_shift(Pdp11CpuJitEmitter *const self) {
+    pdp11_cpu_jit_emit_rm(
+        self,
+        1,
+        0x88,
+        PDP11_CPU_JIT_BX,
+        pdp11_cpu_jit_r(PDP11_CPU_JIT_DX)
+    );
+    pdp11_cpu_jit_emit_rm(
+        self,
+        1,
+        0x30,
+        PDP11_CPU_JIT_DH,
+        pdp11_cpu_jit_r(PDP11_CPU_JIT_DX)
+    );
+}
+// CF as C, for the instructions that take it in
+static void pdp11_cpu_jit_emit_load_c(Pdp11CpuJitEmitter *const self) {
+    pdp11_cpu_jit_emit_ext(
+        self,
+        4,
+        0x0FBA,
+        4,
+        pdp11_cpu_jit_r(PDP11_CPU_JIT_DX)
+    );
+    pdp11_cpu_jit_emit_imm(self, 1, 8);
+}
+
+// operands
+
+// Exits unless the address in eax is in RAM and, for a word, even.
+static void
+pdp11_cpu_jit_emit_check(Pdp11CpuJitEmitter *const self, bool const is_byte) {
+    pdp11_cpu_jit_emit_ext(self, 4, 0x81, 7, pdp11_cpu_jit_r(PDP11_CPU_JIT_AX));
+    pdp11_cpu_jit_emit_imm(self, 4, self->ram_size);
+    pdp11_cpu_jit_emit_bail(self, PDP11_CPU_JIT_CC_AE);
+    if (is_byte) return;
+    pdp11_cpu_jit_emit_ext(self, 1, 0xF6, 0, pdp11_cpu_jit_r(PDP11_CPU_JIT_AX));
+    pdp11_cpu_jit_emit_imm(self, 1, 1);
+    pdp11_cpu_jit_emit_bail(self, PDP11_CPU_JIT_CC_NZ);
+}
+// Exits if the word at the address in eax has been decoded, the interpreter
+// then takes care of dropping it.
+static void pdp11_cpu_jit_emit_check_code(Pdp11CpuJitEmitter *const self) {
+    pdp11_cpu_jit_emit_rm(
+        self,
+        4,
+        0x89,
+        PDP11_CPU_JIT_AX,
+        pdp11_cpu_jit_r(PDP11_CPU_JIT_CX)
+    );
+    pdp11_cpu_jit_emit_ext(self, 4, 0xD1, 5, pdp11_cpu_jit_r(PDP11_CPU_JIT_CX));
+    pdp11_cpu_jit_emit_rm(
+        self,
+        4,
+        0x0FA3,
+        PDP11_CPU_JIT_CX,
+        pdp11_cpu_jit_m(
+            PDP11_CPU_JIT_DI,
+            -1,
+            offsetof(Pdp11Cpu, __is_code_word)
+        )
+    );
+    pdp11_cpu_jit_emit_bail(self, PDP11_CPU_JIT_CC_B);
+}
+
+/* Emits whatever finds where the operand is, exiting if the compiled code
+ * cannot access it. Returns the host register it is in, or the RAM it is at.
+ * Not for `PDP11_CPU_JIT_O_IMM`. */
+static Pdp11CpuJitRm pdp11_cpu_jit_emit_resolve(
+    Pdp11CpuJitEmitter *const self,
+    Pdp11CpuJitOperand const *const o,
+    bool const is_byte,
+    bool const is_written
+) {
+    if (o->kind == PDP11_CPU_JIT_O_REG)
+        return pdp11_cpu_jit_r(pdp11_cpu_jit_host(o->r));
+
+    Pdp11CpuJitRm const ax = pdp11_cpu_jit_r(PDP11_CPU_JIT_AX);
+    Pdp11CpuJitRm const index = pdp11_cpu_jit_m(PDP11_CPU_JIT_SI, -1, o->word);
+    bool is_deferred;
+    if (o->r == 7) {
+        // NOTE PC is known here, it points right past the index word
+        pdp11_cpu_jit_emit_rm(self, 4, 0x0FB7, PDP11_CPU_JIT_AX, index);
+        if (o->mode != 3) {
+            pdp11_cpu_jit_emit_ext(self, 2, 0x81, 0, ax);
+            pdp11_cpu_jit_emit_imm(self, 2, o->word + 2);
+        }
+        is_deferred = o->mode == 7;
+    } else {
+        unsigned const host = pdp11_cpu_jit_host(o->r);
+        is_deferred = o->mode >= 3 && o->mode & 1;
+        // NOTE byte autoincrement and autodecrement still step SP by words
+        unsigned const step = is_byte && !is_deferred && o->r < 6 ? 1 : 2;
+
+        pdp11_cpu_jit_emit_rm(
+            self,
+            4,
+            0x8B,
+            PDP11_CPU_JIT_AX,
+            pdp11_cpu_jit_r(host)
+        );
+        if (o->mode == 4 || o->mode == 5) {
+            pdp11_cpu_jit_emit_ext(self, 2, 0x83, 5, ax);
+            pdp11_cpu_jit_emit_imm(self, 1, step);
+        } else if (o->mode >= 6) {
+            pdp11_cpu_jit_emit_rm(self, 2, 0x03, PDP11_CPU_JIT_AX, index);
+        }
+        if (o->mode >= 2 && o->mode <= 5) {
+            assert(self->step_count < lenof(self->steps));
+            self->steps[self->step_count].r = o->r;
+            self->steps[self->step_count++].delta =
+                o->mode <= 3 ? step : -step;
+        }
+    }
+    if (is_deferred) {
+        pdp11_cpu_jit_emit_check(self, false);
+        pdp11_cpu_jit_emit_rm(
+            self,
+            4,
+            0x0FB7,
+            PDP11_CPU_JIT_AX,
+            pdp11_cpu_jit_m(PDP11_CPU_JIT_SI, PDP11_CPU_JIT_AX, 0)
+        );
+    }
+
+    pdp11_cpu_jit_emit_check(self, is_byte);
+    if (is_written) pdp11_cpu_jit_emit_check_code(self);
+    return pdp11_cpu_jit_m(PDP11_CPU_JIT_SI, PDP11_CPU_JIT_AX, 0);
+}
+// Gets the value of the operand at `loc` into a host register, `reg` unless
+// it is in one already, and returns it.
+static unsigned pdp11_cpu_jit_emit_load(
+    Pdp11CpuJitEmitter *const self,
+    Pdp11CpuJitOperand const *const o,
+    Pdp11CpuJitRm const loc,
+    bool const is_byte,
+    unsigned const reg
+) {
+    if (o->kind != PDP11_CPU_JIT_O_IMM && !loc.is_mem) return loc.reg;
+    pdp11_cpu_jit_emit_rm(
+        self,
+        4,
+        is_byte ? 0x0FB6 : 0x0FB7,
+        reg,
+        o->kind == PDP11_CPU_JIT_O_IMM
+            ? pdp11_cpu_jit_m(PDP11_CPU_JIT_SI, -1, o->word)
+            : loc
+    );
+    return reg;
+}
+static void pdp11_cpu_jit_emit_store(
+    Pdp11CpuJitEmitter *const self,
+    Pdp11CpuJitRm const loc,
+    bool const is_byte,
+    unsigned const reg
+) {
+    if (!loc.is_mem && loc.reg == reg) return;
+    pdp11_cpu_jit_emit_rm(
+        self,
+        is_byte ? 1 : 2,
+        is_byte ? 0x88 : 0x89,
+        reg,
+        loc
+    );
+}
+
+// instructions
+
+static void pdp11_cpu_jit_emit_branch(Pdp11CpuJitEmitter *const self) {
+    Pdp11CpuJitInstr const *const instr = self->instrs + self->k;
+    Pdp11CpuInstr const decoded = instr->decoded->instr;
+    Pdp11CpuJitRm const al = pdp11_cpu_jit_r(PDP11_CPU_JIT_AX);
+
+    int cc = decoded.u.branch.cond ? PDP11_CPU_JIT_CC_NZ : PDP11_CPU_JIT_CC_Z;
+    unsigned flag = 0;
+    switch (instr->decoded->op) {
+    case PDP11_CPU_OP_BR: cc = PDP11_CPU_JIT_ALWAYS; break;
+    case PDP11_CPU_OP_SOB: {
+        pdp11_cpu_jit_emit_ext(
+            self,
+            2,
+            0xFF,
+            1,
+            pdp11_cpu_jit_r(pdp11_cpu_jit_host(decoded.u.sob.r))
+        );
+        cc = PDP11_CPU_JIT_CC_NZ;
+    } break;
+    case PDP11_CPU_OP_BNE_BE: flag = PDP11_CPU_JIT_BH; break;
+    case PDP11_CPU_OP_BPL_BMI: flag = PDP11_CPU_JIT_BX; break;
+    case PDP11_CPU_OP_BVC_BVS: flag = PDP11_CPU_JIT_DX; break;
+    case PDP11_CPU_OP_BCC_BCS: flag = PDP11_CPU_JIT_DH; break;
+    case PDP11_CPU_OP_BGE_BL:
+    case PDP11_CPU_OP_BG_BLE: {
+        pdp11_cpu_jit_emit_rm(self, 1, 0x88, PDP11_CPU_JIT_BX, al);
+        pdp11_cpu_jit_emit_rm(self, 1, 0x30, PDP11_CPU_JIT_DX, al);
+        if (instr->decoded->op == PDP11_CPU_OP_BG_BLE)
+            pdp11_cpu_jit_emit_rm(self, 1, 0x08, PDP11_CPU_JIT_BH, al);
+    } break;
+    case PDP11_CPU_OP_BHI_BLOS: {
+        pdp11_cpu_jit_emit_rm(self, 1, 0x88, PDP11_CPU_JIT_DH, al);
+        pdp11_cpu_jit_emit_rm(self, 1, 0x08, PDP11_CPU_JIT_BH, al);
+    } break;
+    default: assert(false);
+    }
+    if (flag) pdp11_cpu_jit_emit_rm(self, 1, 0x84, flag, pdp11_cpu_jit_r(flag));
+
+    pdp11_cpu_jit_emit_exit(
+        self,
+        cc,
+        self->k + 1,
+        instr->target,
+        instr->target == self->instrs[0].pc
+    );
+}
+
+static void pdp11_cpu_jit_emit_alu(Pdp11CpuJitEmitter *const self) {
+    Pdp11CpuJitInstr const *const instr = self->instrs + self->k;
+    Pdp11CpuOp const op = instr->decoded->op;
+    bool const b = instr->is_byte;
+    // NOTE the word forms of the opcodes are the byte ones plus one
+    unsigned const size = b ? 1 : 2, w = !b;
+
+    unsigned s = PDP11_CPU_JIT_BP;
+    if (instr->src.kind != PDP11_CPU_JIT_O_NONE) {
+        Pdp11CpuJitRm loc = {0};
+        if (instr->src.kind != PDP11_CPU_JIT_O_IMM)
+            loc = pdp11_cpu_jit_emit_resolve(self, &instr->src, b, false);
+        s = pdp11_cpu_jit_emit_load(
+            self,
+            &instr->src,
+            loc,
+            b,
+            PDP11_CPU_JIT_BP
+        );
+    }
+    Pdp11CpuJitRm loc = {0};
+    if (instr->dst.kind != PDP11_CPU_JIT_O_IMM)
+        loc = pdp11_cpu_jit_emit_resolve(
+            self,
+            &instr->dst,
+            b,
+            instr->access != PDP11_CPU_JIT_ACCESS_R
+        );
+    // NOTE nothing exits from here on
+    unsigned d = loc.is_mem ? PDP11_CPU_JIT_CX : loc.reg;
+    if (instr->access != PDP11_CPU_JIT_ACCESS_W)
+        d = pdp11_cpu_jit_emit_load(
+            self,
+            &instr->dst,
+            loc,
+            b,
+            PDP11_CPU_JIT_CX
+        );
+    Pdp11CpuJitRm const rd = pdp11_cpu_jit_r(d);
+
+    switch (op) {
+    case PDP11_CPU_OP_MOV:
+    case PDP11_CPU_OP_MOVB: {
+        pdp11_cpu_jit_emit_rm(self, size, 0x84 + w, s, pdp11_cpu_jit_r(s));
+        pdp11_cpu_jit_emit_flags(
+            self,
+            PDP11_CPU_JIT_N | PDP11_CPU_JIT_Z | PDP11_CPU_JIT_V
+        );
+        // NOTE `movb` to a register sign-extends into the whole register
+        if (b && !loc.is_mem)
+            pdp11_cpu_jit_emit_rm(self, 2, 0x0FBE, d, pdp11_cpu_jit_r(s));
+        else pdp11_cpu_jit_emit_store(self, loc, b, s);
+        return;
+    }
+    case PDP11_CPU_OP_CMP:
+    case PDP11_CPU_OP_CMPB: {
+        pdp11_cpu_jit_emit_rm(self, size, 0x38 + w, d, pdp11_cpu_jit_r(s));
+        return pdp11_cpu_jit_emit_flags(self, 0xF);
+    }
+    case PDP11_CPU_OP_BIT:
+    case PDP11_CPU_OP_BITB: {
+        pdp11_cpu_jit_emit_rm(self, size, 0x84 + w, s, rd);
+    } break;
+    case PDP11_CPU_OP_BIC:
+    case PDP11_CPU_OP_BICB: {
+        Pdp11CpuJitRm const bp = pdp11_cpu_jit_r(PDP11_CPU_JIT_BP);
+        if (s != PDP11_CPU_JIT_BP) pdp11_cpu_jit_emit_rm(self, 4, 0x89, s, bp);
+        pdp11_cpu_jit_emit_ext(self, size, 0xF6 + w, 2, bp);
+        pdp11_cpu_jit_emit_rm(self, size, 0x20 + w, PDP11_CPU_JIT_BP, rd);
+    } break;
+    case PDP11_CPU_OP_BIS:
+    case PDP11_CPU_OP_BISB: {
+        pdp11_cpu_jit_emit_rm(self, size, 0x08 + w, s, rd);
+    } break;
+    case PDP11_CPU_OP_XOR: pdp11_cpu_jit_emit_rm(self, 2, 0x31, s, rd); break;
+    case PDP11_CPU_OP_ADD:
+    case PDP11_CPU_OP_SUB: {
+        unsigned const opcode = op == PDP11_CPU_OP_ADD ? 0x01 : 0x29;
+        pdp11_cpu_jit_emit_rm(self, 2, opcode, s, rd);
+        pdp11_cpu_jit_emit_flags(self, 0xF);
+    } goto store;
+
+    case PDP11_CPU_OP_CLR:
+    case PDP11_CPU_OP_CLRB: {
+        Pdp11CpuJitRm const cx = pdp11_cpu_jit_r(PDP11_CPU_JIT_CX);
+        pdp11_cpu_jit_emit_rm(self, 4, 0x31, PDP11_CPU_JIT_CX, cx);
+        pdp11_cpu_jit_emit_store(self, loc, b, PDP11_CPU_JIT_CX);
+        pdp11_cpu_jit_emit_set_flags(
+            self,
+            PDP11_CPU_JIT_N | PDP11_CPU_JIT_V | PDP11_CPU_JIT_C,
+            0
+        );
+        return pdp11_cpu_jit_emit_set_flags(self, PDP11_CPU_JIT_Z, 1);
+    }
+    case PDP11_CPU_OP_SXT: {
+        Pdp11CpuJitRm const cx = pdp11_cpu_jit_r(PDP11_CPU_JIT_CX);
+        Pdp11CpuJitRm const bh = pdp11_cpu_jit_r(PDP11_CPU_JIT_BH);
+        pdp11_cpu_jit_emit_rm(
+            self,
+            4,
+            0x0FB6,
+            PDP11_CPU_JIT_CX,
+            pdp11_cpu_jit_r(PDP11_CPU_JIT_BX)
+        );
+        pdp11_cpu_jit_emit_ext(self, 4, 0xF7, 3, cx);
+        pdp11_cpu_jit_emit_store(self, loc, false, PDP11_CPU_JIT_CX);
+        pdp11_cpu_jit_emit_rm(self, 1, 0x88, PDP11_CPU_JIT_BX, bh);
+        pdp11_cpu_jit_emit_ext(self, 1, 0x80, 6, bh);
+        pdp11_cpu_jit_emit_imm(self, 1, 1);
+        return pdp11_cpu_jit_emit_set_flags(self, PDP11_CPU_JIT_V, 0);
+    }
+    case PDP11_CPU_OP_COM:
+    case PDP11_CPU_OP_COMB: {
+        pdp11_cpu_jit_emit_ext(self, size, 0xF6 + w, 2, rd);
+        pdp11_cpu_jit_emit_rm(self, size, 0x84 + w, d, rd);
+        pdp11_cpu_jit_emit_flags(
+            self,
+            PDP11_CPU_JIT_N | PDP11_CPU_JIT_Z | PDP11_CPU_JIT_V
+        );
+        pdp11_cpu_jit_emit_set_flags(self, PDP11_CPU_JIT_C, 1);
+    } goto store;
+    case PDP11_CPU_OP_INC:
+    case PDP11_CPU_OP_INCB:
+    case PDP11_CPU_OP_DEC:
+    case PDP11_CPU_OP_DECB: {
+        bool const is_dec = op == PDP11_CPU_OP_DEC || op == PDP11_CPU_OP_DECB;
+        pdp11_cpu_jit_emit_ext(self, size, 0xFE + w, is_dec, rd);
+    } break;
+    case PDP11_CPU_OP_NEG:
+    case PDP11_CPU_OP_NEGB: {
+        pdp11_cpu_jit_emit_ext(self, size, 0xF6 + w, 3, rd);
+        pdp11_cpu_jit_emit_flags(self, 0xF);
+    } goto store;
+    case PDP11_CPU_OP_ADC:
+    case PDP11_CPU_OP_ADCB:
+    case PDP11_CPU_OP_SBC:
+    case PDP11_CPU_OP_SBCB: {
+        bool const is_sbc = op == PDP11_CPU_OP_SBC || op == PDP11_CPU_OP_SBCB;
+        pdp11_cpu_jit_emit_load_c(self);
+        pdp11_cpu_jit_emit_ext(self, size, b ? 0x80 : 0x83, 2 + is_sbc, rd);
+        pdp11_cpu_jit_emit_imm(self, 1, 0);
+        pdp11_cpu_jit_emit_flags(self, 0xF);
+    } goto store;
+    case PDP11_CPU_OP_TST:
+    case PDP11_CPU_OP_TSTB: {
+        pdp11_cpu_jit_emit_rm(self, size, 0x84 + w, d, rd);
+        return pdp11_cpu_jit_emit_flags(self, 0xF);
+    }
+    case PDP11_CPU_OP_ROR:
+    case PDP11_CPU_OP_RORB:
+    case PDP11_CPU_OP_ROL:
+    case PDP11_CPU_OP_ROLB: {
+        bool const is_ror = op == PDP11_CPU_OP_ROR || op == PDP11_CPU_OP_RORB;
+        pdp11_cpu_jit_emit_load_c(self);
+        pdp11_cpu_jit_emit_ext(self, size, 0xD0 + w, 2 + is_ror, rd);
+        pdp11_cpu_jit_emit_flags(self, PDP11_CPU_JIT_C);
+        pdp11_cpu_jit_emit_rm(self, size, 0x84 + w, d, rd);
+        pdp11_cpu_jit_emit_flags(self, PDP11_CPU_JIT_N | PDP11_CPU_JIT_Z);
+        pdp11_cpu_jit_emit_v_of_shift(self);
+    } goto store;
+    case PDP11_CPU_OP_ASR:
+    case PDP11_CPU_OP_ASRB:
+    case PDP11_CPU_OP_ASL:
+    case PDP11_CPU_OP_ASLB: {
+        bool const is_asr = op == PDP11_CPU_OP_ASR || op == PDP11_CPU_OP_ASRB;
+        pdp11_cpu_jit_emit_ext(self, size, 0xD0 + w, is_asr ? 7 : 4, rd);
+        pdp11_cpu_jit_emit_flags(
+            self,
+            PDP11_CPU_JIT_N | PDP11_CPU_JIT_Z | PDP11_CPU_JIT_C
+        );
+        pdp11_cpu_jit_emit_v_of_shift(self);
+    } goto store;
+    case PDP11_CPU_OP_SWAB: {
+        pdp11_cpu_jit_emit_ext(self, 2, 0xC1, 0, rd);
+        pdp11_cpu_jit_emit_imm(self, 1, 8);
+        // NOTE the flags are of the low byte
+        pdp11_cpu_jit_emit_rm(self, 1, 0x84, d, rd);
+        pdp11_cpu_jit_emit_flags(self, 0xF);
+    } goto store;
+    default: assert(false);
+    }
+    // NOTE the logical ones, and `inc` and `dec`, leave C as it is
+    pdp11_cpu_jit_emit_flags(
+        self,
+        PDP11_CPU_JIT_N | PDP11_CPU_JIT_Z | PDP11_CPU_JIT_V
+    );
+    if (instr->access == PDP11_CPU_JIT_ACCESS_R) return;
+
+store:
+    pdp11_cpu_jit_emit_store(self, loc, b, d);
+}
+
+static void pdp11_cpu_jit_emit_instr(Pdp11CpuJitEmitter *const self) {
+    Pdp11CpuDecoded const *const decoded = self->instrs[self->k].decoded;
+    switch (decoded->op) {
+    case PDP11_CPU_OP_BR:
+    case PDP11_CPU_OP_BNE_BE:
+    case PDP11_CPU_OP_BGE_BL:
+    case PDP11_CPU_OP_BG_BLE:
+    case PDP11_CPU_OP_BPL_BMI:
+    case PDP11_CPU_OP_BHI_BLOS:
+    case PDP11_CPU_OP_BVC_BVS:
+    case PDP11_CPU_OP_BCC_BCS:
+    case PDP11_CPU_OP_SOB: return pdp11_cpu_jit_emit_branch(self);
+    case PDP11_CPU_OP_CLNZVC_SENZVC: {
+        uint16_t const opcode = decoded->instr.u.misc.opcode;
+        return pdp11_cpu_jit_emit_set_flags(
+            self,
+            BITS(opcode, 0, 3),
+            BIT(opcode, 4)
+        );
+    }
+    default: break;
+    }
+
+    self->step_count = 0;
+    pdp11_cpu_jit_emit_alu(self);
+    for (unsigned i = 0; i < self->step_count; i++) {
+        int const delta = self->steps[i].delta;
+        pdp11_cpu_jit_emit_ext(
+            self,
+            2,
+            0x83,
+            delta > 0 ? 0 : 5,
+            pdp11_cpu_jit_r(pdp11_cpu_jit_host(self->steps[i].r))
+        );
+        pdp11_cpu_jit_emit_imm(self, 1, delta > 0 ? delta : -delta);
+    }
+}
+
+// where register `r` is kept in the CPU
+static inline Pdp11CpuJitRm pdp11_cpu_jit_reg_of(unsigned const r) {
+    size_t const offset = offsetof(Pdp11Cpu, _r) + 2 * r;
+    return pdp11_cpu_jit_m(PDP11_CPU_JIT_DI, -1, offset);
+}
+static void pdp11_cpu_jit_emit_prologue(Pdp11CpuJitEmitter *const self) {
+    // push rbx, rbp, r12-r15
+    pdp11_cpu_jit_emit(self, 0x53);
+    pdp11_cpu_jit_emit(self, 0x55);
+    for (unsigned r = 12; r <= 15; r++) {
+        pdp11_cpu_jit_emit(self, 0x41);
+        pdp11_cpu_jit_emit(self, 0x50 | (r & 7));
+    }
+    // NOTE the flags go through rsi, r15 would take a REX, which rules out
+    // the high bytes
+    for (unsigned i = 0; i < lenof(pdp11_cpu_jit_flag_regs); i++)
+        pdp11_cpu_jit_emit_rm(
+            self,
+            1,
+            0x8A,
+            pdp11_cpu_jit_flag_regs[lenof(pdp11_cpu_jit_flag_regs) - 1 - i],
+            pdp11_cpu_jit_m(
+                PDP11_CPU_JIT_SI,
+                -1,
+                offsetof(Pdp11CpuJitFrame, nzvc) + i
+            )
+        );
+    pdp11_cpu_jit_emit_rm(
+        self,
+        8,
+        0x89,
+        PDP11_CPU_JIT_SI,
+        pdp11_cpu_jit_r(PDP11_CPU_JIT_R15)
+    );
+    for (unsigned i = 0; i < PDP11_CPU_REG_COUNT - 1; i++)
+        if (self->regs >> i & 1)
+            pdp11_cpu_jit_emit_rm(
+                self,
+                4,
+                0x0FB7,
+                pdp11_cpu_jit_host(i),
+                pdp11_cpu_jit_reg_of(i)
+            );
+    pdp11_cpu_jit_emit_rm(
+        self,
+        8,
+        0x8B,
+        PDP11_CPU_JIT_SI,
+        pdp11_cpu_jit_m(PDP11_CPU_JIT_DI, -1, offsetof(Pdp11Cpu, _ram))
+    );
+}
+static void pdp11_cpu_jit_emit_epilogue(Pdp11CpuJitEmitter *const self) {
+    for (unsigned i = 0; i < PDP11_CPU_REG_COUNT - 1; i++)
+        if (self->regs >> i & 1)
+            pdp11_cpu_jit_emit_rm(
+                self,
+                2,
+                0x89,
+                pdp11_cpu_jit_host(i),
+                pdp11_cpu_jit_reg_of(i)
+            );
+    pdp11_cpu_jit_emit_rm(
+        self,
+        8,
+        0x89,
+        PDP11_CPU_JIT_R15,
+        pdp11_cpu_jit_r(PDP11_CPU_JIT_SI)
+    );
+    for (unsigned i = 0; i < lenof(pdp11_cpu_jit_flag_regs); i++)
+        pdp11_cpu_jit_emit_rm(
+            self,
+            1,
+            0x88,
+            pdp11_cpu_jit_flag_regs[lenof(pdp11_cpu_jit_flag_regs) - 1 - i],
+            pdp11_cpu_jit_m(
+                PDP11_CPU_JIT_SI,
+                -1,
+                offsetof(Pdp11CpuJitFrame, nzvc) + i
+            )
+        );
+    // pop r15-r12, rbp, rbx
+    for (unsigned r = 15; r >= 12; r--) {
+        pdp11_cpu_jit_emit(self, 0x41);
+        pdp11_cpu_jit_emit(self, 0x58 | (r & 7));
+    }
+    pdp11_cpu_jit_emit(self, 0x5D);
+    pdp11_cpu_jit_emit(self, 0x5B);
+    pdp11_cpu_jit_emit(self, 0xC3);
+}
+
+// Registers of R0-R6 that the instruction uses, a bit each.
+static unsigned pdp11_cpu_jit_regs(Pdp11CpuJitInstr const *const instr) {
+    unsigned regs = 0;
+    if (instr->decoded->op == PDP11_CPU_OP_SOB)
+        regs |= 1u << instr->decoded->instr.u.sob.r;
+    Pdp11CpuJitOperand const *const os[] = {&instr->src, &instr->dst};
+    for (unsigned i = 0; i < lenof(os); i++)
+        if ((os[i]->kind == PDP11_CPU_JIT_O_REG ||
+             os[i]->kind == PDP11_CPU_JIT_O_MEM) &&
+            os[i]->r != 7)
+            regs |= 1u << os[i]->r;
+    return regs;
+}
+
+// Number of instructions that can be compiled from record `first` on.
+static unsigned pdp11_cpu_jit_run_len(
+    bool const *const is_planned,
+    unsigned const first,
+    unsigned const len
+) {
+    unsigned i = first;
+    while (i < len && is_planned[i]) i++;
+    return i - first;
+}
+
+/* Whether the `len` instructions are worth their own host code. NOTE going in
+ * and out of it costs about as much as interpreting a few instructions, which
+ * a loop pays only once for all its passes. */
+static bool pdp11_cpu_jit_is_worth(
+    Pdp11CpuJitInstr const *const instrs,
+    unsigned const len
+) {
+    if (len >= PDP11_CPU_JIT_MIN_LEN) return true;
+    for (unsigned i = 0; len >= 2 && i < len; i++)
+        if (instrs[i].is_branch && instrs[i].target == instrs[0].pc)
+            return true;
+    return false;
+}
+
+// Compiles the `len` instructions from record `first` of `block` on.
+static void pdp11_cpu_jit_compile_run(
+    Pdp11Cpu *const self,
+    Pdp11CpuBlock *const block,
+    Pdp11CpuJitInstr const *const instrs,
+    unsigned const first,
+    unsigned const len
+) {
+    uint8_t *const start = self->_jit_code + self->_jit_code_len;
+    Pdp11CpuJitEmitter emitter = {
+        .ptr = start,
+        .ram_size = self->_ram_size,
+        .instrs = instrs + first,
+        .len = len,
+    };
+    for (unsigned i = 0; i < len; i++) {
+        emitter.times[i + 1] = emitter.times[i] + emitter.instrs[i].time;
+        emitter.regs |= pdp11_cpu_jit_regs(emitter.instrs + i);
+    }
+
+    pdp11_cpu_jit_emit_prologue(&emitter);
+    emitter.pass = emitter.ptr;
+    for (; emitter.k < len; emitter.k++) pdp11_cpu_jit_emit_instr(&emitter);
+    pdp11_cpu_jit_emit_spend(&emitter, len);
+    pdp11_cpu_jit_emit(&emitter, 0xB8);  // mov eax, imm32
+    pdp11_cpu_jit_emit_imm(&emitter, 4, emitter.instrs[len - 1].next_pc);
+    uint8_t *const epilogue = emitter.ptr;
+    pdp11_cpu_jit_emit_epilogue(&emitter);
+    pdp11_cpu_jit_emit_exits(&emitter, epilogue);
+    assert(
+        (size_t)(emitter.ptr - start) <=
+        PDP11_CPU_JIT_RUN_MAX_SIZE + len * PDP11_CPU_JIT_INSTR_MAX_SIZE
+    );
+
+    self->_jit_code_len += emitter.ptr - start;
+    block->jits[first] = (Pdp11CpuBlockJit){
+        .code = (Pdp11CpuJitCode *)start,
+        .len = len,
+        .time = emitter.times[len],
+    };
+    block->jit_starts |= 1 << first;
+    self->__jit_compiles++;
+}
+
+// Drops every compiled run, so that the code buffer can be reused. The blocks
+// that are still hot get compiled again.
+static void pdp11_cpu_jit_flush(Pdp11Cpu *const self) {
+    for (unsigned i = 0; i < PDP11_CPU_BLOCK_COUNT; i++) {
+        self->_blocks[i].jit_starts = 0;
+        self->_blocks[i].is_jit_scanned = false;
+    }
+    self->_jit_code_len = 0;
+}
+
+/************
+ ** public **
+ ************/
+
+// NOTE the code buffer is never writable and executable at once, the pages
+// code goes to are only made writable while compiling, which the CPU thread
+// does in between runs
+void pdp11_cpu_jit_init(Pdp11Cpu *const self) {
+    void *const code = mmap(
+        NULL,
+        PDP11_CPU_JIT_CODE_SIZE,
+        PROT_READ | PROT_EXEC,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    self->_jit_code = code == MAP_FAILED ? NULL : code;
+    self->_jit_code_len = 0;
+}
+void pdp11_cpu_jit_uninit(Pdp11Cpu *const self) {
+    if (self->_jit_code) munmap(self->_jit_code, PDP11_CPU_JIT_CODE_SIZE);
+    self->_jit_code = NULL;
+}
+void pdp11_cpu_jit_compile(Pdp11Cpu *const self, Pdp11CpuBlock *const block) {
+    block->is_jit_scanned = true;
+    if (!self->_jit_code) return;
+
+    // NOTE the runs are looked for before anything gets writable, so that a
+    // block with none costs nothing more
+    Pdp11CpuJitInstr instrs[PDP11_CPU_BLOCK_MAX_LEN];
+    bool is_planned[PDP11_CPU_BLOCK_MAX_LEN];
+    for (unsigned i = 0; i < block->len; i++)
+        is_planned[i] =
+            pdp11_cpu_jit_plan(self, block->records + i, instrs + i);
+    size_t max_size = 0;
+    for (unsigned i = 0, len; i < block->len; i += len == 0 ? 1 : len) {
+        len = pdp11_cpu_jit_run_len(is_planned, i, block->len);
+        if (pdp11_cpu_jit_is_worth(instrs + i, len))
+            max_size +=
+                PDP11_CPU_JIT_RUN_MAX_SIZE + len * PDP11_CPU_JIT_INSTR_MAX_SIZE;
+    }
+    if (max_size == 0) return;
+
+    if (self->_jit_code_len + max_size > PDP11_CPU_JIT_CODE_SIZE)
+        pdp11_cpu_jit_flush(self);
+    size_t const page = sysconf(_SC_PAGESIZE);
+    size_t const from = self->_jit_code_len / page * page;
+    size_t const to = (self->_jit_code_len + max_size + page - 1) / page * page;
+    uint8_t *const pages = self->_jit_code + from;
+    if (mprotect(pages, to - from, PROT_READ | PROT_WRITE) != 0) return;
+
+    for (unsigned i = 0, len; i < block->len; i += len == 0 ? 1 : len) {
+        len = pdp11_cpu_jit_run_len(is_planned, i, block->len);
+        if (pdp11_cpu_jit_is_worth(instrs + i, len))
+            pdp11_cpu_jit_compile_run(self, block, instrs, i, len);
+    }
+
+    // NOTE without a way to run it, the code is dropped along with the buffer
+    if (mprotect(pages, to - from, PROT_READ | PROT_EXEC) != 0) {
+        pdp11_cpu_jit_flush(self);
+        pdp11_cpu_jit_uninit(self);
+    }
+}
+uint32_t pdp11_cpu_jit_run(
+    Pdp11Cpu *const self,
+    Pdp11CpuBlock *const block,
+    unsigned const first,
+    int32_t const ns
+) {
+    pdp11_cpu_sync_flags(self);
+    Pdp11PswFlags const flags = self->_psw.flags;
+    uint64_t const instrs_left = pdp11_cpu_instrs_left(self);
+    Pdp11CpuJitFrame frame = {
+        .nzvc = {flags.n, flags.z, flags.v, flags.c},
+        .ns = ns,
+        .instrs = instrs_left < UINT32_MAX ? instrs_left : UINT32_MAX,
+    };
+    uint32_t const instrs = frame.instrs;
+
+    pdp11_cpu_pc(self) = block->jits[first].code(self, &frame);
+
+    uint32_t const done = instrs - frame.instrs;
+    // NOTE a run that leaves before it gets going, polling a device say, is
+    // better off interpreted from then on
+    if (done < PDP11_CPU_JIT_MIN_LEN) block->jit_starts &= ~(1u << first);
+    if (done == 0) return 0;
+    self->__instrs += done;
+    self->_psw.flags = (Pdp11PswFlags){
+        .t = flags.t,
+        .n = frame.nzvc[0],
+        .z = frame.nzvc[1],
+        .v = frame.nzvc[2],
+        .c = frame.nzvc[3],
+    };
+    return ns - frame.ns;
+}
+
+#else
+
+void pdp11_cpu_jit_init(Pdp11Cpu *const self) { self->_jit_code = NULL; }
+void pdp11_cpu_jit_uninit(Pdp11Cpu *const self) { (void)self; }
+void pdp11_cpu_jit_compile(Pdp11Cpu *const self, Pdp11CpuBlock *const block) {
+    (void)self, block->is_jit_scanned = true;
+}
+uint32_t pdp11_cpu_jit_run(
+    Pdp11Cpu *const self,
+    Pdp11CpuBlock *const block,
+    unsigned const first,
+    int32_t const ns
+) {
+    return (void)self, (void)block, (void)first, (void)ns, 0;
+}
+
+#endif
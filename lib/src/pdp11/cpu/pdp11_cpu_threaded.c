@@ -0,0 +1,141 @@
+#include "pdp11/cpu/pdp11_cpu_engine.h"
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <assert.h>
+
+// X-macro over the operations without operand classes, as
+// `X(ENUM_NAME, handler_name)`
+#define PDP11_CPU_THREADED_PLAIN_OPS(X)                                        \
+    X(RESERVED, reserved)                                                      \
+    X(BR, br)                                                                  \
+    X(BNE_BE, bne_be)                                                          \
+    X(BGE_BL, bge_bl)                                                          \
+    X(BG_BLE, bg_ble)                                                          \
+    X(BPL_BMI, bpl_bmi)                                                        \
+    X(BHI_BLOS, bhi_blos)                                                      \
+    X(BVC_BVS, bvc_bvs)                                                        \
+    X(BCC_BCS, bcc_bcs)                                                        \
+    X(RTS, rts)                                                                \
+    X(SPL, spl)                                                                \
+    X(SOB, sob)                                                                \
+    X(JSR, jsr)                                                                \
+    X(JMP, jmp)                                                                \
+    X(MARK, mark)                                                              \
+    X(CLNZVC_SENZVC, clnzvc_senzvc)                                            \
+    X(EMT, emt)                                                                \
+    X(TRAP, trap)                                                              \
+    X(RTI_RTT, rti_rtt)                                                        \
+    X(BPT, bpt)                                                                \
+    X(IOT, iot)                                                                \
+    X(HALT, halt)                                                              \
+    X(WAIT, wait)                                                              \
+    X(RESET, reset)
+
+#define PDP11_CPU_THREADED_ONE(...) +1
+static_assert(
+    0 PDP11_CPU_THREADED_PLAIN_OPS(PDP11_CPU_THREADED_ONE)
+      PDP11_CPU_O_OPS(PDP11_CPU_THREADED_ONE)
+      PDP11_CPU_OO_OPS(PDP11_CPU_THREADED_ONE)
+      PDP11_CPU_RO_OPS(PDP11_CPU_THREADED_ONE) == PDP11_CPU_OP_COUNT,
+    "every operation needs its labels"
+);
+#undef PDP11_CPU_THREADED_ONE
+
+/* Direct-threaded engine. Every handler ends with its own copy of the
+ * dispatch, so that the host branch predictor gets a separate history for
+ * each guest operation instead of a single shared indirect jump. Operations
+ * with operands get a label per class of them, indexed by `decoded->classes`
+ * the way `pdp11_cpu_execs_o` and `pdp11_cpu_execs_oo` are, which calls the
+ * specialized handler directly. Going through `decoded->exec` instead would
+ * put the same shared indirect call the loop engine makes right behind every
+ * label. */
+void pdp11_cpu_threaded_run(Pdp11Cpu *const self) {
+    static void const *const labels[PDP11_CPU_OP_COUNT][4] = {
+#define PDP11_CPU_THREADED_LABELS_PLAIN(NAME_, name_)                          \
+    [PDP11_CPU_OP_##NAME_] = {                                                 \
+        &&op_##name_,                                                          \
+        &&op_##name_,                                                          \
+        &&op_##name_,                                                          \
+        &&op_##name_,                                                          \
+    },
+#define PDP11_CPU_THREADED_LABELS_O(NAME_, name_, ...)                         \
+    [PDP11_CPU_OP_##NAME_] = {&&op_##name_##_reg, &&op_##name_##_mem},
+#define PDP11_CPU_THREADED_LABELS_OO(NAME_, name_, ...)                        \
+    [PDP11_CPU_OP_##NAME_] = {                                                 \
+        &&op_##name_##_reg_reg,                                                \
+        &&op_##name_##_reg_mem,                                                \
+        &&op_##name_##_mem_reg,                                                \
+        &&op_##name_##_mem_mem,                                                \
+    },
+        PDP11_CPU_THREADED_PLAIN_OPS(PDP11_CPU_THREADED_LABELS_PLAIN)
+        PDP11_CPU_O_OPS(PDP11_CPU_THREADED_LABELS_O)
+        PDP11_CPU_OO_OPS(PDP11_CPU_THREADED_LABELS_OO)
+        PDP11_CPU_RO_OPS(PDP11_CPU_THREADED_LABELS_O)
+#undef PDP11_CPU_THREADED_LABELS_OO
+#undef PDP11_CPU_THREADED_LABELS_O
+#undef PDP11_CPU_THREADED_LABELS_PLAIN
+    };
+
+    Pdp11CpuDecoded const *decoded;
+    // NOTE `volatile` to be kept across a bus error
+    int32_t volatile ns;
+
+#define PDP11_CPU_THREADED_FETCH()                                             \
+    do {                                                                       \
+        decoded = pdp11_cpu_decoded + pdp11_cpu_fetch(self);                   \
+        goto *labels[decoded->op][decoded->classes];                           \
+    } while (false)
+#define PDP11_CPU_THREADED_DISPATCH()                                          \
+    do {                                                                       \
+        if ((ns -= decoded->time) <= 0 || pdp11_cpu_needs_attention(self)) {   \
+            pdp11_cpu_after_batch(self, ns);                                   \
+            goto batch;                                                        \
+        }                                                                      \
+        PDP11_CPU_THREADED_FETCH();                                            \
+    } while (false)
+
+batch:
+    if ((ns = pdp11_cpu_before_batch(self)) == 0) return;
+    if (setjmp(self->__bus_error)) {
+        pdp11_cpu_take_bus_error(self);
+        pdp11_cpu_after_batch(self, ns - PDP11_CPU_TRAP_NS);
+        goto batch;
+    }
+    PDP11_CPU_THREADED_FETCH();
+
+#define PDP11_CPU_THREADED_HANDLER(label_, exec_)                              \
+    label_ : {                                                                 \
+        exec_(self, decoded->instr);                                           \
+        PDP11_CPU_THREADED_DISPATCH();                                         \
+    }
+#define PDP11_CPU_THREADED_HANDLERS_PLAIN(NAME_, name_)                        \
+    PDP11_CPU_THREADED_HANDLER(op_##name_, pdp11_cpu_exec_##name_)
+#define PDP11_CPU_THREADED_HANDLERS_O(NAME_, name_, ...)                       \
+    PDP11_CPU_THREADED_HANDLER(op_##name_##_reg, pdp11_cpu_exec_##name_##_reg) \
+    PDP11_CPU_THREADED_HANDLER(op_##name_##_mem, pdp11_cpu_exec_##name_##_mem)
+#define PDP11_CPU_THREADED_HANDLERS_OO_AS(name_, SRC_CLASS_, DST_CLASS_)       \
+    PDP11_CPU_THREADED_HANDLER(                                                \
+        op_##name_##_##SRC_CLASS_##_##DST_CLASS_,                              \
+        pdp11_cpu_exec_##name_##_##SRC_CLASS_##_##DST_CLASS_                   \
+    )
+#define PDP11_CPU_THREADED_HANDLERS_OO(NAME_, name_, ...)                      \
+    PDP11_CPU_THREADED_HANDLERS_OO_AS(name_, reg, reg)                         \
+    PDP11_CPU_THREADED_HANDLERS_OO_AS(name_, reg, mem)                         \
+    PDP11_CPU_THREADED_HANDLERS_OO_AS(name_, mem, reg)                         \
+    PDP11_CPU_THREADED_HANDLERS_OO_AS(name_, mem, mem)
+    PDP11_CPU_THREADED_PLAIN_OPS(PDP11_CPU_THREADED_HANDLERS_PLAIN)
+    PDP11_CPU_O_OPS(PDP11_CPU_THREADED_HANDLERS_O)
+    PDP11_CPU_OO_OPS(PDP11_CPU_THREADED_HANDLERS_OO)
+    PDP11_CPU_RO_OPS(PDP11_CPU_THREADED_HANDLERS_O)
+#undef PDP11_CPU_THREADED_HANDLERS_OO
+#undef PDP11_CPU_THREADED_HANDLERS_OO_AS
+#undef PDP11_CPU_THREADED_HANDLERS_O
+#undef PDP11_CPU_THREADED_HANDLERS_PLAIN
+#undef PDP11_CPU_THREADED_HANDLER
+
+#undef PDP11_CPU_THREADED_DISPATCH
+#undef PDP11_CPU_THREADED_FETCH
+}
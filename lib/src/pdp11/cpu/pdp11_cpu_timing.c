@@ -0,0 +1,123 @@
+#include "pdp11/cpu/pdp11_cpu_engine.h"
+
+#include "bits.h"
+
+/* Instruction times of the 11/20 with core memory, after its handbook, in
+ * nanoseconds. An instruction takes its basic time plus the time to get at
+ * each of its operands, which depends on the addressing mode. The ones the
+ * 11/20 lacks take roughly what they take on the 11/40. */
+
+/*************
+ ** private **
+ *************/
+
+// Source operand, fetched and read, by mode.
+static uint32_t const pdp11_cpu_src_ns[8] = {
+    0, 1500, 1500, 2700, 1500, 2700, 2700, 3900,
+};
+// Destination operand, fetched, read and written back, by mode.
+static uint32_t const pdp11_cpu_dst_ns[8] = {
+    0, 1400, 1400, 2600, 1400, 2600, 2600, 3800,
+};
+// Jump target, which is only fetched, by mode. NOTE mode 0 is illegal.
+static uint32_t const pdp11_cpu_jmp_ns[8] = {
+    0, 0, 600, 1200, 600, 1800, 1800, 3000,
+};
+
+static inline uint32_t pdp11_cpu_src(unsigned const o) {
+    return pdp11_cpu_src_ns[BITS(o, 3, 5)];
+}
+static inline uint32_t pdp11_cpu_dst(unsigned const o) {
+    return pdp11_cpu_dst_ns[BITS(o, 3, 5)];
+}
+static inline uint32_t pdp11_cpu_jmp(unsigned const o) {
+    return pdp11_cpu_jmp_ns[BITS(o, 3, 5)];
+}
+
+/************
+ ** public **
+ ************/
+
+uint32_t pdp11_cpu_instr_ns(Pdp11CpuOp const op, Pdp11CpuInstr const instr) {
+    switch (op) {
+    case PDP11_CPU_OP_MOV:
+    case PDP11_CPU_OP_CMP:
+    case PDP11_CPU_OP_BIT:
+    case PDP11_CPU_OP_BIC:
+    case PDP11_CPU_OP_BIS:
+    case PDP11_CPU_OP_ADD:
+    case PDP11_CPU_OP_SUB:
+    case PDP11_CPU_OP_MOVB:
+    case PDP11_CPU_OP_CMPB:
+    case PDP11_CPU_OP_BITB:
+    case PDP11_CPU_OP_BICB:
+    case PDP11_CPU_OP_BISB:
+        return 2300 + pdp11_cpu_src(instr.u.oo.o0) +
+               pdp11_cpu_dst(instr.u.oo.o1);
+
+    case PDP11_CPU_OP_MUL: return 8800 + pdp11_cpu_src(instr.u.ro.o);
+    case PDP11_CPU_OP_DIV: return 11300 + pdp11_cpu_src(instr.u.ro.o);
+    case PDP11_CPU_OP_ASH: return 3500 + pdp11_cpu_src(instr.u.ro.o);
+    case PDP11_CPU_OP_ASHC: return 4300 + pdp11_cpu_src(instr.u.ro.o);
+    case PDP11_CPU_OP_XOR: return 2300 + pdp11_cpu_dst(instr.u.ro.o);
+
+    case PDP11_CPU_OP_SWAB:
+    case PDP11_CPU_OP_CLR:
+    case PDP11_CPU_OP_COM:
+    case PDP11_CPU_OP_INC:
+    case PDP11_CPU_OP_DEC:
+    case PDP11_CPU_OP_NEG:
+    case PDP11_CPU_OP_ADC:
+    case PDP11_CPU_OP_SBC:
+    case PDP11_CPU_OP_TST:
+    case PDP11_CPU_OP_ROR:
+    case PDP11_CPU_OP_ROL:
+    case PDP11_CPU_OP_ASR:
+    case PDP11_CPU_OP_ASL:
+    case PDP11_CPU_OP_SXT:
+    case PDP11_CPU_OP_CLRB:
+    case PDP11_CPU_OP_COMB:
+    case PDP11_CPU_OP_INCB:
+    case PDP11_CPU_OP_DECB:
+    case PDP11_CPU_OP_NEGB:
+    case PDP11_CPU_OP_ADCB:
+    case PDP11_CPU_OP_SBCB:
+    case PDP11_CPU_OP_TSTB:
+    case PDP11_CPU_OP_RORB:
+    case PDP11_CPU_OP_ROLB:
+    case PDP11_CPU_OP_ASRB:
+    case PDP11_CPU_OP_ASLB: return 2300 + pdp11_cpu_dst(instr.u.o.o);
+
+    case PDP11_CPU_OP_BR:
+    case PDP11_CPU_OP_BNE_BE:
+    case PDP11_CPU_OP_BGE_BL:
+    case PDP11_CPU_OP_BG_BLE:
+    case PDP11_CPU_OP_BPL_BMI:
+    case PDP11_CPU_OP_BHI_BLOS:
+    case PDP11_CPU_OP_BVC_BVS:
+    case PDP11_CPU_OP_BCC_BCS: return 2600;
+
+    case PDP11_CPU_OP_RTS: return 3500;
+    case PDP11_CPU_OP_SPL: return 3800;
+    case PDP11_CPU_OP_SOB: return 2500;
+    case PDP11_CPU_OP_JSR: return 3500 + pdp11_cpu_jmp(instr.u.jsr.o);
+    case PDP11_CPU_OP_JMP: return 1200 + pdp11_cpu_jmp(instr.u.jmp.o);
+    case PDP11_CPU_OP_MARK: return 3500;
+    case PDP11_CPU_OP_CLNZVC_SENZVC: return 1500;
+
+    case PDP11_CPU_OP_EMT:
+    case PDP11_CPU_OP_TRAP:
+    case PDP11_CPU_OP_BPT:
+    case PDP11_CPU_OP_IOT: return PDP11_CPU_TRAP_NS;
+    case PDP11_CPU_OP_RTI_RTT: return 4200;
+
+    case PDP11_CPU_OP_HALT:
+    case PDP11_CPU_OP_WAIT: return 1800;
+    // NOTE INIT is held for 20 ms
+    case PDP11_CPU_OP_RESET: return 20 * 1000 * 1000;
+
+    // NOTE traps to the reserved instruction vector
+    case PDP11_CPU_OP_RESERVED:
+    default: return PDP11_CPU_TRAP_NS;
+    }
+}
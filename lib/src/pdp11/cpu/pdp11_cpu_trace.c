@@ -0,0 +1,68 @@
+#include "pdp11/cpu/pdp11_cpu_trace.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*************
+ ** private **
+ *************/
+
+static void pdp11_cpu_trace_dump_entry(
+    Pdp11CpuTraceEntry const *const entry,
+    Pdp11CpuTraceEntry const *const prev,
+    FILE *const file,
+    bool const is_verbose
+) {
+    switch (entry->kind) {
+    case PDP11_CPU_TRACE_KIND_INSTR: {
+        // NOTE a blank line separates the straight runs, as before
+        if (prev && prev->kind == PDP11_CPU_TRACE_KIND_INSTR &&
+            (uint16_t)(entry->pc - prev->pc - 2) > 4)
+            fprintf(file, "\n");
+
+        fprintf(file, "exec at %06o : %06o", entry->pc, entry->val);
+        if (is_verbose) {
+            fprintf(file, "  psw %06o", entry->psw);
+            for (unsigned i = 0; i < entry->addr_count; i++)
+                fprintf(file, "  @%06o", entry->addrs[i]);
+        }
+        fprintf(file, "\n");
+    } break;
+    case PDP11_CPU_TRACE_KIND_INTR:
+        fprintf(file, "  (from intr)  ==TRAP== (%03o) \n", entry->val);
+        break;
+    case PDP11_CPU_TRACE_KIND_TRAP:
+        fprintf(file, "==TRAP== (%03o) \n", entry->val);
+        break;
+    }
+}
+
+/************
+ ** public **
+ ************/
+
+void pdp11_cpu_trace_init(Pdp11CpuTrace *const self) {
+    self->options = 0;
+    atomic_init(&self->_head, 0);
+}
+
+void pdp11_cpu_trace_dump(
+    Pdp11CpuTrace const *const self,
+    FILE *const file,
+    bool const is_verbose
+) {
+    uint32_t const head =
+        atomic_load_explicit(&self->_head, memory_order_acquire);
+    uint32_t const len =
+        head < PDP11_CPU_TRACE_LEN ? head : PDP11_CPU_TRACE_LEN;
+
+    Pdp11CpuTraceEntry const *prev = NULL;
+    for (uint32_t i = head - len; i != head; i++) {
+        Pdp11CpuTraceEntry const *const entry =
+            self->_entries + (i & (PDP11_CPU_TRACE_LEN - 1));
+        pdp11_cpu_trace_dump_entry(entry, prev, file, is_verbose);
+        prev = entry;
+    }
+    fflush(file);
+}
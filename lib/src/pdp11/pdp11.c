@@ -4,19 +4,50 @@
 
 #include <unistd.h>
 
-Result pdp11_init(Pdp11 *const self) {
-    UNROLL(pdp11_ram_init(&self->ram, 0, PDP11_RAM_SIZE, "core.ram"));
-
-    UNROLL_CLEANUP(pdp11_cpu_init(&self->cpu, &self->unibus), {
-        pdp11_ram_uninit(&self->ram);
-    });
+Result pdp11_init(
+    Pdp11 *const self,
+    char const *const ram_filepath,
+    Pdp11CpuEngine const cpu_engine,
+    bool const is_cpu_threaded
+) {
+    UNROLL(pdp11_ram_init(&self->ram, 0, PDP11_RAM_SIZE, ram_filepath));
 
+    // NOTE a threaded CPU may take the bus as soon as it is initialized
     unibus_init(&self->unibus, &self->cpu);
-    self->periphs = self->unibus.devices;
-    self->periphs++[0] = pdp11_ram_ww_unibus_device(&self->ram);
+    UNROLL_CLEANUP(
+        pdp11_cpu_init(
+            &self->cpu,
+            &self->unibus,
+            cpu_engine,
+            is_cpu_threaded
+        ),
+        {
+            unibus_uninit(&self->unibus);
+            pdp11_ram_uninit(&self->ram);
+        }
+    );
+
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &self->unibus,
+            pdp11_ram_ww_unibus_device(&self->ram),
+            0,
+            PDP11_RAM_SIZE
+        ),
+        pdp11_uninit(self)
+    );
+    pdp11_cpu_map_ram(&self->cpu, pdp11_ram_data(&self->ram), PDP11_RAM_SIZE);
 
     pdp11_console_init(&self->console, &self->cpu, &self->unibus);
-    self->periphs++[0] = pdp11_console_ww_unibus_device(&self->console);
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &self->unibus,
+            pdp11_console_ww_unibus_device(&self->console),
+            PDP11_CONSOLE_SWITCH_REGISTER_ADDR,
+            2
+        ),
+        pdp11_uninit(self)
+    );
 
     return Ok;
 }
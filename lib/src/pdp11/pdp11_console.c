@@ -269,6 +269,17 @@ static bool pdp11_console_try_write_byte(
 ) {
     return addr == PDP11_CONSOLE_SWITCH_REGISTER_ADDR;
 }
+static bool pdp11_console_try_map(
+    Pdp11Console *const,
+    uint16_t const addr,
+    void volatile **const out_ptr
+) {
+    if (addr != PDP11_CONSOLE_SWITCH_REGISTER_ADDR) return false;
+
+    *out_ptr = NULL;
+
+    return true;
+}
 UnibusDevice pdp11_console_ww_unibus_device(Pdp11Console *const self) {
     WRAP_BODY(
         UnibusDevice,
@@ -278,6 +289,7 @@ UnibusDevice pdp11_console_ww_unibus_device(Pdp11Console *const self) {
             ._try_read = pdp11_console_try_read,
             ._try_write_word = pdp11_console_try_write_word,
             ._try_write_byte = pdp11_console_try_write_byte,
+            ._try_map = pdp11_console_try_map,
         }
     );
 }
@@ -1,7 +1,5 @@
 #include "pdp11/pdp11_papertape_reader.h"
 
-#include <unistd.h>
-
 #include "bits.h"
 
 /*************
@@ -15,51 +13,39 @@ static uint16_t pdp11_papertape_reader_status_to_word(
            self.intr_enable << 6;
 }
 
+static void pdp11_papertape_reader_end_read_cycle(
+    void *const vself,
+    uint16_t const
+) {
+    Pdp11PapertapeReader *const self = vself;
+
+    uint8_t buffer = 0;
+    bool const is_error = self->_status.error || !self->_tape ||
+                          fread(&buffer, 1, 1, self->_tape) != 1;
+
+    self->_status.busy = false;
+    self->_status.error = is_error;
+    self->_status.done = !is_error;
+    if (!is_error) self->_buffer = buffer;
+
+    if (self->_status.intr_enable)
+        unibus_br_intr(self->_unibus, self->_intr_vec);
+}
 static void pdp11_papertape_reader_start_read_cycle(
     Pdp11PapertapeReader *const self
 ) {
+    Pdp11Event const end = {
+        .fire = pdp11_papertape_reader_end_read_cycle,
+        .ctx = self,
+    };
+
     self->_status.busy = true;
     self->_status.done = false;
     self->_buffer = 0;
+    unibus_cancel(self->_unibus, end);
+    unibus_schedule(self->_unibus, PDP11_PAPERTAPE_READER_CHAR_NS, end);
 }
 
-static void pdp11_papertape_reader_thread_helper(
-    Pdp11PapertapeReader *const self
-) {
-    while (true) {
-        while (!self->_status.busy) sleep(0);
-
-        bool is_error = self->_status.error;
-        uint8_t buffer = 0;
-        if (!is_error) {
-            if (!self->_tape || fread(&buffer, 1, 1, self->_tape) != 1)
-                is_error = true;
-        }
-
-        pthread_mutex_lock(&self->_lock);
-        {
-            self->_status.busy = false;
-            self->_status.error = is_error;
-            self->_status.done = !is_error;
-            if (!is_error) self->_buffer = buffer;
-
-            if (self->_status.intr_enable)
-                unibus_br_intr(
-                    self->_unibus,
-                    self->_intr_priority,
-                    self,
-                    self->_intr_vec
-                );
-        }
-        pthread_mutex_unlock(&self->_lock);
-
-        usleep(1000000 / 300 / 10);
-    }
-}
-static void *pdp11_papertape_reader_thread(void *const vself) {
-    return pdp11_papertape_reader_thread_helper(vself), NULL;
-};
-
 /************
  ** public **
  ************/
@@ -72,6 +58,8 @@ Result pdp11_papertape_reader_init(
     unsigned const intr_priority
 
 ) {
+    UNROLL(unibus_attach_br(unibus, intr_priority, intr_vec));
+
     self->_tape = NULL;
 
     self->_status = (Pdp11PapertapeReaderStatus){0};
@@ -79,24 +67,19 @@ Result pdp11_papertape_reader_init(
 
     self->_starting_addr = starting_addr;
     self->_intr_vec = intr_vec;
-    self->_intr_priority = intr_priority;
 
     self->_unibus = unibus;
 
-    if (pthread_mutex_init(&self->_lock, NULL) != 0 ||
-        pthread_create(
-            &self->_thread,
-            NULL,
-            pdp11_papertape_reader_thread,
-            self
-        ) != 0)
-        return UnknownErr;
-
     return Ok;
 }
 void pdp11_papertape_reader_uninit(Pdp11PapertapeReader *const self) {
-    pthread_cancel(self->_thread);
-    pthread_mutex_destroy(&self->_lock);
+    unibus_cancel(
+        self->_unibus,
+        (Pdp11Event){
+            .fire = pdp11_papertape_reader_end_read_cycle,
+            .ctx = self,
+        }
+    );
 
     if (self->_tape) fclose(self->_tape), self->_tape = NULL;
 }
@@ -118,17 +101,20 @@ Result pdp11_papertape_reader_load(
  ***************/
 
 static void pdp11_papertape_reader_reset(Pdp11PapertapeReader *const self) {
-    pthread_mutex_lock(&self->_lock);
-    {
-        self->_status = (Pdp11PapertapeReaderStatus){
-            .error = false,
-            .busy = false,
-            .done = false,
-            .intr_enable = false,
-        };
-        self->_buffer = 0;
-    }
-    pthread_mutex_unlock(&self->_lock);
+    unibus_cancel(
+        self->_unibus,
+        (Pdp11Event){
+            .fire = pdp11_papertape_reader_end_read_cycle,
+            .ctx = self,
+        }
+    );
+    self->_status = (Pdp11PapertapeReaderStatus){
+        .error = false,
+        .busy = false,
+        .done = false,
+        .intr_enable = false,
+    };
+    self->_buffer = 0;
 }
 static bool pdp11_papertape_reader_try_read(
     Pdp11PapertapeReader *const self,
@@ -138,20 +124,16 @@ static bool pdp11_papertape_reader_try_read(
     addr -= self->_starting_addr;
     if (!(addr < 4)) return false;
 
-    pthread_mutex_lock(&self->_lock);
-    {
-        // NOTE odd addresses cannot pass here
-        switch (addr) {
-        case 0:
-            *out = pdp11_papertape_reader_status_to_word(self->_status);
-            break;
-        case 2: {
-            self->_status.done = false;
-            *out = self->_buffer;
-        } break;
-        }
+    // NOTE odd addresses cannot pass here
+    switch (addr) {
+    case 0:
+        *out = pdp11_papertape_reader_status_to_word(self->_status);
+        break;
+    case 2: {
+        self->_status.done = false;
+        *out = self->_buffer;
+    } break;
     }
-    pthread_mutex_unlock(&self->_lock);
     return true;
 }
 static bool pdp11_papertape_reader_try_write_word(
@@ -162,18 +144,14 @@ static bool pdp11_papertape_reader_try_write_word(
     addr -= self->_starting_addr;
     if (!(addr < 4)) return false;
 
-    pthread_mutex_lock(&self->_lock);
-    {
-        // NOTE odd addresses cannot pass here
-        switch (addr) {
-        case 0: {
-            self->_status.intr_enable = BIT(val, 6);
-            if (BIT(val, 0)) pdp11_papertape_reader_start_read_cycle(self);
-        } break;
-        case 2: self->_status.done = false; break;
-        }
+    // NOTE odd addresses cannot pass here
+    switch (addr) {
+    case 0: {
+        self->_status.intr_enable = BIT(val, 6);
+        if (BIT(val, 0)) pdp11_papertape_reader_start_read_cycle(self);
+    } break;
+    case 2: self->_status.done = false; break;
     }
-    pthread_mutex_unlock(&self->_lock);
     return true;
 }
 static bool pdp11_papertape_reader_try_write_byte(
@@ -184,18 +162,26 @@ static bool pdp11_papertape_reader_try_write_byte(
     addr -= self->_starting_addr;
     if (!(addr < 4)) return false;
 
-    pthread_mutex_lock(&self->_lock);
-    {
-        switch (addr) {
-        case 0: {
-            self->_status.intr_enable = BIT(val, 6);
-            if (BIT(val, 0)) pdp11_papertape_reader_start_read_cycle(self);
-        } break;
-        case 1: break;
-        case 2 ... 3: self->_status.done = false; break;
-        }
+    switch (addr) {
+    case 0: {
+        self->_status.intr_enable = BIT(val, 6);
+        if (BIT(val, 0)) pdp11_papertape_reader_start_read_cycle(self);
+    } break;
+    case 1: break;
+    case 2 ... 3: self->_status.done = false; break;
     }
-    pthread_mutex_unlock(&self->_lock);
+    return true;
+}
+static bool pdp11_papertape_reader_try_map(
+    Pdp11PapertapeReader *const self,
+    uint16_t addr,
+    void volatile **const out_ptr
+) {
+    addr -= self->_starting_addr;
+    if (!(addr < 4)) return false;
+
+    *out_ptr = NULL;
+
     return true;
 }
 UnibusDevice pdp11_papertape_reader_ww_unibus_device(
@@ -209,6 +195,7 @@ UnibusDevice pdp11_papertape_reader_ww_unibus_device(
             ._try_read = pdp11_papertape_reader_try_read,
             ._try_write_word = pdp11_papertape_reader_try_write_word,
             ._try_write_byte = pdp11_papertape_reader_try_write_byte,
+            ._try_map = pdp11_papertape_reader_try_map,
         }
     );
 }
@@ -102,6 +102,18 @@ static bool pdp11_ram_try_write_byte(
 
     return true;
 }
+static bool pdp11_ram_try_map(
+    Pdp11Ram *const self,
+    uint16_t addr,
+    void volatile **const out_ptr
+) {
+    addr -= self->_starting_addr;
+    if (!(addr < self->_size)) return false;
+
+    *out_ptr = self->_data + addr;
+
+    return true;
+}
 UnibusDevice pdp11_ram_ww_unibus_device(Pdp11Ram *const self) {
     WRAP_BODY(
         UnibusDevice,
@@ -111,6 +123,7 @@ UnibusDevice pdp11_ram_ww_unibus_device(Pdp11Ram *const self) {
             ._try_read = pdp11_ram_try_read,
             ._try_write_word = pdp11_ram_try_write_word,
             ._try_write_byte = pdp11_ram_try_write_byte,
+            ._try_map = pdp11_ram_try_map,
         }
     );
 }
@@ -64,6 +64,19 @@ pdp11_rom_try_write_byte(Pdp11Rom *const self, uint16_t addr, uint8_t const) {
     addr -= self->_starting_addr;
     return addr < self->_size;
 }
+// NOTE writes to ROM are ignored, so it cannot be accessed directly
+static bool pdp11_rom_try_map(
+    Pdp11Rom *const self,
+    uint16_t addr,
+    void volatile **const out_ptr
+) {
+    addr -= self->_starting_addr;
+    if (!(addr < self->_size)) return false;
+
+    *out_ptr = NULL;
+
+    return true;
+}
 UnibusDevice pdp11_rom_ww_unibus_device(Pdp11Rom *const self) {
     WRAP_BODY(
         UnibusDevice,
@@ -73,6 +86,7 @@ UnibusDevice pdp11_rom_ww_unibus_device(Pdp11Rom *const self) {
             ._try_read = pdp11_rom_try_read,
             ._try_write_word = pdp11_rom_try_write_word,
             ._try_write_byte = pdp11_rom_try_write_byte,
+            ._try_map = pdp11_rom_try_map,
         }
     );
 }
@@ -0,0 +1,158 @@
+#include "pdp11/pdp11_scheduler.h"
+
+/*************
+ ** private **
+ *************/
+
+static inline bool pdp11_scheduler_is_before(
+    Pdp11SchedulerEntry const *const a,
+    Pdp11SchedulerEntry const *const b
+) {
+    return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+static inline void pdp11_scheduler_swap(
+    Pdp11Scheduler *const self,
+    unsigned const i,
+    unsigned const j
+) {
+    Pdp11SchedulerEntry const entry = self->_heap[i];
+    self->_heap[i] = self->_heap[j];
+    self->_heap[j] = entry;
+}
+
+static void pdp11_scheduler_sift_up(Pdp11Scheduler *const self, unsigned i) {
+    for (unsigned parent; i != 0; i = parent) {
+        parent = (i - 1) / 2;
+        if (!pdp11_scheduler_is_before(self->_heap + i, self->_heap + parent))
+            break;
+        pdp11_scheduler_swap(self, i, parent);
+    }
+}
+static void pdp11_scheduler_sift_down(Pdp11Scheduler *const self, unsigned i) {
+    while (true) {
+        unsigned min = i;
+        for (unsigned child = 2 * i + 1; child <= 2 * i + 2; child++)
+            if (child < self->_len &&
+                pdp11_scheduler_is_before(
+                    self->_heap + child,
+                    self->_heap + min
+                ))
+                min = child;
+        if (min == i) break;
+        pdp11_scheduler_swap(self, i, min);
+        i = min;
+    }
+}
+
+// Assumes the lock is held.
+static void pdp11_scheduler_update_next(Pdp11Scheduler *const self) {
+    atomic_store_explicit(
+        &self->_next,
+        self->_len == 0 ? PDP11_SCHEDULER_NEVER : self->_heap[0].time,
+        memory_order_release
+    );
+}
+
+/* Pops the earliest event if it is due, and outputs it. The lock is not held
+ * while it fires, so that it may schedule others. */
+static bool
+pdp11_scheduler_pop_due(Pdp11Scheduler *const self, Pdp11Event *const out) {
+    bool is_due;
+    pthread_mutex_lock(&self->_lock);
+    {
+        is_due = self->_len != 0 &&
+                 self->_heap[0].time <= pdp11_scheduler_now(self);
+        if (is_due) {
+            *out = self->_heap[0].event;
+            self->_heap[0] = self->_heap[--self->_len];
+            pdp11_scheduler_sift_down(self, 0);
+            pdp11_scheduler_update_next(self);
+        }
+    }
+    pthread_mutex_unlock(&self->_lock);
+    return is_due;
+}
+static void pdp11_scheduler_fire_due(Pdp11Scheduler *const self) {
+    for (Pdp11Event event; pdp11_scheduler_pop_due(self, &event);)
+        event.fire(event.ctx, event.data);
+}
+
+/************
+ ** public **
+ ************/
+
+Result pdp11_scheduler_init(Pdp11Scheduler *const self) {
+    if (pthread_mutex_init(&self->_lock, NULL) != 0) return UnknownErr;
+
+    atomic_init(&self->_now, 0);
+    atomic_init(&self->_next, PDP11_SCHEDULER_NEVER);
+    self->_seq = 0;
+    self->_len = 0;
+
+    return Ok;
+}
+void pdp11_scheduler_uninit(Pdp11Scheduler *const self) {
+    pthread_mutex_destroy(&self->_lock);
+    self->_len = 0;
+}
+
+Result pdp11_scheduler_schedule(
+    Pdp11Scheduler *const self,
+    uint64_t const delay,
+    Pdp11Event const event,
+    bool *const out_is_earliest
+) {
+    Result result = Ok;
+    pthread_mutex_lock(&self->_lock);
+    {
+        if (self->_len == PDP11_SCHEDULER_LEN) {
+            result = RangeErr;
+        } else {
+            unsigned const i = self->_len++;
+            self->_heap[i] = (Pdp11SchedulerEntry){
+                .time = pdp11_scheduler_now(self) + delay,
+                .seq = self->_seq++,
+                .event = event,
+            };
+            pdp11_scheduler_sift_up(self, i);
+            pdp11_scheduler_update_next(self);
+            if (out_is_earliest)
+                *out_is_earliest = self->_heap[0].seq == self->_seq - 1;
+        }
+    }
+    pthread_mutex_unlock(&self->_lock);
+    return result;
+}
+void pdp11_scheduler_cancel(
+    Pdp11Scheduler *const self,
+    Pdp11Event const event
+) {
+    pthread_mutex_lock(&self->_lock);
+    {
+        unsigned len = 0;
+        for (unsigned i = 0; i < self->_len; i++)
+            if (self->_heap[i].event.fire != event.fire ||
+                self->_heap[i].event.ctx != event.ctx)
+                self->_heap[len++] = self->_heap[i];
+        self->_len = len;
+
+        for (unsigned i = len / 2; i-- > 0;)
+            pdp11_scheduler_sift_down(self, i);
+        pdp11_scheduler_update_next(self);
+    }
+    pthread_mutex_unlock(&self->_lock);
+}
+
+void pdp11_scheduler_advance(Pdp11Scheduler *const self, uint64_t const delta) {
+    uint64_t const now = pdp11_scheduler_now(self) + delta;
+    atomic_store_explicit(&self->_now, now, memory_order_relaxed);
+    if (pdp11_scheduler_next(self) <= now) pdp11_scheduler_fire_due(self);
+}
+void pdp11_scheduler_skip(Pdp11Scheduler *const self) {
+    uint64_t const next = pdp11_scheduler_next(self);
+    if (next == PDP11_SCHEDULER_NEVER) return;
+
+    if (next > pdp11_scheduler_now(self))
+        atomic_store_explicit(&self->_now, next, memory_order_relaxed);
+    pdp11_scheduler_fire_due(self);
+}
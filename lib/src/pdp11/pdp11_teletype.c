@@ -2,8 +2,6 @@
 
 #include <stdlib.h>
 
-#include <unistd.h>
-
 #include "bits.h"
 
 /*************
@@ -21,34 +19,37 @@ static uint16_t pdp11_teletype_printer_status_to_word(
     return self.ready << 7 | self.intr_enable << 6 | self.maintenance << 2;
 }
 
-static void pdp11_teletype_printer_thread_helper(Pdp11Teletype *const self) {
-    FILE *const file = fopen("tty", "w");
+static void pdp11_teletype_print(void *const vself, uint16_t const) {
+    Pdp11Teletype *const self = vself;
 
-    while (true) {
-        while (self->_printer_status.ready) sleep(0);
+    fputc(self->_printer_buffer, self->_printer_file);
+    fflush(self->_printer_file);
 
-        fputc(self->_printer_buffer, file), fflush(file);
+    self->_printer_status.ready = true;
+    if (self->_printer_status.intr_enable)
+        unibus_br_intr(self->_unibus, self->_printer_intr_vec);
+}
+static void pdp11_teletype_type(void *const vself, uint16_t const c) {
+    Pdp11Teletype *const self = vself;
 
-        pthread_mutex_lock(&self->_printer_lock);
-        {
-            self->_printer_status.ready = true;
+    self->_keyboar_buffer = c;
+    self->_keyboard_status.done = true;
+    if (self->_keyboard_status.intr_enable)
+        unibus_br_intr(self->_unibus, self->_keyboard_intr_vec);
+}
 
-            if (self->_printer_status.intr_enable)
-                unibus_br_intr(
-                    self->_unibus,
-                    self->_intr_priority,
-                    self,
-                    self->_printer_intr_vec
-                );
-        }
-        pthread_mutex_unlock(&self->_printer_lock);
+static void pdp11_teletype_write_printer_buffer(
+    Pdp11Teletype *const self,
+    uint8_t const c
+) {
+    Pdp11Event const print = {.fire = pdp11_teletype_print, .ctx = self};
 
-        usleep(1000000 / 10 / 10);
-    }
+    // NOTE a character written before the last one is printed replaces it
+    unibus_cancel(self->_unibus, print);
+    self->_printer_status.ready = false;
+    self->_printer_buffer = c;
+    unibus_schedule(self->_unibus, PDP11_TELETYPE_PRINTER_CHAR_NS, print);
 }
-static void *pdp11_teletype_printer_thread(void *const vself) {
-    return pdp11_teletype_printer_thread_helper(vself), NULL;
-};
 
 /************
  ** public **
@@ -61,10 +62,11 @@ Result pdp11_teletype_init(
     uint8_t const keyboard_intr_vec,
     uint8_t const printer_intr_vec,
     unsigned const intr_priority,
-    size_t const
+    FILE *const printer_file
 ) {
-    // self->_buf = malloc(buf_len * elsizeof(self->_buf));
-    // if (!self->_buf) return OutOfMemErr;
+    // NOTE the keyboard comes first down the chain
+    UNROLL(unibus_attach_br(unibus, intr_priority, keyboard_intr_vec));
+    UNROLL(unibus_attach_br(unibus, intr_priority, printer_intr_vec));
 
     self->_keyboard_status = (Pdp11TeletypeKeyboardStatus){0};
     self->_keyboar_buffer = 0;
@@ -74,45 +76,36 @@ Result pdp11_teletype_init(
     self->_starting_addr = starting_addr;
     self->_keyboard_intr_vec = keyboard_intr_vec;
     self->_printer_intr_vec = printer_intr_vec;
-    self->_intr_priority = intr_priority;
 
     self->_unibus = unibus;
 
-    if (pthread_mutex_init(&self->_keyboard_lock, NULL) != 0 ||
-        pthread_mutex_init(&self->_printer_lock, NULL) != 0 ||
-        pthread_create(
-            &self->_thread,
-            NULL,
-            pdp11_teletype_printer_thread,
-            self
-        ) != 0)
-        return UnknownErr;
+    self->_printer_file = printer_file;
 
     return Ok;
 }
 void pdp11_teletype_uninit(Pdp11Teletype *const self) {
-    pthread_cancel(self->_thread);
-    pthread_mutex_destroy(&self->_keyboard_lock);
-    pthread_mutex_destroy(&self->_printer_lock);
-
-    // free(self->_buf);
+    unibus_cancel(
+        self->_unibus,
+        (Pdp11Event){.fire = pdp11_teletype_print, .ctx = self}
+    );
+    unibus_cancel(
+        self->_unibus,
+        (Pdp11Event){.fire = pdp11_teletype_type, .ctx = self}
+    );
+    self->_printer_file = NULL;
 }
 
 void pdp11_teletype_putc(Pdp11Teletype *const self, char const c) {
-    pthread_mutex_lock(&self->_keyboard_lock);
-    {
-        self->_keyboar_buffer = c;
-        self->_keyboard_status.done = true;
-
-        if (self->_keyboard_status.intr_enable)
-            unibus_br_intr(
-                self->_unibus,
-                self->_intr_priority,
-                self,
-                self->_keyboard_intr_vec
-            );
-    }
-    pthread_mutex_unlock(&self->_keyboard_lock);
+    // NOTE typed in the CPU thread, as everything else the device does
+    unibus_schedule(
+        self->_unibus,
+        0,
+        (Pdp11Event){
+            .fire = pdp11_teletype_type,
+            .ctx = self,
+            .data = (uint8_t)c,
+        }
+    );
 }
 
 /***************
@@ -120,21 +113,19 @@ void pdp11_teletype_putc(Pdp11Teletype *const self, char const c) {
  ***************/
 
 static void pdp11_teletype_reset(Pdp11Teletype *const self) {
-    pthread_mutex_lock(&self->_keyboard_lock);
-    pthread_mutex_lock(&self->_printer_lock);
-    {
-        self->_keyboard_status = (Pdp11TeletypeKeyboardStatus){
-            .done = false,
-            .intr_enable = false,
-        };
-        self->_printer_status = (Pdp11TeletypePrinterStatus){
-            .ready = true,
-            .intr_enable = false,
-            .maintenance = false,
-        };
-    }
-    pthread_mutex_unlock(&self->_printer_lock);
-    pthread_mutex_unlock(&self->_keyboard_lock);
+    unibus_cancel(
+        self->_unibus,
+        (Pdp11Event){.fire = pdp11_teletype_print, .ctx = self}
+    );
+    self->_keyboard_status = (Pdp11TeletypeKeyboardStatus){
+        .done = false,
+        .intr_enable = false,
+    };
+    self->_printer_status = (Pdp11TeletypePrinterStatus){
+        .ready = true,
+        .intr_enable = false,
+        .maintenance = false,
+    };
 }
 static bool pdp11_teletype_try_read(
     Pdp11Teletype *const self,
@@ -144,35 +135,18 @@ static bool pdp11_teletype_try_read(
     addr -= self->_starting_addr;
     if (!(addr < 8)) return false;
 
-    if (addr < 4) {
-        pthread_mutex_lock(&self->_keyboard_lock);
-        {
-            switch (addr) {
-            case 0:
-                *out = pdp11_teletype_keyboard_status_to_word(
-                    self->_keyboard_status
-                );
-                break;
-            case 2: {
-                self->_keyboard_status.done = false;
-                *out = self->_keyboar_buffer;
-            } break;
-            }
-        }
-        pthread_mutex_unlock(&self->_keyboard_lock);
-    } else {
-        pthread_mutex_lock(&self->_printer_lock);
-        {
-            switch (addr) {
-            case 4:
-                *out =
-                    pdp11_teletype_printer_status_to_word(self->_printer_status
-                    );
-                break;
-            case 6: *out = 0; break;
-            }
-        }
-        pthread_mutex_unlock(&self->_printer_lock);
+    switch (addr) {
+    case 0:
+        *out = pdp11_teletype_keyboard_status_to_word(self->_keyboard_status);
+        break;
+    case 2: {
+        self->_keyboard_status.done = false;
+        *out = self->_keyboar_buffer;
+    } break;
+    case 4:
+        *out = pdp11_teletype_printer_status_to_word(self->_printer_status);
+        break;
+    case 6: *out = 0; break;
     }
     return true;
 }
@@ -184,33 +158,17 @@ static bool pdp11_teletype_try_write_word(
     addr -= self->_starting_addr;
     if (!(addr < 8)) return false;
 
-    if (addr < 4) {
-        pthread_mutex_lock(&self->_keyboard_lock);
-        {
-            switch (addr) {
-            case 0: {
-                self->_keyboard_status.intr_enable = BIT(val, 6);
-                if (BIT(val, 0)) self->_keyboard_status.done = false;
-            } break;
-            case 2: self->_keyboard_status.done = false; break;
-            }
-        }
-        pthread_mutex_unlock(&self->_keyboard_lock);
-    } else {
-        pthread_mutex_lock(&self->_printer_lock);
-        {
-            switch (addr) {
-            case 4:
-                self->_printer_status.intr_enable = BIT(val, 6);
-                self->_printer_status.maintenance = BIT(val, 2);
-                break;
-            case 6:
-                self->_printer_status.ready = false;
-                self->_printer_buffer = val;
-                break;
-            }
-        }
-        pthread_mutex_unlock(&self->_printer_lock);
+    switch (addr) {
+    case 0: {
+        self->_keyboard_status.intr_enable = BIT(val, 6);
+        if (BIT(val, 0)) self->_keyboard_status.done = false;
+    } break;
+    case 2: self->_keyboard_status.done = false; break;
+    case 4:
+        self->_printer_status.intr_enable = BIT(val, 6);
+        self->_printer_status.maintenance = BIT(val, 2);
+        break;
+    case 6: pdp11_teletype_write_printer_buffer(self, val); break;
     }
     return true;
 }
@@ -222,39 +180,35 @@ static bool pdp11_teletype_try_write_byte(
     addr -= self->_starting_addr;
     if (!(addr < 8)) return false;
 
-    if (addr < 4) {
-        pthread_mutex_lock(&self->_keyboard_lock);
-        {
-            switch (addr) {
-            case 0: {
-                self->_keyboard_status.intr_enable = BIT(val, 6);
-                if (BIT(val, 0)) self->_keyboard_status.done = false;
-            } break;
-            case 1: break;
-            case 2 ... 3: self->_keyboard_status.done = false; break;
-            }
-        }
-        pthread_mutex_unlock(&self->_keyboard_lock);
-    } else {
-        pthread_mutex_lock(&self->_printer_lock);
-        {
-            switch (addr) {
-            case 4:
-                self->_printer_status.intr_enable = BIT(val, 6);
-                self->_printer_status.maintenance = BIT(val, 2);
-                break;
-            case 5: break;
-            case 6:
-                self->_printer_status.ready = false;
-                self->_printer_buffer = val;
-                break;
-            case 7: break;
-            }
-        }
-        pthread_mutex_unlock(&self->_printer_lock);
+    switch (addr) {
+    case 0: {
+        self->_keyboard_status.intr_enable = BIT(val, 6);
+        if (BIT(val, 0)) self->_keyboard_status.done = false;
+    } break;
+    case 1: break;
+    case 2 ... 3: self->_keyboard_status.done = false; break;
+    case 4:
+        self->_printer_status.intr_enable = BIT(val, 6);
+        self->_printer_status.maintenance = BIT(val, 2);
+        break;
+    case 5: break;
+    case 6: pdp11_teletype_write_printer_buffer(self, val); break;
+    case 7: break;
     }
     return true;
 }
+static bool pdp11_teletype_try_map(
+    Pdp11Teletype *const self,
+    uint16_t addr,
+    void volatile **const out_ptr
+) {
+    addr -= self->_starting_addr;
+    if (!(addr < 8)) return false;
+
+    *out_ptr = NULL;
+
+    return true;
+}
 UnibusDevice pdp11_teletype_ww_unibus_device(Pdp11Teletype *const self) {
     WRAP_BODY(
         UnibusDevice,
@@ -264,6 +218,7 @@ UnibusDevice pdp11_teletype_ww_unibus_device(Pdp11Teletype *const self) {
             ._try_read = pdp11_teletype_try_read,
             ._try_write_word = pdp11_teletype_try_write_word,
             ._try_write_byte = pdp11_teletype_try_write_byte,
+            ._try_map = pdp11_teletype_try_map,
         }
     );
 }
@@ -1,6 +1,8 @@
 #include "pdp11/unibus/unibus.h"
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <unistd.h>
 
@@ -38,17 +40,74 @@ static inline bool unibus_device_try_write_byte(
     return WRAPPER_CALL(_try_write_byte, self, addr, val);
 }
 
+static inline bool unibus_device_try_map(
+    UnibusDevice const *const self,
+    uint16_t const addr,
+    void volatile **const out_ptr
+) {
+    return WRAPPER_CALL(_try_map, self, addr, out_ptr);
+}
+
+static inline UnibusDevice const *
+unibus_device_at(Unibus const *const self, uint16_t const addr) {
+    return addr < UNIBUS_IO_PAGE_ADDR
+               ? self->_page_map[addr >> UNIBUS_PAGE_SHIFT]
+               : self->_io_map[(addr - UNIBUS_IO_PAGE_ADDR) >> 1];
+}
+static inline UnibusDevice const **
+unibus_device_slot(Unibus *const self, uint32_t const addr) {
+    return addr < UNIBUS_IO_PAGE_ADDR
+               ? self->_page_map + (addr >> UNIBUS_PAGE_SHIFT)
+               : self->_io_map + ((addr - UNIBUS_IO_PAGE_ADDR) >> 1);
+}
+static inline uint32_t unibus_device_slot_size(uint32_t const addr) {
+    return addr < UNIBUS_IO_PAGE_ADDR ? 1u << UNIBUS_PAGE_SHIFT : 2;
+}
+// Whether `addr` may start or end the range of a device.
+static inline bool unibus_is_slot_boundary(uint32_t const addr) {
+    uint32_t const align =
+        addr <= UNIBUS_IO_PAGE_ADDR ? 1u << UNIBUS_PAGE_SHIFT : 2;
+    return addr % align == 0;
+}
+
+/* Host memory behind the words from `addr` up to `end`, if a single device
+ * maps all of them, and contiguously. */
+static uint16_t volatile *unibus_map_run(
+    Unibus const *const self,
+    uint16_t const addr,
+    uint32_t const end
+) {
+    UnibusDevice const *const device = unibus_device_at(self, addr);
+    if (!device) return NULL;
+    for (uint32_t slot_addr = addr; slot_addr < end;
+         slot_addr = (slot_addr | (unibus_device_slot_size(slot_addr) - 1)) + 1)
+        if (unibus_device_at(self, slot_addr) != device) return NULL;
+
+    void volatile *first, *last;
+    if (!unibus_device_try_map(device, addr, &first) || !first ||
+        !unibus_device_try_map(device, end - 2, &last) ||
+        (uint8_t volatile *)last - (uint8_t volatile *)first != end - 2 - addr)
+        return NULL;
+    return first;
+}
+
+/* The CPU keeps the condition codes lazily, so they are synced before the
+ * CPU itself accesses the PSW through the bus. */
+static void unibus_sync_cpu_psw(Unibus const *const self) {
+    if (self->_master == UNIBUS_DEVICE_CPU) pdp11_cpu_sync_flags(self->_cpu);
+}
+
 static bool unibus_try_read(
     Unibus const *const self,
     uint16_t const addr,
     uint16_t *const out
 ) {
     if (addr == UNIBUS_CPU_PSW_ADDRESS)
-        return *out = pdp11_psw_to_word(&pdp11_cpu_psw(self->_cpu)), true;
+        return unibus_sync_cpu_psw(self),
+               *out = pdp11_psw_to_word(&pdp11_cpu_psw(self->_cpu)), true;
 
-    foreach (device_ptr, self->devices, self->devices + UNIBUS_DEVICE_COUNT)
-        if (unibus_device_try_read(device_ptr, addr, out)) return true;
-    return false;
+    UnibusDevice const *const device = unibus_device_at(self, addr);
+    return device && unibus_device_try_read(device, addr, out);
 }
 static bool unibus_try_write_word(
     Unibus const *const self,
@@ -56,11 +115,15 @@ static bool unibus_try_write_word(
     uint16_t const val
 ) {
     if (addr == UNIBUS_CPU_PSW_ADDRESS)
-        return pdp11_psw_set(&pdp11_cpu_psw(self->_cpu), val), true;
+        return unibus_sync_cpu_psw(self),
+               pdp11_psw_set(&pdp11_cpu_psw(self->_cpu), val),
+               pdp11_cpu_raise_attention(self->_cpu, PDP11_CPU_ATTENTION_PSW),
+               true;
 
-    foreach (device_ptr, self->devices, self->devices + UNIBUS_DEVICE_COUNT)
-        if (unibus_device_try_write_word(device_ptr, addr, val)) return true;
-    return false;
+    UnibusDevice const *const device = unibus_device_at(self, addr);
+    if (!device || !unibus_device_try_write_word(device, addr, val))
+        return false;
+    return pdp11_cpu_note_write(self->_cpu, addr), true;
 }
 static bool unibus_try_write_byte(
     Unibus const *const self,
@@ -68,40 +131,163 @@ static bool unibus_try_write_byte(
     uint8_t const val
 ) {
     if (addr == UNIBUS_CPU_PSW_ADDRESS)
-        return pdp11_psw_set(
+        return unibus_sync_cpu_psw(self),
+               pdp11_psw_set(
                    &pdp11_cpu_psw(self->_cpu),
                    (pdp11_psw_to_word(&pdp11_cpu_psw(self->_cpu)) & 0xFF00) |
                        val
                ),
+               pdp11_cpu_raise_attention(self->_cpu, PDP11_CPU_ATTENTION_PSW),
                true;
 
-    foreach (device_ptr, self->devices, self->devices + UNIBUS_DEVICE_COUNT)
-        if (unibus_device_try_write_byte(device_ptr, addr, val)) return true;
-    return false;
+    UnibusDevice const *const device = unibus_device_at(self, addr);
+    if (!device || !unibus_device_try_write_byte(device, addr, val))
+        return false;
+    return pdp11_cpu_note_write(self->_cpu, addr), true;
 }
 
-/* Assumes SACK is locked. Unlocks SACK. Locks BBSY. */
-static void unibus_switch_to_next_master(Unibus *const self) {
-    pthread_mutex_lock(&self->_bbsy);
-    self->_master = self->_next_master;
-    self->_next_master = UNIBUS_DEVICE_CPU;
-    pthread_mutex_unlock(&self->_sack);
+#if defined(__x86_64__) || defined(__i386__)
+#  define unibus_spin_pause() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#  define unibus_spin_pause() __asm__ volatile("yield")
+#else
+#  define unibus_spin_pause() ((void)0)
+#endif
+
+// Bits of `_grant`.
+typedef enum UnibusGrant {
+    UNIBUS_GRANT_BBSY = 1 << 0,
+    UNIBUS_GRANT_SACK = 1 << 1,
+    UNIBUS_GRANT_PARKED = 1 << 2,  // NOTE the rest is the count
+} UnibusGrant;
+
+/* Atomically sets the `set` bits and clears the `clear` ones, unless any of
+ * the `busy` bits are set. Outputs the grant word it has changed. */
+static inline bool unibus_try_grant(
+    Unibus *const self,
+    uint32_t const busy,
+    uint32_t const set,
+    uint32_t const clear,
+    uint32_t *const out_old
+) {
+    uint32_t grant = atomic_load_explicit(&self->_grant, memory_order_relaxed);
+    do
+        if (grant & busy) return false;
+    while (!atomic_compare_exchange_weak_explicit(
+        &self->_grant,
+        &grant,
+        (grant | set) & ~clear,
+        memory_order_acquire,
+        memory_order_relaxed
+    ));
+    return *out_old = grant, true;
 }
-/* Assumes BBSY is locked. Unlocks BSSY. */
-static void unibus_drop_current_master(Unibus *const self) {
+static void unibus_unpark(Unibus *const self) {
+    pthread_mutex_lock(&self->_park_lock);
+    pthread_cond_broadcast(&self->_unparked);
+    pthread_mutex_unlock(&self->_park_lock);
+}
+/* Same as `unibus_try_grant`, but waits for the `busy` bits to clear, spinning
+ * for a bit before going to sleep. */
+static void unibus_wait_grant(
+    Unibus *const self,
+    uint32_t const busy,
+    uint32_t const set,
+    uint32_t const clear
+) {
+    uint32_t old, parked = 0;
+    for (unsigned i = 0; i < self->_spin_count; i++) {
+        if (unibus_try_grant(self, busy, set, clear, &old)) goto granted;
+        unibus_spin_pause();
+    }
+
+    // NOTE the count goes up in the same word that gets changed on release, so
+    // whoever releases either sees the count or is seen by the check below
+    pthread_mutex_lock(&self->_park_lock);
+    atomic_fetch_add(&self->_grant, parked = UNIBUS_GRANT_PARKED);
+    while (!unibus_try_grant(self, busy, set, clear, &old))
+        pthread_cond_wait(&self->_unparked, &self->_park_lock);
+    atomic_fetch_sub(&self->_grant, UNIBUS_GRANT_PARKED);
+    pthread_mutex_unlock(&self->_park_lock);
+
+granted:
+    // NOTE clearing is releasing, so anyone else sleeping may go on
+    if (clear && old - parked >= UNIBUS_GRANT_PARKED) unibus_unpark(self);
+}
+
+/* Asserts BBSY for `master`. An idle bus is taken right away, otherwise
+ * `master` asserts SACK first, to be the next one to get BBSY. */
+static void unibus_become_master(Unibus *const self, void const *const master) {
+    uint32_t old;
+    if (!unibus_try_grant(
+            self,
+            UNIBUS_GRANT_BBSY | UNIBUS_GRANT_SACK,
+            UNIBUS_GRANT_BBSY,
+            0,
+            &old
+        )) {
+        unibus_wait_grant(self, UNIBUS_GRANT_SACK, UNIBUS_GRANT_SACK, 0);
+        self->_next_master = master;
+        // NOTE an owning CPU releases the bus at the end of its run
+        pdp11_cpu_raise_attention(self->_cpu, PDP11_CPU_ATTENTION_BUS);
+        unibus_wait_grant(
+            self,
+            UNIBUS_GRANT_BBSY,
+            UNIBUS_GRANT_BBSY,
+            UNIBUS_GRANT_SACK
+        );
+        self->_next_master = UNIBUS_DEVICE_CPU;
+    }
+    self->_master = master;
+}
+/* Assumes BBSY is asserted. Negates BBSY. */
+static void unibus_drop_master(Unibus *const self) {
     self->_master = UNIBUS_DEVICE_CPU;
-    pthread_mutex_unlock(&self->_bbsy);
+    uint32_t const old = atomic_fetch_and_explicit(
+        &self->_grant,
+        ~(uint32_t)UNIBUS_GRANT_BBSY,
+        memory_order_release
+    );
+    if (old >= UNIBUS_GRANT_PARKED) unibus_unpark(self);
 }
 
-/* Locks BBSY. */
+// The bus the calling thread owns as the CPU, if any.
+static _Thread_local Unibus const *unibus_cpu_owned = NULL;
+
+/* Asserts BBSY, unless the calling thread owns the bus. */
 static void unibus_switch_to_cpu_master(Unibus *const self) {
-    pthread_mutex_lock(&self->_bbsy);
-    assert(self->_master == UNIBUS_DEVICE_CPU);
+    if (unibus_cpu_owned == self) return;
+    unibus_become_master(self, UNIBUS_DEVICE_CPU);
 }
-/* Assumes BBSY is locked. Unlocks BSSY. */
+/* Assumes BBSY is asserted. Negates BBSY, unless the calling thread owns the
+ * bus. */
 static void unibus_drop_cpu_master(Unibus *const self) {
     assert(self->_master == UNIBUS_DEVICE_CPU);
-    pthread_mutex_unlock(&self->_bbsy);
+    if (unibus_cpu_owned == self) return;
+    unibus_drop_master(self);
+}
+
+/* Asserts BBSY for `device`. Unless the calling thread owns the bus as the
+ * CPU, e.g. firing an event between two instructions, in which case `device`
+ * becomes master for as long as the CPU lets it. */
+static void
+unibus_switch_to_npr_master(Unibus *const self, void const *const device) {
+    if (unibus_cpu_owned != self) {
+        unibus_become_master(self, device);
+        return;
+    }
+    // NOTE as the CPU would on letting the bus go
+    pdp11_cpu_sync_flags(self->_cpu);
+    self->_master = device;
+}
+/* Assumes BBSY is asserted. Negates BBSY, unless the calling thread owns the
+ * bus, in which case it goes back to the CPU. */
+static void unibus_drop_npr_master(Unibus *const self) {
+    if (unibus_cpu_owned != self) {
+        unibus_drop_master(self);
+        return;
+    }
+    self->_master = UNIBUS_DEVICE_CPU;
 }
 
 /************
@@ -109,44 +295,150 @@ static void unibus_drop_cpu_master(Unibus *const self) {
  ************/
 
 void unibus_init(Unibus *const self, Pdp11Cpu *const cpu) {
-    pthread_mutex_init(&self->_sack, NULL);
-    pthread_mutex_init(&self->_bbsy, NULL);
+    atomic_init(&self->_grant, 0);
 
-    foreach (device_ptr, self->devices, self->devices + UNIBUS_DEVICE_COUNT)
-        *device_ptr = no_unibus_device();
+    self->_spin_count =
+        sysconf(_SC_NPROCESSORS_ONLN) > 1 ? UNIBUS_SPIN_COUNT : 0;
+    pthread_mutex_init(&self->_park_lock, NULL);
+    pthread_cond_init(&self->_unparked, NULL);
+
+    self->_devices = NULL;
+    foreach (slot, self->_page_map, self->_page_map + UNIBUS_PAGE_COUNT)
+        *slot = NULL;
+    foreach (slot, self->_io_map, self->_io_map + UNIBUS_IO_WORD_COUNT)
+        *slot = NULL;
+    atomic_init(&self->_br_pending, 0);
+    memset(self->_br_lines, 0, sizeof(self->_br_lines));
+    memset(self->_br_vectors, 0, sizeof(self->_br_vectors));
+    memset(self->_br_chain_lens, 0, sizeof(self->_br_chain_lens));
+    self->__transactions = 0;
     self->_cpu = cpu;
 
     self->_master = self->_next_master = UNIBUS_DEVICE_CPU;
 }
 void unibus_uninit(Unibus *const self) {
-    pthread_mutex_destroy(&self->_sack);
-    pthread_mutex_destroy(&self->_bbsy);
+    for (UnibusAttachedDevice *attached = self->_devices, *next; attached;
+         attached = next)
+        next = attached->_next, free(attached);
+    self->_devices = NULL;
+
+    pthread_mutex_destroy(&self->_park_lock);
+    pthread_cond_destroy(&self->_unparked);
 }
 void unibus_reset(Unibus *const self) {
     pdp11_cpu_reset(self->_cpu);
-    foreach (device_ptr, self->devices, self->devices + UNIBUS_DEVICE_COUNT)
-        unibus_device_reset(device_ptr);
+    for (UnibusAttachedDevice const *attached = self->_devices; attached;
+         attached = attached->_next)
+        unibus_device_reset(&attached->device);
+    // NOTE INIT withdraws whatever the devices have requested
+    atomic_store(&self->_br_pending, 0);
 }
 
-void unibus_br_intr(
+Result unibus_attach(
+    Unibus *const self,
+    UnibusDevice const device,
+    uint16_t const starting_addr,
+    uint32_t const size
+) {
+    uint32_t const end = (uint32_t)starting_addr + size;
+    // NOTE slots are covered whole, so that no two devices share a slot
+    if (size == 0 || end > 0200000 ||
+        !unibus_is_slot_boundary(starting_addr) ||
+        !unibus_is_slot_boundary(end))
+        return RangeErr;
+
+    for (uint32_t addr = starting_addr; addr < end;
+         addr += unibus_device_slot_size(addr))
+        if (*unibus_device_slot(self, addr)) return StateErr;
+
+    UnibusAttachedDevice *const attached =
+        malloc(sizeof(UnibusAttachedDevice));
+    if (!attached) return OutOfMemErr;
+    *attached = (UnibusAttachedDevice){.device = device, ._next = NULL};
+
+    UnibusAttachedDevice **tail = &self->_devices;
+    while (*tail) tail = &(*tail)->_next;
+    *tail = attached;
+
+    for (uint32_t addr = starting_addr; addr < end;
+         addr += unibus_device_slot_size(addr))
+        *unibus_device_slot(self, addr) = &attached->device;
+    return Ok;
+}
+
+Result unibus_attach_br(
     Unibus *const self,
     unsigned const priority,
-    void const *const device,
-    uint8_t const intr
-) {
-    // br
-    pthread_mutex_lock(&self->_sack);
-    pdp11_psw_wait_for_sufficient_priority(
-        &self->_cpu->_psw,
-        priority,
-        &self->_sack
+    uint8_t const vector
+) {
+    if (priority == 0 || priority >= UNIBUS_BR_LEVEL_COUNT || vector & 3)
+        return RangeErr;
+
+    UnibusBrLine *const line = self->_br_lines + (vector >> 2);
+    uint8_t *const chain_len = self->_br_chain_lens + priority;
+    if (line->level != 0 || *chain_len == UNIBUS_BR_CHAIN_LEN)
+        return StateErr;
+
+    *line = (UnibusBrLine){.level = priority, .position = *chain_len};
+    self->_br_vectors[priority][(*chain_len)++] = vector;
+    return Ok;
+}
+
+Result unibus_br_intr(Unibus *const self, uint8_t const vector) {
+    UnibusBrLine const line = self->_br_lines[vector >> 2];
+    if (line.level == 0 || vector & 3) return StateErr;
+
+    atomic_fetch_or(
+        &self->_br_pending,
+        (uint64_t)1 << (line.level * UNIBUS_BR_CHAIN_LEN + line.position)
     );
-    self->_next_master = device;
-    // intr
-    unibus_switch_to_next_master(self);
-    self->_master = UNIBUS_DEVICE_CPU;
-    pdp11_cpu_intr(self->_cpu, intr);
-    unibus_drop_current_master(self);
+    // NOTE the CPU reads the vector at its next instruction boundary, while
+    // it owns the bus anyway, so the device never has to become master
+    pdp11_cpu_intr(self->_cpu);
+    return Ok;
+}
+
+bool unibus_br_take(
+    Unibus *const self,
+    unsigned const priority,
+    uint8_t *const out_vector
+) {
+    if (!unibus_br_is_pending(self, priority)) return false;
+
+    uint64_t pending = atomic_load(&self->_br_pending), bit;
+    do {
+        uint64_t const eligible =
+            pending >> (priority + 1) * UNIBUS_BR_CHAIN_LEN
+                    << (priority + 1) * UNIBUS_BR_CHAIN_LEN;
+        if (eligible == 0) return false;
+
+        // NOTE the highest level is the highest byte, and the first device
+        // down its chain the lowest bit within it
+        unsigned const level = (63 - __builtin_clzll(eligible)) /
+                               UNIBUS_BR_CHAIN_LEN;
+        uint64_t const chain = eligible >> level * UNIBUS_BR_CHAIN_LEN;
+        bit = (chain & -chain) << level * UNIBUS_BR_CHAIN_LEN;
+    } while (!atomic_compare_exchange_weak(
+        &self->_br_pending,
+        &pending,
+        pending & ~bit
+    ));
+
+    unsigned const i = __builtin_ctzll(bit);
+    *out_vector = self->_br_vectors[i / UNIBUS_BR_CHAIN_LEN]
+                                   [i % UNIBUS_BR_CHAIN_LEN];
+    return true;
+}
+
+Result unibus_schedule(
+    Unibus *const self,
+    uint64_t const delay,
+    Pdp11Event const event
+) {
+    return pdp11_cpu_schedule(self->_cpu, delay, event);
+}
+void unibus_cancel(Unibus *const self, Pdp11Event const event) {
+    pdp11_cpu_cancel(self->_cpu, event);
 }
 
 Result unibus_npr_dati(
@@ -156,13 +448,12 @@ Result unibus_npr_dati(
     uint16_t *const out
 ) {
     // npr
-    pthread_mutex_lock(&self->_sack);
-    self->_next_master = device;
+    unibus_switch_to_npr_master(self, device);
+    self->__transactions++;
     // dati
-    unibus_switch_to_next_master(self);
     if ((addr & 1) == 1 || !unibus_try_read(self, addr, out))
-        return unibus_drop_current_master(self), UnknownErr;
-    unibus_drop_current_master(self);
+        return unibus_drop_npr_master(self), UnknownErr;
+    unibus_drop_npr_master(self);
     return Ok;
 }
 Result unibus_npr_dato(
@@ -172,13 +463,12 @@ Result unibus_npr_dato(
     uint16_t const data
 ) {
     // npr
-    pthread_mutex_lock(&self->_sack);
-    self->_next_master = device;
+    unibus_switch_to_npr_master(self, device);
+    self->__transactions++;
     // dato
-    unibus_switch_to_next_master(self);
     if ((addr & 1) == 1 || !unibus_try_write_word(self, addr, data))
-        return unibus_drop_current_master(self), UnknownErr;
-    unibus_drop_current_master(self);
+        return unibus_drop_npr_master(self), UnknownErr;
+    unibus_drop_npr_master(self);
     return Ok;
 }
 Result unibus_npr_datob(
@@ -188,19 +478,94 @@ Result unibus_npr_datob(
     uint8_t const data
 ) {
     // npr
-    pthread_mutex_lock(&self->_sack);
-    self->_next_master = device;
+    unibus_switch_to_npr_master(self, device);
+    self->__transactions++;
     // dato
-    unibus_switch_to_next_master(self);
     if (!unibus_try_write_byte(self, addr, data))
-        return unibus_drop_current_master(self), UnknownErr;
-    unibus_drop_current_master(self);
+        return unibus_drop_npr_master(self), UnknownErr;
+    unibus_drop_npr_master(self);
+    return Ok;
+}
+
+Result unibus_npr_dati_block(
+    Unibus *const self,
+    void const *const device,
+    uint16_t addr,
+    uint16_t *buf,
+    size_t len
+) {
+    if ((addr & 1) == 1 || addr + 2 * len > 0200000) return UnknownErr;
+
+    while (len != 0) {
+        size_t const burst_len =
+            len < UNIBUS_NPR_BURST_LEN ? len : UNIBUS_NPR_BURST_LEN;
+        uint32_t const end = addr + 2 * burst_len;
+
+        // npr
+        unibus_switch_to_npr_master(self, device);
+        self->__transactions += burst_len;
+        // dati, for the whole burst
+        uint16_t volatile const *const ptr = unibus_map_run(self, addr, end);
+        if (ptr) memcpy(buf, (void const *)ptr, 2 * burst_len);
+        else
+            for (size_t i = 0; i < burst_len; i++)
+                if (!unibus_try_read(self, addr + 2 * i, buf + i))
+                    return unibus_drop_npr_master(self), UnknownErr;
+        unibus_drop_npr_master(self);
+
+        addr += 2 * burst_len, buf += burst_len, len -= burst_len;
+    }
+    return Ok;
+}
+Result unibus_npr_dato_block(
+    Unibus *const self,
+    void const *const device,
+    uint16_t addr,
+    uint16_t const *buf,
+    size_t len
+) {
+    if ((addr & 1) == 1 || addr + 2 * len > 0200000) return UnknownErr;
+
+    while (len != 0) {
+        size_t const burst_len =
+            len < UNIBUS_NPR_BURST_LEN ? len : UNIBUS_NPR_BURST_LEN;
+        uint32_t const end = addr + 2 * burst_len;
+
+        // npr
+        unibus_switch_to_npr_master(self, device);
+        self->__transactions += burst_len;
+        // dato, for the whole burst
+        uint16_t volatile *const ptr = unibus_map_run(self, addr, end);
+        if (ptr) {
+            memcpy((void *)ptr, buf, 2 * burst_len);
+            pdp11_cpu_note_write_run(self->_cpu, addr, end);
+        } else
+            for (size_t i = 0; i < burst_len; i++)
+                if (!unibus_try_write_word(self, addr + 2 * i, buf[i]))
+                    return unibus_drop_npr_master(self), UnknownErr;
+        unibus_drop_npr_master(self);
+
+        addr += 2 * burst_len, buf += burst_len, len -= burst_len;
+    }
     return Ok;
 }
 
+void unibus_cpu_acquire(Unibus *const self) {
+    assert(unibus_cpu_owned != self);
+    unibus_become_master(self, UNIBUS_DEVICE_CPU);
+    assert(self->_master == UNIBUS_DEVICE_CPU);
+    unibus_cpu_owned = self;
+}
+void unibus_cpu_release(Unibus *const self) {
+    assert(unibus_cpu_owned == self);
+    unibus_cpu_owned = NULL;
+    unibus_drop_master(self);
+}
+
 Result
 unibus_cpu_dati(Unibus *const self, uint16_t const addr, uint16_t *const out) {
     unibus_switch_to_cpu_master(self);
+    self->__transactions++;
     if ((addr & 1) == 1 || !unibus_try_read(self, addr, out))
         return unibus_drop_cpu_master(self), UnknownErr;
     unibus_drop_cpu_master(self);
@@ -209,6 +574,7 @@ unibus_cpu_dati(Unibus *const self, uint16_t const addr, uint16_t *const out) {
 Result
 unibus_cpu_dato(Unibus *const self, uint16_t const addr, uint16_t const data) {
     unibus_switch_to_cpu_master(self);
+    self->__transactions++;
     if ((addr & 1) == 1 || !unibus_try_write_word(self, addr, data))
         return unibus_drop_cpu_master(self), UnknownErr;
     unibus_drop_cpu_master(self);
@@ -217,8 +583,74 @@ unibus_cpu_dato(Unibus *const self, uint16_t const addr, uint16_t const data) {
 Result
 unibus_cpu_datob(Unibus *const self, uint16_t const addr, uint8_t const data) {
     unibus_switch_to_cpu_master(self);
+    self->__transactions++;
     if (!unibus_try_write_byte(self, addr, data))
         return unibus_drop_cpu_master(self), UnknownErr;
     unibus_drop_cpu_master(self);
     return Ok;
 }
+
+Result unibus_cpu_resolve(
+    Unibus const *const self,
+    uint16_t const addr,
+    bool const is_byte,
+    UnibusLoc *const out
+) {
+    if (!is_byte && (addr & 1) == 1) return UnknownErr;
+
+    // NOTE devices own whole words, so a byte is resolved by its word
+    uint16_t const word_addr = addr & ~(uint16_t)1;
+    *out = (UnibusLoc){.addr = addr, .ptr = NULL, .device = UNIBUS_DEVICE_CPU};
+    if (word_addr == UNIBUS_CPU_PSW_ADDRESS) return Ok;
+
+    UnibusDevice const *const device = unibus_device_at(self, word_addr);
+    if (!device || !unibus_device_try_map(device, word_addr, &out->ptr))
+        return UnknownErr;
+    return out->device = device, Ok;
+}
+uint16_t unibus_cpu_loc_dati(Unibus *const self, UnibusLoc const *const loc) {
+    uint16_t const word_addr = loc->addr & ~(uint16_t)1;
+    uint16_t data = 0;
+
+    unibus_switch_to_cpu_master(self);
+    self->__transactions++;
+    if (loc->ptr) data = *(uint16_t volatile *)loc->ptr;
+    else if (loc->device == UNIBUS_DEVICE_CPU)
+        unibus_try_read(self, word_addr, &data);
+    else unibus_device_try_read(loc->device, word_addr, &data);
+    unibus_drop_cpu_master(self);
+
+    return data;
+}
+void unibus_cpu_loc_dato(
+    Unibus *const self,
+    UnibusLoc const *const loc,
+    uint16_t const data
+) {
+    unibus_switch_to_cpu_master(self);
+    self->__transactions++;
+    if (loc->ptr)
+        *(uint16_t volatile *)loc->ptr = data,
+        pdp11_cpu_note_write(self->_cpu, loc->addr);
+    else if (loc->device == UNIBUS_DEVICE_CPU)
+        unibus_try_write_word(self, loc->addr, data);
+    else if (unibus_device_try_write_word(loc->device, loc->addr, data))
+        pdp11_cpu_note_write(self->_cpu, loc->addr);
+    unibus_drop_cpu_master(self);
+}
+void unibus_cpu_loc_datob(
+    Unibus *const self,
+    UnibusLoc const *const loc,
+    uint8_t const data
+) {
+    unibus_switch_to_cpu_master(self);
+    self->__transactions++;
+    if (loc->ptr)
+        ((uint8_t volatile *)loc->ptr)[loc->addr & 1] = data,
+        pdp11_cpu_note_write(self->_cpu, loc->addr);
+    else if (loc->device == UNIBUS_DEVICE_CPU)
+        unibus_try_write_byte(self, loc->addr, data);
+    else if (unibus_device_try_write_byte(loc->device, loc->addr, data))
+        pdp11_cpu_note_write(self->_cpu, loc->addr);
+    unibus_drop_cpu_master(self);
+}
@@ -18,6 +18,14 @@ no_unibus_device_try_write_byte(void *const, uint16_t const, uint8_t const) {
     return false;
 }
 
+static bool no_unibus_device_try_map(
+    void *const,
+    uint16_t const,
+    void volatile **const
+) {
+    return false;
+}
+
 UnibusDevice no_unibus_device(void) {
     void *const self = NULL;
     WRAP_BODY(
@@ -28,6 +36,7 @@ UnibusDevice no_unibus_device(void) {
             ._try_read = no_unibus_device_try_read,
             ._try_write_word = no_unibus_device_try_write_word,
             ._try_write_byte = no_unibus_device_try_write_byte,
+            ._try_map = no_unibus_device_try_map,
         }
     );
 }
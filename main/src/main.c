@@ -330,6 +330,11 @@ void run_console_ui(
         attron(A_BOLD | COLOR_PAIR(COLOR_PAIR_LABEL));
         mvprintw(0, (COLS - 28) / 2, "PDP-11/20 Operator Console");
         attroff(A_BOLD | COLOR_PAIR(COLOR_PAIR_LABEL));
+        mvprintw(
+            1,
+            (COLS - 12) / 2,
+            pdp11_cpu_speed(&pdp->cpu) == 0 ? "SPEED: TURBO" : "SPEED: REAL "
+        );
 
         draw_power_switch(
             12,
@@ -359,7 +364,8 @@ void run_console_ui(
                                " * L, E, C, H, S, D - load, exam, cont, "
                                "enbl/halt, start, deposit\n"
                                " * B - autoinsert bootloader\t"
-                               " * T - change paper tape;\n"
+                               " * T - change paper tape;\t"
+                               " * F - toggle turbo\n"
                                " * Tab/^I - into insert mode\t"
                                " * ^D - create memory dump\t"
                                " * Q - quit\n"
@@ -464,6 +470,14 @@ void run_console_ui(
             case 'B':
             case 'b': pdp11_console_insert_bootloader(&pdp->console); break;
 
+            case 'F':
+            case 'f':
+                pdp11_cpu_set_speed(
+                    &pdp->cpu,
+                    pdp11_cpu_speed(&pdp->cpu) == 0 ? 1 : 0
+                );
+                break;
+
             case 'T':
             case 't': {
                 def_prog_mode();
@@ -521,7 +535,13 @@ int main() {
     signal(SIGINT, ignore);
 
     Pdp11 pdp = {0};
-    UNROLL(pdp11_init(&pdp));
+    UNROLL(pdp11_init(&pdp, "core.ram", PDP11_CPU_ENGINE_THREADED, true));
+    // NOTE the console runs at the speed of a real 11/20 until turbo is on
+    pdp11_cpu_set_speed(&pdp.cpu, 1);
+#if PDP11_CPU_TRACE
+    pdp11_cpu_trace(&pdp.cpu)->options =
+        PDP11_CPU_TRACE_ON | PDP11_CPU_TRACE_DUMP_ON_HALT;
+#endif
 
     Pdp11PapertapeReader pr = {0};
     UNROLL_CLEANUP(
@@ -539,6 +559,15 @@ int main() {
         }
     );
 
+    // NOTE printed into a file, as the console takes the whole terminal
+    FILE *const tty_file = fopen("tty", "w");
+    if (!tty_file) {
+        pdp11_papertape_reader_uninit(&pr);
+        pdp11_uninit(&pdp);
+        fprintf(stderr, "error opening teletype output!\n"), fflush(stderr);
+        return FileUnavailableErr;
+    }
+
     Pdp11Teletype tty = {0};
     UNROLL_CLEANUP(
         pdp11_teletype_init(
@@ -548,9 +577,10 @@ int main() {
             PDP11_TELETYPE_KEYBOARD_INTR_VEC,
             PDP11_TELETYPE_PRINTER_INTR_VEC,
             PDP11_TELETYPE_INTR_PRIORITY,
-            -1
+            tty_file
         ),
         {
+            fclose(tty_file);
             pdp11_papertape_reader_uninit(&pr);
             pdp11_uninit(&pdp);
             fprintf(stderr, "error initializing papertape reader!\n"),
@@ -558,12 +588,42 @@ int main() {
         }
     );
 
-    pdp.periphs++[0] = pdp11_papertape_reader_ww_unibus_device(&pr);
-    pdp.periphs++[0] = pdp11_teletype_ww_unibus_device(&tty);
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &pdp.unibus,
+            pdp11_papertape_reader_ww_unibus_device(&pr),
+            PDP11_PAPERTAPE_READER_ADDR,
+            PDP11_PAPERTAPE_READER_SIZE
+        ),
+        {
+            pdp11_teletype_uninit(&tty);
+            fclose(tty_file);
+            pdp11_papertape_reader_uninit(&pr);
+            pdp11_uninit(&pdp);
+            fprintf(stderr, "error attaching papertape reader!\n"),
+                fflush(stderr);
+        }
+    );
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &pdp.unibus,
+            pdp11_teletype_ww_unibus_device(&tty),
+            PDP11_TELETYPE_ADDR,
+            PDP11_TELETYPE_SIZE
+        ),
+        {
+            pdp11_teletype_uninit(&tty);
+            fclose(tty_file);
+            pdp11_papertape_reader_uninit(&pr);
+            pdp11_uninit(&pdp);
+            fprintf(stderr, "error attaching teletype!\n"), fflush(stderr);
+        }
+    );
 
     run_console_ui(&pdp, &pr, &tty);
 
     pdp11_teletype_uninit(&tty);
+    fclose(tty_file);
     pdp11_papertape_reader_uninit(&pr);
     pdp11_uninit(&pdp);
 
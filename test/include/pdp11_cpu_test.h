@@ -1,6 +1,8 @@
 #ifndef TEST_CPU_H
 #define TEST_CPU_H
 
-int test_cpu_run(void);
+#include "pdp11/cpu/pdp11_cpu.h"
+
+int test_cpu_run(Pdp11CpuEngine const cpu_engine);
 
 #endif
@@ -1,13 +1,23 @@
 #include "pdp11_cpu_test.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
 #include <assert.h>
 #include <miunte.h>
-#include <unistd.h>
 
+// NOTE for the reference handlers, which the predecoded table is checked by
+#include "pdp11/cpu/pdp11_cpu_engine.h"
 #include "pdp11/cpu/pdp11_cpu_instr.h"
 #include "pdp11/pdp11.h"
+#include "pdp11/pdp11_console.h"
+#include "pdp11/pdp11_papertape_reader.h"
+#include "pdp11/pdp11_teletype.h"
 
 static Pdp11 pdp = {0};
+static Pdp11CpuEngine engine;
 
 /*************
  ** helpers **
@@ -22,8 +32,7 @@ static uint16_t pdp11_cpu_dop_ra_instr(
 
     pdp11_cpu_rx(&pdp.cpu, 0) = x;
     pdp11_cpu_rx(&pdp.cpu, 1) = y;
-    pdp11_cpu_single_step(&pdp.cpu);
-    while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+    pdp11_cpu_step(&pdp.cpu);
     return pdp11_cpu_rx(&pdp.cpu, 0);
 }
 static uint16_t pdp11_cpu_dop_da_instr(
@@ -37,8 +46,7 @@ static uint16_t pdp11_cpu_dop_da_instr(
     pdp11_cpu_rx(&pdp.cpu, 0) = addr;
     unibus_cpu_dato(&pdp.unibus, pdp11_cpu_rx(&pdp.cpu, 0), x);
     pdp11_cpu_rx(&pdp.cpu, 1) = y;
-    pdp11_cpu_single_step(&pdp.cpu);
-    while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+    pdp11_cpu_step(&pdp.cpu);
     uint16_t res;
     return unibus_cpu_dati(&pdp.unibus, pdp11_cpu_rx(&pdp.cpu, 0), &res), res;
 }
@@ -55,19 +63,242 @@ static uint16_t pdp11_cpu_dop_ia_instr(
     pdp11_cpu_rx(&pdp.cpu, 0) = addr;
     unibus_cpu_dato(&pdp.unibus, pdp11_cpu_rx(&pdp.cpu, 0) + off, x);
     pdp11_cpu_rx(&pdp.cpu, 1) = y;
-    pdp11_cpu_single_step(&pdp.cpu);
-    while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+    pdp11_cpu_step(&pdp.cpu);
     uint16_t res;
     return unibus_cpu_dati(&pdp.unibus, pdp11_cpu_rx(&pdp.cpu, 0) + off, &res),
            res;
 }
 
+// Puts `len` words from `words` into memory from `start` on.
+static void pdp11_cpu_test_load(
+    uint16_t const start,
+    uint16_t const *const words,
+    unsigned const len
+) {
+    for (unsigned i = 0; i < len; i++)
+        unibus_cpu_dato(&pdp.unibus, start + 2 * i, words[i]);
+}
+
+// Where `pdp11_cpu_test_load_intr` puts the vector and the handler.
+#define PDP11_CPU_TEST_INTR_VEC     (060)
+#define PDP11_CPU_TEST_INTR_HANDLER (0x200)
+
+/* Wires a BR line to `PDP11_CPU_TEST_INTR_VEC`, the handler of which runs
+ * `instr` and halts. */
+static Result pdp11_cpu_test_load_intr(uint16_t const instr) {
+    UNROLL(unibus_attach_br(&pdp.unibus, 04, PDP11_CPU_TEST_INTR_VEC));
+    uint16_t const vector[] = {PDP11_CPU_TEST_INTR_HANDLER, 0};
+    pdp11_cpu_test_load(PDP11_CPU_TEST_INTR_VEC, vector, lenof(vector));
+    uint16_t const handler[] = {instr, 0000000 /* halt */};
+    pdp11_cpu_test_load(PDP11_CPU_TEST_INTR_HANDLER, handler, lenof(handler));
+    return Ok;
+}
+
+// Halts the CPU, noting where it has got to.
+static void pdp11_cpu_test_halt_event(void *const vout, uint16_t const) {
+    uint64_t *const out = vout;
+    out[0] = pdp11_cpu_time(&pdp.cpu);
+    out[1] = pdp11_cpu_rx(&pdp.cpu, 0);
+    pdp11_cpu_halt(&pdp.cpu);
+}
+static void pdp11_cpu_test_intr_event(void *const, uint16_t const vec) {
+    unibus_br_intr(&pdp.unibus, vec);
+}
+/* Does what a DMA controller does once done, transfers to `addr` as the
+ * master and halts the CPU, noting if the transfers have gone through. */
+static void pdp11_cpu_test_npr_event(void *const vout, uint16_t const addr) {
+    bool *const out = vout;
+    uint16_t const block[] = {0xB10C, 0xB10D};
+    *out = unibus_npr_dato(&pdp.unibus, out, addr, 0xD00D) == Ok &&
+           unibus_npr_dato_block(
+               &pdp.unibus,
+               out,
+               addr + 2,
+               block,
+               lenof(block)
+           ) == Ok;
+    pdp11_cpu_halt(&pdp.cpu);
+}
+
+// Where the bundled paper tapes are, for the tests run from `test/`.
+#define PDP11_CPU_TEST_TAPES_DIR "../res/papertapes/"
+
+// A machine with a paper tape reader and a teletype, as `headless` has.
+typedef struct Pdp11CpuTestMachine {
+    Pdp11 pdp;
+    Pdp11PapertapeReader pr;
+    Pdp11Teletype tty;
+} Pdp11CpuTestMachine;
+
+// Puts the machine together on `cpu_engine`, its teletype printing to
+// `printer`.
+static Result pdp11_cpu_test_machine_init(
+    Pdp11CpuTestMachine *const self,
+    Pdp11CpuEngine const cpu_engine,
+    FILE *const printer
+) {
+    Pdp11 *const machine = &self->pdp;
+    UNROLL(pdp11_init(machine, NULL, cpu_engine, false));
+    UNROLL_CLEANUP(
+        pdp11_papertape_reader_init(
+            &self->pr,
+            &machine->unibus,
+            PDP11_PAPERTAPE_READER_ADDR,
+            PDP11_PAPERTAPE_READER_INTR_VEC,
+            PDP11_PAPERTAPE_READER_INTR_PRIORITY
+        ),
+        pdp11_uninit(machine)
+    );
+    UNROLL_CLEANUP(
+        pdp11_teletype_init(
+            &self->tty,
+            &machine->unibus,
+            PDP11_TELETYPE_ADDR,
+            PDP11_TELETYPE_KEYBOARD_INTR_VEC,
+            PDP11_TELETYPE_PRINTER_INTR_VEC,
+            PDP11_TELETYPE_INTR_PRIORITY,
+            printer
+        ),
+        {
+            pdp11_papertape_reader_uninit(&self->pr);
+            pdp11_uninit(machine);
+        }
+    );
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &machine->unibus,
+            pdp11_papertape_reader_ww_unibus_device(&self->pr),
+            PDP11_PAPERTAPE_READER_ADDR,
+            PDP11_PAPERTAPE_READER_SIZE
+        ),
+        {
+            pdp11_teletype_uninit(&self->tty);
+            pdp11_papertape_reader_uninit(&self->pr);
+            pdp11_uninit(machine);
+        }
+    );
+    UNROLL_CLEANUP(
+        unibus_attach(
+            &machine->unibus,
+            pdp11_teletype_ww_unibus_device(&self->tty),
+            PDP11_TELETYPE_ADDR,
+            PDP11_TELETYPE_SIZE
+        ),
+        {
+            pdp11_teletype_uninit(&self->tty);
+            pdp11_papertape_reader_uninit(&self->pr);
+            pdp11_uninit(machine);
+        }
+    );
+    return Ok;
+}
+static void pdp11_cpu_test_machine_uninit(Pdp11CpuTestMachine *const self) {
+    pdp11_teletype_uninit(&self->tty);
+    pdp11_papertape_reader_uninit(&self->pr);
+    pdp11_uninit(&self->pdp);
+}
+
+/* Boots `tape`, a diagnostic, through the absolute loader the way an operator
+ * would, and leaves it at its start, 0200. */
+static Result pdp11_cpu_test_machine_boot(
+    Pdp11CpuTestMachine *const self,
+    char const *const tape
+) {
+    Pdp11Cpu *const cpu = &self->pdp.cpu;
+    Pdp11Console *const console = &self->pdp.console;
+    pdp11_console_next_power_control(console);
+    pdp11_console_toggle_enable(console);
+    pdp11_console_insert_bootloader(console);
+    pdp11_console_toggle_enable(console);
+    UNROLL(pdp11_papertape_reader_load(
+        &self->pr,
+        PDP11_CPU_TEST_TAPES_DIR "absolute_loader.ptap"
+    ));
+    pdp11_console_press_start(console);
+    if (pdp11_cpu_run(cpu, PDP11_CPU_NO_LIMIT) != PDP11_CPU_STOP_HALT)
+        return StateErr;
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s%s", PDP11_CPU_TEST_TAPES_DIR, tape);
+    UNROLL(pdp11_papertape_reader_load(&self->pr, path));
+    pdp11_console_press_continue(console);
+    if (pdp11_cpu_run(cpu, PDP11_CPU_NO_LIMIT) != PDP11_CPU_STOP_HALT)
+        return StateErr;
+    pdp11_cpu_pc(cpu) = 0200;
+    return Ok;
+}
+
+// Whether the registers, the PSW and RAM of the two machines are the same.
+static bool pdp11_cpu_test_machine_is_same(
+    Pdp11CpuTestMachine *const self,
+    Pdp11CpuTestMachine *const other
+) {
+    Pdp11Cpu *const cpu = &self->pdp.cpu, *const other_cpu = &other->pdp.cpu;
+    pdp11_cpu_sync_flags(cpu), pdp11_cpu_sync_flags(other_cpu);
+    for (unsigned i = 0; i < PDP11_CPU_REG_COUNT; i++)
+        if (pdp11_cpu_rx(cpu, i) != pdp11_cpu_rx(other_cpu, i)) return false;
+    return pdp11_psw_to_word(&pdp11_cpu_psw(cpu)) ==
+               pdp11_psw_to_word(&pdp11_cpu_psw(other_cpu)) &&
+           memcmp(
+               (void const *)pdp11_ram_data(&self->pdp.ram),
+               (void const *)pdp11_ram_data(&other->pdp.ram),
+               cpu->_ram_size
+           ) == 0;
+}
+
+// Bytes at the bottom of RAM that a single instruction run by
+// `pdp11_cpu_test_exec` may touch, the vectors and the stack included.
+#define PDP11_CPU_TEST_EXEC_MEM_SIZE (0x800)
+
+// What a single instruction has left behind.
+typedef struct Pdp11CpuTestExecState {
+    uint16_t r[PDP11_CPU_REG_COUNT];
+    uint16_t psw;
+    Pdp11CpuState state;
+    bool is_bus_error;
+    uint8_t mem[PDP11_CPU_TEST_EXEC_MEM_SIZE];
+} Pdp11CpuTestExecState;
+
+/* Runs `instr` with `exec` from a state that only depends on `seed`. Every
+ * register and every word in memory points into the bottom of RAM, so that
+ * whatever the addressing modes, nothing else is touched. */
+static void pdp11_cpu_test_exec(
+    Pdp11CpuExec *const exec,
+    Pdp11CpuInstr const instr,
+    uint16_t const seed,
+    Pdp11CpuTestExecState *const out
+) {
+    uint16_t *const mem = (uint16_t *)pdp11_ram_data(&pdp.ram);
+    for (unsigned i = 0; i < PDP11_CPU_TEST_EXEC_MEM_SIZE / 2; i++)
+        mem[i] = 0x100 + (((i + seed) * 6) & 0xFE);
+    for (unsigned i = 0; i < 6; i++)
+        pdp11_cpu_rx(&pdp.cpu, i) = 0x200 + 0x40 * i;
+    pdp11_cpu_sp(&pdp.cpu) = 0x3F0;
+    pdp11_cpu_pc(&pdp.cpu) = 0x500;
+    pdp11_psw_set(&pdp11_cpu_psw(&pdp.cpu), seed & 0xF);
+    pdp.cpu._lazy_flags.op = PDP11_CPU_FLAGS_OP_NONE;
+    pdp.cpu._state = PDP11_CPU_STATE_HALT;
+
+    out->is_bus_error = setjmp(pdp.cpu.__bus_error) != 0;
+    if (!out->is_bus_error) exec(&pdp.cpu, instr);
+
+    pdp11_cpu_sync_flags(&pdp.cpu);
+    for (unsigned i = 0; i < PDP11_CPU_REG_COUNT; i++)
+        out->r[i] = pdp11_cpu_rx(&pdp.cpu, i);
+    out->psw = pdp11_psw_to_word(&pdp11_cpu_psw(&pdp.cpu));
+    out->state = pdp11_cpu_state(&pdp.cpu);
+    memcpy(out->mem, mem, PDP11_CPU_TEST_EXEC_MEM_SIZE);
+}
+
 /***********
  ** tests **
  ***********/
 
 static MiunteResult pdp11_cpu_test_setup() {
-    MIUNTE_EXPECT(pdp11_init(&pdp) == Ok, "`pdp11_init` should not fail");
+    MIUNTE_EXPECT(
+        pdp11_init(&pdp, NULL, engine, false) == Ok,
+        "`pdp11_init` should not fail"
+    );
     pdp11_cpu_pc(&pdp.cpu) = 0x100;
     pdp11_cpu_sp(&pdp.cpu) = 0x1000;
     MIUNTE_PASS();
@@ -96,8 +327,7 @@ static MiunteResult pdp11_cpu_test_decoding_and_execution() {
         );
 
         unibus_cpu_dato(&pdp.unibus, pdp11_cpu_pc(&pdp.cpu), encoded);
-        pdp11_cpu_single_step(&pdp.cpu);
-        while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+        pdp11_cpu_step(&pdp.cpu);
     }
     {
         uint16_t const reserved_instr_trap = 0xFACE;
@@ -120,8 +350,7 @@ static MiunteResult pdp11_cpu_test_decoding_and_execution() {
             "before executing an illegal instruction should not be on illegal instr location"
         );
         unibus_cpu_dato(&pdp.unibus, pdp11_cpu_pc(&pdp.cpu), encoded);
-        pdp11_cpu_single_step(&pdp.cpu);
-        while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+        pdp11_cpu_step(&pdp.cpu);
         MIUNTE_EXPECT(
             pdp11_cpu_pc(&pdp.cpu) == reserved_instr_trap,
             "after executing an illegal instruction should trap to illegal instr location"
@@ -131,6 +360,31 @@ static MiunteResult pdp11_cpu_test_decoding_and_execution() {
     MIUNTE_PASS();
 }
 
+static MiunteResult pdp11_cpu_test_predecoded_table() {
+    // NOTE the table is the same for every engine
+    if (engine != PDP11_CPU_ENGINE_LOOP) MIUNTE_PASS();
+
+    static Pdp11CpuTestExecState expected, actual;
+    for (uint32_t encoded = 0; encoded <= UINT16_MAX; encoded++) {
+        Pdp11CpuInstr const instr = pdp11_cpu_instr(encoded);
+        Pdp11CpuOp const op = pdp11_cpu_op(instr);
+        Pdp11CpuDecoded const *const decoded = pdp11_cpu_decode(encoded);
+
+        MIUNTE_EXPECT(
+            decoded->op == op && decoded->time == pdp11_cpu_instr_ns(op, instr),
+            "predecoded operation and time should match the reference decoder"
+        );
+        pdp11_cpu_test_exec(pdp11_cpu_execs[op], instr, encoded, &expected);
+        pdp11_cpu_test_exec(decoded->exec, decoded->instr, encoded, &actual);
+        MIUNTE_EXPECT(
+            memcmp(&expected, &actual, sizeof(expected)) == 0,
+            "predecoded handler should do what the reference handler does"
+        );
+    }
+
+    MIUNTE_PASS();
+}
+
 static MiunteResult pdp11_cpu_test_addressing() {
     {
         uint16_t const x = 0xDEAD, y = 0xBEEF;
@@ -172,8 +426,7 @@ static MiunteResult pdp11_cpu_test_addressing() {
             pdp11_cpu_pc(&pdp.cpu),
             0010110 /* mov (R0), R1 */
         );
-        pdp11_cpu_single_step(&pdp.cpu);
-        while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+        pdp11_cpu_step(&pdp.cpu);
         MIUNTE_EXPECT(
             pdp11_cpu_pc(&pdp.cpu) == cpu_err_trap,
             "after timeout error (accessing illegal address) should trap to cpu err location"
@@ -190,8 +443,7 @@ static MiunteResult pdp11_cpu_test_addressing() {
             pdp11_cpu_pc(&pdp.cpu),
             0010130 /* mov @(R0)+, R1 */
         );
-        pdp11_cpu_single_step(&pdp.cpu);
-        while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+        pdp11_cpu_step(&pdp.cpu);
         MIUNTE_EXPECT(
             pdp11_cpu_pc(&pdp.cpu) == cpu_err_trap,
             "after timeout error (accessing illegal address) should trap to cpu err location"
@@ -470,16 +722,880 @@ static MiunteResult pdp11_cpu_test_swab() {
     MIUNTE_PASS();
 }
 
+static MiunteResult pdp11_cpu_test_lazy_flags() {
+    Pdp11PswFlags const volatile *const flags = &pdp11_cpu_psw(&pdp.cpu).flags;
+
+    uint16_t const program[] = {
+        0060100, /* add R1, R0 */
+        0005202, /* inc R2 */
+        0013703, /* mov @#177776, R3 */
+        UNIBUS_CPU_PSW_ADDRESS,
+        0103401, /* bcs .+4 */
+        0000000, /* halt */
+        0000000, /* halt */
+    };
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = 65000;
+    pdp11_cpu_rx(&pdp.cpu, 1) = 1000;
+    pdp11_cpu_rx(&pdp.cpu, 2) = 0;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    MIUNTE_EXPECT(
+        pdp11_cpu_pc(&pdp.cpu) == start + 2 * 7,
+        "branch should see the carry of add kept by inc and mov"
+    );
+    MIUNTE_EXPECT(
+        BITS(pdp11_cpu_rx(&pdp.cpu, 3), 0, 3) == 01,
+        "PSW read through the bus should have {nzvc} flags = {0001}"
+    );
+    MIUNTE_EXPECT(
+        !flags->n && !flags->z && !flags->v && flags->c,
+        "flags should be materialized on halt"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_hot_loop() {
+    Pdp11PswFlags const volatile *const flags = &pdp11_cpu_psw(&pdp.cpu).flags;
+
+    uint16_t const program[] = {
+        0005200, /* inc R0 */
+        0060002, /* add R0, R2 */
+        0077103, /* sob R1, .-4 */
+        0000000, /* halt */
+    };
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = 0;
+    pdp11_cpu_rx(&pdp.cpu, 1) = 100;
+    pdp11_cpu_rx(&pdp.cpu, 2) = 60536;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    MIUNTE_EXPECT(pdp11_cpu_rx(&pdp.cpu, 0) == 100, "inc should run 100 times");
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 2) == 50,
+        "add should sum up 1..100 modulo 2^16"
+    );
+    MIUNTE_EXPECT(
+        !flags->n && !flags->z && !flags->v && flags->c,
+        "flags should be those of the last add"
+    );
+    if (engine == PDP11_CPU_ENGINE_JIT)
+        MIUNTE_EXPECT(
+            pdp11_cpu_block_stats(&pdp.cpu).compiled > 0,
+            "the loop body should get compiled"
+        );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_trace_trap() {
+    uint16_t const handler = 0x200;
+    uint16_t const vector[] = {handler, 0};
+    pdp11_cpu_test_load(PDP11_CPU_TRAP_BPT, vector, lenof(vector));
+    uint16_t const handler_program[] = {
+        0005201, /* inc R1 */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(handler, handler_program, lenof(handler_program));
+
+    uint16_t const program[] = {
+        0005000, /* clr R0 */
+        0005001, /* clr R1 */
+        0012737, /* mov #20, @#177776 */
+        0000020,
+        UNIBUS_CPU_PSW_ADDRESS,
+        0005200, /* inc R0 */
+        0005200, /* inc R0 */
+        0000000, /* halt */
+    };
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 0) == 1 && pdp11_cpu_rx(&pdp.cpu, 1) == 1,
+        "setting the T-bit should trap right after the next instruction"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_bus_error() {
+    uint16_t const handler = 0x200;
+    uint16_t const vector[] = {handler, 0};
+    pdp11_cpu_test_load(PDP11_CPU_TRAP_CPU_ERR, vector, lenof(vector));
+    unibus_cpu_dato(&pdp.unibus, handler, 0000000 /* halt */);
+
+    {
+        uint16_t const program[] = {
+            0005201, /* inc R1 */
+            0011002, /* mov (R0), R2 */
+            0005201, /* inc R1 */
+        };
+        uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+        pdp11_cpu_test_load(start, program, lenof(program));
+        pdp11_cpu_rx(&pdp.cpu, 0) = PDP11_RAM_SIZE;
+
+        pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+        uint16_t pushed_pc;
+        unibus_cpu_dati(&pdp.unibus, pdp11_cpu_sp(&pdp.cpu), &pushed_pc);
+        MIUNTE_EXPECT(
+            pdp11_cpu_rx(&pdp.cpu, 1) == 1 &&
+                pdp11_cpu_pc(&pdp.cpu) == handler + 2 &&
+                pushed_pc == start + 4,
+            "a bus error should trap right after the faulting instruction"
+        );
+        MIUNTE_EXPECT(
+            pdp11_cpu_time(&pdp.cpu) ==
+                pdp11_cpu_decode(0005201 /* inc R1 */)->time +
+                    PDP11_CPU_TRAP_NS +
+                    pdp11_cpu_decode(0000000 /* halt */)->time,
+            "a bus error should take the trap time instead of its own"
+        );
+    }
+    {
+        uint16_t const program[] = {
+            0004770, /* jsr PC, @0(R0) */
+            0000000,
+        };
+        uint16_t const start = 0x300;
+        pdp11_cpu_test_load(start, program, lenof(program));
+        pdp11_cpu_pc(&pdp.cpu) = start;
+        pdp11_cpu_sp(&pdp.cpu) = 0x1000;
+
+        pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+        uint16_t pushed_pc;
+        unibus_cpu_dati(&pdp.unibus, pdp11_cpu_sp(&pdp.cpu), &pushed_pc);
+        MIUNTE_EXPECT(
+            pdp11_cpu_pc(&pdp.cpu) == handler + 2 &&
+                pdp11_cpu_sp(&pdp.cpu) == 0x1000 - 4 &&
+                pushed_pc == start + 4,
+            "a bus error in jsr should trap without jumping anywhere"
+        );
+    }
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_wait() {
+    MIUNTE_EXPECT(
+        pdp11_cpu_test_load_intr(0005200 /* inc R0 */) == Ok,
+        "wiring a BR line should not fail"
+    );
+
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0000001, /* wait */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = 0;
+    MIUNTE_EXPECT(
+        pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT) == PDP11_CPU_STOP_WAIT,
+        "with nothing to wake it the CPU should stop waiting"
+    );
+    unibus_br_intr(&pdp.unibus, PDP11_CPU_TEST_INTR_VEC);
+    MIUNTE_EXPECT(
+        pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT) == PDP11_CPU_STOP_HALT,
+        "the handler should halt the CPU"
+    );
+
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 0) == 1,
+        "interrupt should wake the CPU from WAIT into its handler"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_run_limit() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0005200, /* inc R0 */
+        0005201, /* inc R1 */
+        0000775, /* br .-4 */
+        0077301, /* sob R3, . */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    // NOTE long enough for the block engines to have compiled the loop
+    pdp11_cpu_rx(&pdp.cpu, 0) = pdp11_cpu_rx(&pdp.cpu, 1) = 0;
+    MIUNTE_EXPECT(
+        pdp11_cpu_run(&pdp.cpu, 1000) == PDP11_CPU_STOP_INSTRS,
+        "the CPU should stop once it has run as many instructions as let to"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_instrs(&pdp.cpu) == 1000 &&
+            pdp11_cpu_rx(&pdp.cpu, 0) == 334 &&
+            pdp11_cpu_rx(&pdp.cpu, 1) == 333,
+        "the CPU should run exactly as many instructions as let to"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_step(&pdp.cpu) == PDP11_CPU_STOP_HALT &&
+            pdp11_cpu_state(&pdp.cpu) == PDP11_CPU_STATE_HALT,
+        "a step should leave the CPU halted"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_instrs(&pdp.cpu) == 1001 && pdp11_cpu_rx(&pdp.cpu, 1) == 334,
+        "a step should run a single instruction"
+    );
+
+    // NOTE nor should a loop run at once go past the limit
+    uint64_t const instrs = pdp11_cpu_instrs(&pdp.cpu);
+    pdp11_cpu_pc(&pdp.cpu) = start + 6;
+    pdp11_cpu_rx(&pdp.cpu, 3) = 50000;
+    MIUNTE_EXPECT(
+        pdp11_cpu_run(&pdp.cpu, 1234) == PDP11_CPU_STOP_INSTRS &&
+            pdp11_cpu_instrs(&pdp.cpu) == instrs + 1234 &&
+            pdp11_cpu_rx(&pdp.cpu, 3) == 50000 - 1234,
+        "a delay loop should stop at the limit as well"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT) == PDP11_CPU_STOP_HALT &&
+            pdp11_cpu_rx(&pdp.cpu, 3) == 0,
+        "running on should pick up where the limit has stopped the CPU"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_events() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0005200, /* inc R0 */
+        0000776, /* br .-2 */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    // NOTE the count of instructions run so far is odd, 51 `inc` and 50 `br`
+    unsigned const instr_count = 101;
+    uint64_t const delay = 51 * pdp11_cpu_decode(0005200)->time +
+                           50 * pdp11_cpu_decode(0000776)->time;
+    uint64_t halted_at[2] = {0};
+    MIUNTE_EXPECT(
+        pdp11_cpu_schedule(
+            &pdp.cpu,
+            delay,
+            (Pdp11Event){.fire = pdp11_cpu_test_halt_event, .ctx = halted_at}
+        ) == Ok,
+        "scheduling an event should not fail"
+    );
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = 0;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    MIUNTE_EXPECT(
+        halted_at[0] == delay,
+        "an event should fire at the instruction it is due after"
+    );
+    MIUNTE_EXPECT(
+        halted_at[1] == (instr_count + 1) / 2,
+        "simulated time should follow the instructions run"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_event_npr() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu), addr = 0x1000;
+    uint16_t const program[] = {
+        0005200, /* inc R0 */
+        0000776, /* br .-2 */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    // NOTE once while running, and once while waiting
+    for (unsigned i = 0; i < 2; i++) {
+        if (i == 1) unibus_cpu_dato(&pdp.unibus, start, 0000001 /* wait */);
+        bool is_done = false;
+        MIUNTE_EXPECT(
+            pdp11_cpu_schedule(
+                &pdp.cpu,
+                1000,
+                (Pdp11Event){
+                    .fire = pdp11_cpu_test_npr_event,
+                    .ctx = &is_done,
+                    .data = addr,
+                }
+            ) == Ok,
+            "scheduling an event should not fail"
+        );
+
+        pdp11_cpu_pc(&pdp.cpu) = start;
+        pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+        MIUNTE_EXPECT(
+            is_done,
+            "an event should be able to become bus master on the CPU thread"
+        );
+
+        uint16_t words[3];
+        for (unsigned j = 0; j < lenof(words); j++)
+            unibus_cpu_dati(&pdp.unibus, addr + 2 * j, words + j);
+        MIUNTE_EXPECT(
+            words[0] == 0xD00D && words[1] == 0xB10C && words[2] == 0xB10D,
+            "the transfers of an event should reach memory"
+        );
+        for (unsigned j = 0; j < lenof(words); j++)
+            unibus_cpu_dato(&pdp.unibus, addr + 2 * j, 0);
+    }
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_wait_skips_time() {
+    MIUNTE_EXPECT(
+        pdp11_cpu_test_load_intr(0005200 /* inc R0 */) == Ok,
+        "wiring a BR line should not fail"
+    );
+
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0000001, /* wait */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    // NOTE a whole simulated hour, which would never pass in real time
+    uint64_t const delay = 3600ull * 1000 * 1000 * 1000;
+    MIUNTE_EXPECT(
+        pdp11_cpu_schedule(
+            &pdp.cpu,
+            delay,
+            (Pdp11Event){
+                .fire = pdp11_cpu_test_intr_event,
+                .data = PDP11_CPU_TEST_INTR_VEC,
+            }
+        ) == Ok,
+        "scheduling an event should not fail"
+    );
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = 0;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 0) == 1,
+        "the event should wake the CPU from WAIT into the handler"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_time(&pdp.cpu) >= delay,
+        "WAIT should skip the time till the event"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_idle_loop() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0105737, UNIBUS_CPU_PSW_ADDRESS, /* tstb @#177776 */
+        0100375,                         /* bpl .-4 */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    // NOTE a whole simulated hour, not a whole number of iterations
+    uint64_t const delay = 3600ull * 1000 * 1000 * 1000 + 1;
+    uint64_t halted_at[2] = {0};
+    MIUNTE_EXPECT(
+        pdp11_cpu_schedule(
+            &pdp.cpu,
+            delay,
+            (Pdp11Event){.fire = pdp11_cpu_test_halt_event, .ctx = halted_at}
+        ) == Ok,
+        "scheduling an event should not fail"
+    );
+
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    uint64_t const tstb = pdp11_cpu_decode(program[0])->time,
+                   iter = tstb + pdp11_cpu_decode(program[2])->time,
+                   rest = delay % iter;
+    uint64_t const expected =
+        delay - rest + (rest == 0 ? 0 : rest <= tstb ? tstb : iter);
+    MIUNTE_EXPECT(
+        halted_at[0] == expected,
+        "skipping the loop should still fire the event at its instruction"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_idle_skipped_ns(&pdp.cpu) > 0,
+        "the loop should have been skipped"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_delay_loops() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0000261,                         /* sec */
+        0077001,                         /* sob R0, . */
+        0005301,                         /* dec R1 */
+        0001376,                         /* bne .-2 */
+        0013702, UNIBUS_CPU_PSW_ADDRESS, /* mov @#177776, R2 */
+        0000000,                         /* halt */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = 50000;
+    pdp11_cpu_rx(&pdp.cpu, 1) = 40000;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    uint64_t expected = 50000 * pdp11_cpu_decode(program[1])->time +
+                        40000 * (pdp11_cpu_decode(program[2])->time +
+                                 pdp11_cpu_decode(program[3])->time);
+    for (unsigned i = 0; i < lenof(program); i++)
+        if (i != 1 && i != 2 && i != 3 && i != 5)
+            expected += pdp11_cpu_decode(program[i])->time;
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 0) == 0 && pdp11_cpu_rx(&pdp.cpu, 1) == 0,
+        "the loops should count their registers down to 0"
+    );
+    MIUNTE_EXPECT(
+        (pdp11_cpu_rx(&pdp.cpu, 2) & 017) == 005,
+        "the countdown should leave z set and c as it was"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_time(&pdp.cpu) == expected,
+        "the loops should take as long as their iterations"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_delay_skipped_ns(&pdp.cpu) > 0,
+        "the loops should have been run at once"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_instrs(&pdp.cpu) == 1 + 50000 + 2 * 40000 + 2,
+        "the loops should count every iteration run at once"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_delay_loop_intr() {
+    MIUNTE_EXPECT(
+        pdp11_cpu_test_load_intr(0010003 /* mov R0, R3 */) == Ok,
+        "wiring a BR line should not fail"
+    );
+
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0077001, /* sob R0, . */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    // NOTE due right after the 1000th iteration, so taken after the 1001st
+    uint64_t const delay = 1000 * pdp11_cpu_decode(0077001)->time + 1;
+    MIUNTE_EXPECT(
+        pdp11_cpu_schedule(
+            &pdp.cpu,
+            delay,
+            (Pdp11Event){
+                .fire = pdp11_cpu_test_intr_event,
+                .data = PDP11_CPU_TEST_INTR_VEC,
+            }
+        ) == Ok,
+        "scheduling an event should not fail"
+    );
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = 60000;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 3) == 60000 - 1001,
+        "the interrupt should be taken at the iteration it is due after"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_copy_loops() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0012122,                         /* mov (R1)+, (R2)+ */
+        0077002,                         /* sob R0, .-4 */
+        0005022,                         /* clr (R2)+ */
+        0077302,                         /* sob R3, .-4 */
+        0013704, UNIBUS_CPU_PSW_ADDRESS, /* mov @#177776, R4 */
+        0000000,                         /* halt */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    uint16_t const src = 0x2000, dst = 0x4000;
+    unsigned const copy_len = 1000, fill_len = 500;
+    for (unsigned i = 0; i < copy_len + fill_len; i++) {
+        unibus_cpu_dato(&pdp.unibus, src + 2 * i, 0x8000 | i);
+        unibus_cpu_dato(&pdp.unibus, dst + 2 * i, 0xFFFF);
+    }
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = copy_len;
+    pdp11_cpu_rx(&pdp.cpu, 1) = src;
+    pdp11_cpu_rx(&pdp.cpu, 2) = dst;
+    pdp11_cpu_rx(&pdp.cpu, 3) = fill_len;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    bool is_copied = true;
+    for (unsigned i = 0; i < copy_len + fill_len; i++) {
+        uint16_t word;
+        unibus_cpu_dati(&pdp.unibus, dst + 2 * i, &word);
+        is_copied &= word == (i < copy_len ? 0x8000 | i : 0);
+    }
+    MIUNTE_EXPECT(is_copied, "the words should be copied, then cleared");
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 0) == 0 && pdp11_cpu_rx(&pdp.cpu, 3) == 0 &&
+            pdp11_cpu_rx(&pdp.cpu, 1) == src + 2 * copy_len &&
+            pdp11_cpu_rx(&pdp.cpu, 2) == dst + 2 * (copy_len + fill_len),
+        "the registers should end up past the words"
+    );
+    MIUNTE_EXPECT(
+        (pdp11_cpu_rx(&pdp.cpu, 4) & 017) == 004,
+        "the fill should leave only z set"
+    );
+
+    uint64_t const expected =
+        copy_len * (pdp11_cpu_decode(program[0])->time +
+                    pdp11_cpu_decode(program[1])->time) +
+        fill_len * (pdp11_cpu_decode(program[2])->time +
+                    pdp11_cpu_decode(program[3])->time) +
+        pdp11_cpu_decode(program[4])->time +
+        pdp11_cpu_decode(program[6])->time;
+    MIUNTE_EXPECT(
+        pdp11_cpu_time(&pdp.cpu) == expected,
+        "the loops should take as long as their iterations"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_copy_skipped_ns(&pdp.cpu) > 0,
+        "the loops should have been run on the host memory"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_copy_loop_overlap() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0012122, /* mov (R1)+, (R2)+ */
+        0077002, /* sob R0, .-4 */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    // NOTE copying a word up repeats the first one all the way
+    uint16_t const src = 0x2000;
+    unsigned const len = 1000;
+    for (unsigned i = 0; i <= len; i++)
+        unibus_cpu_dato(&pdp.unibus, src + 2 * i, 1 + i);
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = len;
+    pdp11_cpu_rx(&pdp.cpu, 1) = src;
+    pdp11_cpu_rx(&pdp.cpu, 2) = src + 2;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    bool is_repeated = true;
+    for (unsigned i = 0; i <= len; i++) {
+        uint16_t word;
+        unibus_cpu_dati(&pdp.unibus, src + 2 * i, &word);
+        is_repeated &= word == 1;
+    }
+    MIUNTE_EXPECT(
+        is_repeated,
+        "an overlapping copy should go word by word, as the CPU does"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_timing() {
+    MIUNTE_EXPECT(
+        pdp11_cpu_decode(0010102 /* mov R1, R2 */)->time == 2300,
+        "register to register should take the basic time"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_decode(0012122 /* mov (R1)+, (R2)+ */)->time >
+                pdp11_cpu_decode(0010102 /* mov R1, R2 */)->time &&
+            pdp11_cpu_decode(0013132 /* mov @(R1)+, @(R2)+ */)->time >
+                pdp11_cpu_decode(0012122 /* mov (R1)+, (R2)+ */)->time,
+        "every level of indirection should take longer"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_decode(0104000 /* emt */)->time == PDP11_CPU_TRAP_NS,
+        "traps should take the trap time"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_real_speed() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    unibus_cpu_dato(&pdp.unibus, start, 0000777 /* br . */);
+
+    uint64_t const delay = 50 * 1000 * 1000;
+    uint64_t halted_at[2] = {0};
+    MIUNTE_EXPECT(
+        pdp11_cpu_schedule(
+            &pdp.cpu,
+            delay,
+            (Pdp11Event){.fire = pdp11_cpu_test_halt_event, .ctx = halted_at}
+        ) == Ok,
+        "scheduling an event should not fail"
+    );
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    pdp11_cpu_set_speed(&pdp.cpu, 1);
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pdp11_cpu_set_speed(&pdp.cpu, 0);
+
+    uint64_t const elapsed = (end.tv_sec - begin.tv_sec) * 1000000000ull +
+                             end.tv_nsec - begin.tv_nsec;
+    // NOTE pacing may sleep off up to its slack less than simulated
+    MIUNTE_EXPECT(
+        elapsed + PDP11_CPU_PACE_AHEAD_NS >= delay,
+        "at real speed simulated time should not outrun the host clock"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult pdp11_cpu_test_self_modifying_code() {
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    uint16_t const program[] = {
+        0005200, /* inc R0 */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    pdp11_cpu_rx(&pdp.cpu, 0) = 0;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+    MIUNTE_EXPECT(pdp11_cpu_rx(&pdp.cpu, 0) == 1, "inc should run once");
+
+    unibus_cpu_dato(&pdp.unibus, start, 0005300 /* dec R0 */);
+    pdp11_cpu_pc(&pdp.cpu) = start;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 0) == 0,
+        "rewritten code should run instead of the cached one"
+    );
+    if (engine == PDP11_CPU_ENGINE_BLOCK || engine == PDP11_CPU_ENGINE_JIT)
+        MIUNTE_EXPECT(
+            pdp11_cpu_block_stats(&pdp.cpu).invalidations > 0,
+            "the write should invalidate the cached block"
+        );
+
+    // NOTE hot enough to get compiled before being rewritten
+    uint16_t const loop[] = {
+        0005200, /* inc R0 */
+        0060002, /* add R0, R2 */
+        0077103, /* sob R1, .-4 */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(start, loop, lenof(loop));
+    pdp11_cpu_rx(&pdp.cpu, 0) = 0, pdp11_cpu_rx(&pdp.cpu, 1) = 100;
+    pdp11_cpu_rx(&pdp.cpu, 2) = 0;
+    pdp11_cpu_pc(&pdp.cpu) = start;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    unibus_cpu_dato(&pdp.unibus, start + 2, 0160002 /* sub R0, R2 */);
+    pdp11_cpu_rx(&pdp.cpu, 0) = 0, pdp11_cpu_rx(&pdp.cpu, 1) = 100;
+    pdp11_cpu_rx(&pdp.cpu, 2) = 0;
+    pdp11_cpu_pc(&pdp.cpu) = start;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 2) == (uint16_t)-5050,
+        "rewritten code should run instead of the compiled one"
+    );
+
+    // NOTE the block is checked only on being entered, but it is left as soon
+    // as it gets written to. The run starts with its own batch, which the nop
+    // takes, so that the rewrite happens halfway through a block
+    uint16_t const rewrite[] = {
+        0000240, /* nop */
+        0012737, /* mov #dec R0, @#.+6 */
+        0005300,
+        start + 8,
+        0005200, /* inc R0 */
+        0000000, /* halt */
+    };
+    pdp11_cpu_test_load(start, rewrite, lenof(rewrite));
+    pdp11_cpu_rx(&pdp.cpu, 0) = 0;
+    pdp11_cpu_pc(&pdp.cpu) = start;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+    MIUNTE_EXPECT(
+        pdp11_cpu_rx(&pdp.cpu, 0) == (uint16_t)-1,
+        "code rewritten by its own block should run rewritten"
+    );
+
+    if (engine == PDP11_CPU_ENGINE_BLOCK || engine == PDP11_CPU_ENGINE_JIT) {
+        uint64_t const invalidations =
+            pdp11_cpu_block_stats(&pdp.cpu).invalidations;
+        unibus_cpu_dato(&pdp.unibus, start + 12, 0123456);
+        MIUNTE_EXPECT(
+            pdp11_cpu_block_stats(&pdp.cpu).invalidations == invalidations,
+            "a write next to the code should not invalidate its block"
+        );
+    }
+
+    MIUNTE_PASS();
+}
+
+/* Runs the diagnostics side by side with the loop engine, which the other
+ * engines have to match instruction for instruction. NOTE only from their
+ * start on, how long the loader takes depends on how the engine batches its
+ * instructions. */
+static MiunteResult pdp11_cpu_test_papertapes() {
+    static char const *const tapes[] = {
+        "test1_branch.ptap",
+        "test2_cond_branch.ptap",
+        "test3_unary.ptap",
+        "test4_unary_binary.ptap",
+        "test5_rotate_shift.ptap",
+        "test6_compare.ptap",
+        "test7_compare_not.ptap",
+        "test8_move.ptap",
+    };
+    static Pdp11CpuTestMachine machine, reference;
+
+    uint64_t compiled = 0;
+    for (unsigned i = 0; i < lenof(tapes); i++) {
+        char *output, *reference_output;
+        size_t output_size, reference_output_size;
+        FILE *const printer = open_memstream(&output, &output_size);
+        FILE *const reference_printer =
+            open_memstream(&reference_output, &reference_output_size);
+        MIUNTE_EXPECT(
+            pdp11_cpu_test_machine_init(&machine, engine, printer) == Ok &&
+                pdp11_cpu_test_machine_init(
+                    &reference,
+                    PDP11_CPU_ENGINE_LOOP,
+                    reference_printer
+                ) == Ok,
+            "machines should get put together"
+        );
+        MIUNTE_EXPECT(
+            pdp11_cpu_test_machine_boot(&machine, tapes[i]) == Ok &&
+                pdp11_cpu_test_machine_boot(&reference, tapes[i]) == Ok,
+            "the diagnostics should boot"
+        );
+
+        uint64_t const start = pdp11_cpu_instrs(&machine.pdp.cpu);
+        uint64_t const reference_start = pdp11_cpu_instrs(&reference.pdp.cpu);
+        bool is_same = true;
+        for (unsigned j = 0; j < 20 && is_same; j++) {
+            pdp11_cpu_run(&machine.pdp.cpu, 10000);
+            pdp11_cpu_run(&reference.pdp.cpu, 10000);
+            is_same =
+                pdp11_cpu_instrs(&machine.pdp.cpu) - start ==
+                    pdp11_cpu_instrs(&reference.pdp.cpu) - reference_start &&
+                pdp11_cpu_test_machine_is_same(&machine, &reference);
+        }
+        compiled += pdp11_cpu_block_stats(&machine.pdp.cpu).compiled;
+
+        pdp11_cpu_test_machine_uninit(&machine);
+        pdp11_cpu_test_machine_uninit(&reference);
+        fclose(printer), fclose(reference_printer);
+        is_same = is_same && output_size == reference_output_size &&
+                  memcmp(output, reference_output, output_size) == 0;
+        free(output), free(reference_output);
+        MIUNTE_EXPECT(is_same, "the diagnostics should run as they do looping");
+    }
+    if (engine == PDP11_CPU_ENGINE_JIT)
+        MIUNTE_EXPECT(compiled > 0, "the diagnostics should get compiled");
+
+    MIUNTE_PASS();
+}
+
+#if PDP11_CPU_TRACE
+static MiunteResult pdp11_cpu_test_trace() {
+    Pdp11CpuTrace *const trace = pdp11_cpu_trace(&pdp.cpu);
+    trace->options = PDP11_CPU_TRACE_ON;
+
+    uint16_t const program[] = {
+        0005200, /* inc R0 */
+        0010037, /* mov R0, @#2000 */
+        0002000,
+        0000000, /* halt */
+    };
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    char *text;
+    size_t text_len;
+    FILE *const file = open_memstream(&text, &text_len);
+    MIUNTE_EXPECT(file, "memory stream should open");
+    pdp11_cpu_trace_dump(trace, file, true);
+    fclose(file);
+
+    bool const is_expected = strcmp(
+                                 text,
+                                 "exec at 000400 : 005200  psw 000000\n"
+                                 "exec at 000402 : 010037  psw 000000"
+                                 "  @002000\n"
+                                 "exec at 000406 : 000000  psw 000000\n"
+                             ) == 0;
+    free(text);
+    MIUNTE_EXPECT(is_expected, "dump should list the executed instructions");
+
+    MIUNTE_PASS();
+}
+static MiunteResult pdp11_cpu_test_trace_hot_loop() {
+    Pdp11CpuTrace *const trace = pdp11_cpu_trace(&pdp.cpu);
+    trace->options = PDP11_CPU_TRACE_ON;
+
+    uint16_t const program[] = {
+        0005200, /* inc R0 */
+        0060002, /* add R0, R2 */
+        0077103, /* sob R1, .-4 */
+        0000000, /* halt */
+    };
+    uint16_t const start = pdp11_cpu_pc(&pdp.cpu);
+    pdp11_cpu_test_load(start, program, lenof(program));
+
+    pdp11_cpu_rx(&pdp.cpu, 1) = 100;
+    pdp11_cpu_run(&pdp.cpu, PDP11_CPU_NO_LIMIT);
+
+    char *text;
+    size_t text_len;
+    FILE *const file = open_memstream(&text, &text_len);
+    MIUNTE_EXPECT(file, "memory stream should open");
+    pdp11_cpu_trace_dump(trace, file, false);
+    fclose(file);
+
+    unsigned execs = 0;
+    for (char const *at = text; (at = strstr(at, "exec at")); at++) execs++;
+    free(text);
+    // NOTE compiled code does not trace, so it should not run meanwhile
+    MIUNTE_EXPECT(
+        execs == 3 * 100 + 1,
+        "dump should list every instruction of a hot loop"
+    );
+
+    MIUNTE_PASS();
+}
+#endif
+
 /**********
  ** main **
  **********/
 
-int test_cpu_run(void) {
+int test_cpu_run(Pdp11CpuEngine const cpu_engine) {
+    engine = cpu_engine;
     MIUNTE_RUN(
         pdp11_cpu_test_setup,
         pdp11_cpu_test_teardown,
         {
             pdp11_cpu_test_decoding_and_execution,
+            pdp11_cpu_test_predecoded_table,
             pdp11_cpu_test_addressing,
 
             // TODO test inc/dec
@@ -497,6 +1613,28 @@ int test_cpu_run(void) {
             pdp11_cpu_test_mul_div,
             pdp11_cpu_test_bit,
             pdp11_cpu_test_swab,
+            pdp11_cpu_test_lazy_flags,
+            pdp11_cpu_test_hot_loop,
+            pdp11_cpu_test_trace_trap,
+            pdp11_cpu_test_bus_error,
+            pdp11_cpu_test_wait,
+            pdp11_cpu_test_run_limit,
+            pdp11_cpu_test_events,
+            pdp11_cpu_test_event_npr,
+            pdp11_cpu_test_wait_skips_time,
+            pdp11_cpu_test_idle_loop,
+            pdp11_cpu_test_delay_loops,
+            pdp11_cpu_test_delay_loop_intr,
+            pdp11_cpu_test_copy_loops,
+            pdp11_cpu_test_copy_loop_overlap,
+            pdp11_cpu_test_timing,
+            pdp11_cpu_test_real_speed,
+            pdp11_cpu_test_self_modifying_code,
+            pdp11_cpu_test_papertapes,
+#if PDP11_CPU_TRACE
+            pdp11_cpu_test_trace,
+            pdp11_cpu_test_trace_hot_loop,
+#endif
 
             // TODO test some of the branches
             // TODO test sob
@@ -1,7 +1,10 @@
 #include "unibus_test.h"
 
+#include <string.h>
+
 #include <unistd.h>
 
+#include "conviniences.h"
 #include "miunte.h"
 #include "pdp11/pdp11.h"
 
@@ -12,7 +15,10 @@ static Pdp11 pdp = {0};
  ***********/
 
 static MiunteResult unibus_test_setup() {
-    MIUNTE_EXPECT(pdp11_init(&pdp) == Ok, "`pdp11_init` should not fail");
+    MIUNTE_EXPECT(
+        pdp11_init(&pdp, NULL, PDP11_CPU_ENGINE_LOOP, true) == Ok,
+        "`pdp11_init` should not fail"
+    );
     pdp11_cpu_pc(&pdp.cpu) = 0x100;
     pdp11_cpu_sp(&pdp.cpu) = 0x1000;
     MIUNTE_PASS();
@@ -23,11 +29,12 @@ static MiunteResult unibus_test_teardown() {
 }
 
 static MiunteResult unibus_test_npr() {
-    UnibusDevice const *const device = &pdp.periphs[0];
+    void const *const device = &pdp.ram;
 
     uint16_t const addr = 0x42;
     uint16_t const dato = 0xF00D;
     uint16_t dati = dato + 1;
+    uint64_t const transactions = unibus_transactions(&pdp.unibus);
 
     MIUNTE_EXPECT(
         unibus_npr_dato(&pdp.unibus, device, addr, dato) == Ok,
@@ -51,30 +58,232 @@ static MiunteResult unibus_test_npr() {
         dati == ((uint16_t)(dato << 8) | (uint8_t)dato),
         "data should be written correctly"
     );
+    MIUNTE_EXPECT(
+        unibus_transactions(&pdp.unibus) - transactions == 4,
+        "every cycle should be counted as a transaction"
+    );
 
     MIUNTE_PASS();
 }
 
-static void *lower_cpu_priority_thread(void *const vcpu) {
-    Pdp11Cpu *const cpu = vcpu;
+static MiunteResult unibus_test_npr_block() {
+    void const *const device = &pdp.ram;
 
-    while (pdp11_cpu_state(cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+    // NOTE long enough to take a few bursts
+    uint16_t dato[3 * UNIBUS_NPR_BURST_LEN + 1], dati[lenof(dato)];
+    for (unsigned i = 0; i < lenof(dato); i++) dato[i] = 0xF00D ^ i;
+    uint16_t const addr = 0x1000;
+    uint64_t const transactions = unibus_transactions(&pdp.unibus);
 
-    for (uint8_t new_priority = pdp11_psw_priority(&pdp11_cpu_psw(cpu));
-         new_priority >= 2;
-         new_priority--)
-        pdp11_psw_set_priority(&pdp11_cpu_psw(cpu), new_priority);
+    MIUNTE_EXPECT(
+        unibus_npr_dato_block(
+            &pdp.unibus,
+            device,
+            addr,
+            dato,
+            lenof(dato)
+        ) == Ok,
+        "block NPR DATO should not fail"
+    );
+    MIUNTE_EXPECT(
+        unibus_npr_dati_block(
+            &pdp.unibus,
+            device,
+            addr,
+            dati,
+            lenof(dati)
+        ) == Ok,
+        "block NPR DATI should not fail"
+    );
+    MIUNTE_EXPECT(
+        memcmp(dati, dato, sizeof(dato)) == 0,
+        "data should be written correctly"
+    );
+    MIUNTE_EXPECT(
+        unibus_transactions(&pdp.unibus) - transactions == 2 * lenof(dato),
+        "a block should be counted a transaction per word"
+    );
 
-    return NULL;
+    uint16_t last;
+    MIUNTE_EXPECT(
+        unibus_npr_dati(
+            &pdp.unibus,
+            device,
+            addr + 2 * (lenof(dato) - 1),
+            &last
+        ) == Ok &&
+            last == dato[lenof(dato) - 1],
+        "block NPR should be seen by single transfers"
+    );
+
+    MIUNTE_EXPECT(
+        unibus_npr_dato_block(
+            &pdp.unibus,
+            device,
+            PDP11_RAM_SIZE - 4,
+            dato,
+            4
+        ) != Ok,
+        "block NPR past the end of RAM should fail"
+    );
+    MIUNTE_EXPECT(
+        unibus_npr_dati(&pdp.unibus, device, PDP11_RAM_SIZE - 2, &last) ==
+                Ok &&
+            last == dato[1],
+        "block NPR should move the words before the failing one"
+    );
+
+    MIUNTE_PASS();
 }
+
+static MiunteResult unibus_test_cpu_loc() {
+    uint16_t const addr = 0x42;
+    uint16_t const dato = 0xF00D;
+    UnibusLoc loc;
+
+    MIUNTE_EXPECT(
+        unibus_cpu_resolve(&pdp.unibus, addr, false, &loc) == Ok,
+        "resolving RAM should not fail"
+    );
+    MIUNTE_EXPECT(loc.ptr != NULL, "RAM should be accessed directly");
+    unibus_cpu_loc_dato(&pdp.unibus, &loc, dato);
+    MIUNTE_EXPECT(
+        unibus_cpu_loc_dati(&pdp.unibus, &loc) == dato,
+        "data should be written correctly"
+    );
+
+    MIUNTE_EXPECT(
+        unibus_cpu_resolve(&pdp.unibus, addr + 1, true, &loc) == Ok,
+        "resolving an odd byte should not fail"
+    );
+    unibus_cpu_loc_datob(&pdp.unibus, &loc, (uint8_t)dato);
+    uint16_t dati;
+    MIUNTE_EXPECT(
+        unibus_cpu_dati(&pdp.unibus, addr, &dati) == Ok &&
+            dati == ((uint16_t)(dato << 8) | (uint8_t)dato),
+        "data should be written correctly"
+    );
+
+    MIUNTE_EXPECT(
+        unibus_cpu_resolve(&pdp.unibus, addr + 1, false, &loc) != Ok,
+        "resolving an odd word should fail"
+    );
+    MIUNTE_EXPECT(
+        unibus_cpu_resolve(&pdp.unibus, PDP11_RAM_SIZE, false, &loc) != Ok,
+        "resolving an address nothing answers should fail"
+    );
+
+    MIUNTE_EXPECT(
+        unibus_cpu_resolve(&pdp.unibus, UNIBUS_CPU_PSW_ADDRESS, false, &loc) ==
+                Ok &&
+            loc.device == UNIBUS_DEVICE_CPU,
+        "PSW should be resolved to the CPU"
+    );
+    MIUNTE_EXPECT(
+        unibus_cpu_loc_dati(&pdp.unibus, &loc) ==
+            pdp11_psw_to_word(&pdp11_cpu_psw(&pdp.cpu)),
+        "PSW should be read through the location"
+    );
+
+    MIUNTE_PASS();
+}
+
+static MiunteResult unibus_test_attach() {
+    uint16_t const addr = PDP11_RAM_SIZE;
+    uint16_t const size = UNIBUS_IO_PAGE_ADDR - PDP11_RAM_SIZE;
+    // NOTE the bus keeps the device until the teardown
+    static Pdp11Ram ram;
+    MIUNTE_EXPECT(
+        pdp11_ram_init(&ram, addr, size, NULL) == Ok,
+        "`pdp11_ram_init` should not fail"
+    );
+
+    MIUNTE_EXPECT(
+        unibus_attach(
+            &pdp.unibus,
+            pdp11_ram_ww_unibus_device(&ram),
+            addr - 0100,
+            size
+        ) == StateErr,
+        "attaching over another device should fail"
+    );
+    MIUNTE_EXPECT(
+        unibus_attach(
+            &pdp.unibus,
+            pdp11_ram_ww_unibus_device(&ram),
+            addr + 2,
+            size - 2
+        ) == RangeErr,
+        "attaching a part of a page should fail"
+    );
+    MIUNTE_EXPECT(
+        unibus_attach(&pdp.unibus, pdp11_ram_ww_unibus_device(&ram), addr, size)
+            == Ok,
+        "attaching a free range should not fail"
+    );
+
+    // NOTE there is no limit on the number of devices
+    for (uint16_t io_addr = UNIBUS_IO_PAGE_ADDR;
+         io_addr < UNIBUS_IO_PAGE_ADDR + 2 * 16;
+         io_addr += 2)
+        MIUNTE_EXPECT(
+            unibus_attach(&pdp.unibus, no_unibus_device(), io_addr, 2) == Ok,
+            "attaching a word of the I/O page should not fail"
+        );
+
+    uint16_t const dato = 0xF00D;
+    uint16_t dati = dato + 1;
+    MIUNTE_EXPECT(
+        unibus_cpu_dato(&pdp.unibus, addr + size - 2, dato) == Ok &&
+            unibus_cpu_dati(&pdp.unibus, addr + size - 2, &dati) == Ok &&
+            dati == dato,
+        "the attached device should answer its range"
+    );
+    MIUNTE_EXPECT(
+        unibus_cpu_dati(&pdp.unibus, UNIBUS_IO_PAGE_ADDR, &dati) != Ok,
+        "a device declining its address should fail the access"
+    );
+
+    pdp11_ram_uninit(&ram);
+    MIUNTE_PASS();
+}
+
+// Single-steps through a no-op put at PC.
+static bool unibus_test_step_nop() {
+    void const *const device = &pdp.ram;
+
+    if (unibus_npr_dato(
+            &pdp.unibus,
+            device,
+            pdp11_cpu_pc(&pdp.cpu),
+            0010000 /* mov R0, R0 */
+        ) != Ok)
+        return false;
+    pdp11_cpu_single_step(&pdp.cpu);
+    while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+    return true;
+}
+
 static MiunteResult unibus_test_br() {
-    UnibusDevice const *const device = &pdp.periphs[0];
+    void const *const device = &pdp.ram;
 
     uint16_t const trap = 040, trap_pc = 0xACE;
     MIUNTE_EXPECT(
         unibus_npr_dato(&pdp.unibus, device, trap, trap_pc) == Ok,
         "NPR DATO should not fail"
     );
+    MIUNTE_EXPECT(
+        unibus_attach_br(&pdp.unibus, 03, trap) == Ok,
+        "wiring a BR line should not fail"
+    );
+    MIUNTE_EXPECT(
+        unibus_attach_br(&pdp.unibus, 04, trap) != Ok,
+        "wiring a vector twice should fail"
+    );
+    MIUNTE_EXPECT(
+        unibus_br_intr(&pdp.unibus, trap + 4) != Ok,
+        "posting through a vector that is not wired should fail"
+    );
 
     MIUNTE_EXPECT(
         pdp11_cpu_pc(&pdp.cpu) != trap_pc,
@@ -82,35 +291,28 @@ static MiunteResult unibus_test_br() {
     );
 
     pdp11_psw_set_priority(&pdp11_cpu_psw(&pdp.cpu), 07);
-    pthread_t thread;
-    pthread_create(&thread, NULL, lower_cpu_priority_thread, &pdp.cpu);
     MIUNTE_EXPECT(
-        pdp11_psw_priority(&pdp11_cpu_psw(&pdp.cpu)) >= 03,
-        "test will be more useful if starting priority is greater than that of an interrupt"
+        unibus_br_intr(&pdp.unibus, trap) == Ok,
+        "BR should not fail"
+    );
+    MIUNTE_EXPECT(
+        pdp11_psw_priority(&pdp11_cpu_psw(&pdp.cpu)) == 07,
+        "BR should return without waiting for CPU priority to become sufficient"
     );
 
-    unibus_br_intr(&pdp.unibus, 03, device, trap);
-
+    MIUNTE_EXPECT(unibus_test_step_nop(), "step should not fail");
     MIUNTE_EXPECT(
-        pdp11_psw_priority(&pdp11_cpu_psw(&pdp.cpu)) < 03,
-        "interrupt should wait til CPU priority becomes sufficient"
+        pdp11_cpu_pc(&pdp.cpu) != trap_pc,
+        "PC should not be on trap while CPU priority is not sufficient"
     );
-    pthread_join(thread, NULL);
 
+    pdp11_psw_set_priority(&pdp11_cpu_psw(&pdp.cpu), 02);
     usleep(10 * 1000);
-
     MIUNTE_EXPECT(
         pdp11_cpu_pc(&pdp.cpu) != trap_pc,
         "PC should not be on trap even after the BR, before instruction is finished executing"
     );
-    unibus_npr_dato(
-        &pdp.unibus,
-        device,
-        pdp11_cpu_pc(&pdp.cpu),
-        0010000 /* mov R0, R0 */
-    );
-    pdp11_cpu_single_step(&pdp.cpu);
-    while (pdp11_cpu_state(&pdp.cpu) != PDP11_CPU_STATE_HALT) sleep(0);
+    MIUNTE_EXPECT(unibus_test_step_nop(), "step should not fail");
     MIUNTE_EXPECT(
         pdp11_cpu_pc(&pdp.cpu) == trap_pc,
         "PC should be on trap after BR, after the next instruction is executed"
@@ -119,6 +321,66 @@ static MiunteResult unibus_test_br() {
     MIUNTE_PASS();
 }
 
+static MiunteResult unibus_test_br_levels() {
+    void const *const device = &pdp.ram;
+
+    // NOTE wired in daisy chain order, taken highest level first
+    struct {
+        uint8_t priority, trap;
+        uint16_t trap_pc;
+    } const lines[] = {
+        {04, 060, 0x2000},
+        {04, 064, 0x2100},
+        {05, 070, 0x2200},
+        {06, 074, 0x2300},
+    };
+    unsigned const order[] = {3, 2, 0, 1};
+
+    foreach (line, lines, lines + lenof(lines)) {
+        MIUNTE_EXPECT(
+            unibus_attach_br(&pdp.unibus, line->priority, line->trap) == Ok,
+            "wiring a BR line should not fail"
+        );
+        // NOTE handlers run at priority 0, so that the rest stay eligible
+        MIUNTE_EXPECT(
+            unibus_npr_dato(&pdp.unibus, device, line->trap, line->trap_pc) ==
+                    Ok &&
+                unibus_npr_dato(&pdp.unibus, device, line->trap + 2, 0) == Ok,
+            "NPR DATO should not fail"
+        );
+    }
+
+    pdp11_psw_set_priority(&pdp11_cpu_psw(&pdp.cpu), 07);
+    // NOTE posted in reverse, and twice, which should not matter
+    for (unsigned i = 2 * lenof(lines); i-- > 0;)
+        MIUNTE_EXPECT(
+            unibus_br_intr(&pdp.unibus, lines[i % lenof(lines)].trap) == Ok,
+            "BR should not fail while other requests are pending"
+        );
+
+    pdp11_psw_set_priority(&pdp11_cpu_psw(&pdp.cpu), 03);
+    foreach (i, order, order + lenof(order)) {
+        MIUNTE_EXPECT(
+            unibus_test_step_nop(),
+            "step should not fail"
+        );
+        MIUNTE_EXPECT(
+            pdp11_cpu_pc(&pdp.cpu) == lines[*i].trap_pc,
+            "pending requests should be taken by level, then by daisy chain"
+        );
+    }
+    MIUNTE_EXPECT(
+        unibus_test_step_nop(),
+        "step should not fail"
+    );
+    MIUNTE_EXPECT(
+        pdp11_cpu_pc(&pdp.cpu) == lines[order[lenof(order) - 1]].trap_pc + 2,
+        "a request posted twice should be taken once"
+    );
+
+    MIUNTE_PASS();
+}
+
 /**********
  ** main **
  **********/
@@ -129,7 +391,11 @@ int test_unibus_run(void) {
         unibus_test_teardown,
         {
             unibus_test_npr,
+            unibus_test_npr_block,
+            unibus_test_cpu_loc,
+            unibus_test_attach,
             unibus_test_br,
+            unibus_test_br_levels,
         }
     );
 }
@@ -3,5 +3,8 @@
 
 int main() {
     test_unibus_run();
-    test_cpu_run();
+    test_cpu_run(PDP11_CPU_ENGINE_LOOP);
+    test_cpu_run(PDP11_CPU_ENGINE_THREADED);
+    test_cpu_run(PDP11_CPU_ENGINE_BLOCK);
+    test_cpu_run(PDP11_CPU_ENGINE_JIT);
 }